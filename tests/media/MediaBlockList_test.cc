@@ -0,0 +1,159 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <boost/test/unit_test.hpp>
+
+#include <zypp-core/Digest.h>
+#include <zypp-core/AutoDispose.h>
+#include <zypp-core/fs/TmpPath.h>
+#include <zypp-curl/parser/MediaBlockList>
+
+using namespace zypp;
+using namespace zypp::media;
+
+namespace
+{
+  using Bytes = std::vector<unsigned char>;
+
+  /** A zsync like blocklist for \a target_r: rsums truncated to \a rsumlen_r bytes and short strong checksums. */
+  MediaBlockList mkBlockList( const Bytes & target_r, size_t blksize_r, int rsumlen_r, uint rsumseq_r )
+  {
+    MediaBlockList bl( target_r.size() );
+    bl.setRsumSequence( rsumseq_r );
+    for ( size_t off = 0; off < target_r.size(); off += blksize_r )
+    {
+      size_t blkno = bl.addBlock( off, blksize_r );
+      const char * data = reinterpret_cast<const char *>( &target_r[off] );
+
+      unsigned int rs = bl.updateRsum( 0, data, blksize_r );
+      if ( rsumlen_r < 4 )
+        rs &= ( 1U << ( 8 * rsumlen_r ) ) - 1;
+      bl.setRsum( blkno, rsumlen_r, rs, blksize_r );
+
+      Digest dig;
+      dig.create( Digest::sha256() );
+      dig.update( data, blksize_r );
+      UByteArray cs( dig.digestVector() );
+      bl.setChecksum( blkno, Digest::sha256(), 8, cs.data(), blksize_r );
+    }
+    return bl;
+  }
+
+  Bytes readFile( const Pathname & file_r )
+  {
+    Bytes ret;
+    AutoFILE fp { ::fopen( file_r.c_str(), "r" ) };
+    BOOST_REQUIRE( fp );
+    int c;
+    while ( ( c = ::fgetc( fp ) ) != EOF )
+      ret.push_back( c );
+    return ret;
+  }
+
+  void writeFile( const Pathname & file_r, const Bytes & data_r )
+  {
+    AutoFILE fp { ::fopen( file_r.c_str(), "w" ) };
+    BOOST_REQUIRE( fp );
+    BOOST_REQUIRE_EQUAL( ::fwrite( data_r.data(), 1, data_r.size(), fp ), data_r.size() );
+  }
+
+  /** The file written by reuseBlocks (or reuseBlocksOld if \a old_r) for \a delta_r. */
+  Bytes reuse( const Bytes & target_r, size_t blksize_r, int rsumlen_r, uint rsumseq_r, const Pathname & delta_r, bool old_r )
+  {
+    MediaBlockList bl( mkBlockList( target_r, blksize_r, rsumlen_r, rsumseq_r ) );
+    filesystem::TmpFile out;
+    {
+      AutoFILE wfp { ::fopen( out.path().c_str(), "w" ) };
+      BOOST_REQUIRE( wfp );
+      if ( old_r )
+        bl.reuseBlocksOld( wfp, delta_r.asString() );
+      else
+        bl.reuseBlocks( wfp, delta_r.asString() );
+    }
+    return readFile( out.path() );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(reuse_blocks_random)
+{
+  std::mt19937 rnd( 4711 );
+  const auto randomBytes = [&]( size_t len_r ) {
+    Bytes ret( len_r );
+    for ( auto & c : ret )
+      c = rnd();
+    return ret;
+  };
+
+  // Compare with the scalar reuseBlocksOld. Few blocks use the smallest prefilter bitset, many blocks a larger one.
+  for ( size_t nblks : { 20U, 3000U } )
+  {
+    const size_t blksize = 64;
+    const Bytes & target { randomBytes( nblks * blksize ) };
+
+    // Random data with single blocks and runs of blocks of the target at unaligned offsets.
+    // (reuseBlocks misses a block directly following the end of a run, so there is noise in between.)
+    Bytes delta;
+    for ( size_t i = 0; i < nblks; i += 1 + rnd() % 5 )
+    {
+      const Bytes & noise { randomBytes( 1 + rnd() % ( 3 * blksize ) ) };
+      delta.insert( delta.end(), noise.begin(), noise.end() );
+      const size_t run = std::min<size_t>( 1 + rnd() % 4, nblks - i );
+      delta.insert( delta.end(), target.begin() + i * blksize, target.begin() + ( i + run ) * blksize );
+    }
+    const Bytes & tail { randomBytes( 5 * blksize + 3 ) };
+    delta.insert( delta.end(), tail.begin(), tail.end() );
+
+    filesystem::TmpFile deltaFile;
+    writeFile( deltaFile.path(), delta );
+
+    for ( uint rsumseq : { 1U, 2U } )
+    {
+      for ( int rsumlen : { 2, 3, 4 } )
+      {
+        BOOST_TEST_CONTEXT( "nblks " << nblks << " rsumseq " << rsumseq << " rsumlen " << rsumlen )
+        {
+          const Bytes & scalar { reuse( target, blksize, rsumlen, rsumseq, deltaFile.path(), true ) };
+          const Bytes & vectorized { reuse( target, blksize, rsumlen, rsumseq, deltaFile.path(), false ) };
+          BOOST_CHECK( ! scalar.empty() );
+          BOOST_CHECK( scalar == vectorized );
+        }
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(reuse_blocks_prefilter)
+{
+  // Few distinct byte values: many offsets pass the prefilter and the weak
+  // rsum check, but only real blocks of the target may be reused.
+  std::mt19937 rnd( 815 );
+  const auto lowEntropyBytes = [&]( size_t len_r ) {
+    Bytes ret( len_r );
+    for ( auto & c : ret )
+      c = rnd() % 4;
+    return ret;
+  };
+
+  const size_t blksize = 32;
+  const Bytes & delta { lowEntropyBytes( 200 * blksize ) };
+  filesystem::TmpFile deltaFile;
+  writeFile( deltaFile.path(), delta );
+
+  const Bytes & unrelated { lowEntropyBytes( 50 * blksize ) };
+  const Bytes contained( delta.begin() + 7, delta.begin() + 7 + 50 * blksize );
+  for ( uint rsumseq : { 1U, 2U } )
+  {
+    const Bytes & scalar { reuse( unrelated, blksize, 2, rsumseq, deltaFile.path(), true ) };
+    const Bytes & vectorized { reuse( unrelated, blksize, 2, rsumseq, deltaFile.path(), false ) };
+    BOOST_CHECK( scalar.empty() );
+    BOOST_CHECK( scalar == vectorized );
+  }
+  for ( uint rsumseq : { 1U, 2U } )
+  {
+    const Bytes & scalar { reuse( contained, blksize, 2, rsumseq, deltaFile.path(), true ) };
+    const Bytes & vectorized { reuse( contained, blksize, 2, rsumseq, deltaFile.path(), false ) };
+    BOOST_CHECK( scalar == contained );
+    BOOST_CHECK( scalar == vectorized );
+  }
+}
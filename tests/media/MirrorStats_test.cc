@@ -0,0 +1,83 @@
+#include <iostream>
+#include <fstream>
+#include <boost/test/unit_test.hpp>
+
+#include <zypp/TmpPath.h>
+#include <zypp/PathInfo.h>
+#include <zypp-curl/private/mirrorstats_p.h>
+
+using std::cout;
+using std::endl;
+using namespace zypp;
+using namespace zypp::media;
+
+namespace
+{
+  /** Write a stats file as another process would do. */
+  void writeStats( const Pathname & file_r, const std::string & lines_r )
+  {
+    std::ofstream out( file_r.c_str() );
+    out << "# zypp mirror stats 1" << endl << lines_r;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(mirrorstats_decay)
+{
+  MirrorStats::Entry entry;
+  entry.lastSeen = 1000;
+  BOOST_CHECK_EQUAL( entry.weight( 1000 ), 1.0 );
+  BOOST_CHECK_EQUAL( entry.weight( 500 ), 1.0 );
+  BOOST_CHECK_CLOSE( entry.weight( 1000 + MirrorStats::halfLife ), 0.5, 0.0001 );
+  BOOST_CHECK_CLOSE( entry.weight( 1000 + 2 * MirrorStats::halfLife ), 0.25, 0.0001 );
+}
+
+BOOST_AUTO_TEST_CASE(mirrorstats_load_save)
+{
+  filesystem::TmpDir tmp;
+  const Pathname file { tmp.path() / "mirrorstats" };
+  const std::time_t now = std::time( nullptr );
+  const std::string key { MirrorStats::makeKey( Url("https://mirror.example.org:8080/repo/x86_64/a.rpm") ) };
+  BOOST_CHECK_EQUAL( key, "https://mirror.example.org:8080" );
+
+  // Aged failures decay, outdated entries are dropped on load.
+  writeStats( file, str::Str()
+              << "https://old.example.org 1000 10 4 " << now - MirrorStats::halfLife << endl
+              << "https://gone.example.org 1000 10 0 " << now - MirrorStats::maxAge - 10 << endl
+              << "broken line" << endl );
+  MirrorStats & stats { MirrorStats::instance() };
+  stats.setStatsFile( file );
+  BOOST_CHECK_EQUAL( stats.statsFile(), file );
+  BOOST_CHECK_CLOSE( stats.get( "https://old.example.org" ).failures, 2.0, 1.0 );
+  BOOST_CHECK( ! stats.fresh( "https://old.example.org" ) );
+  BOOST_CHECK_EQUAL( stats.get( "https://gone.example.org" ).lastSeen, 0 );
+
+  // Failures make a host more expensive than an unknown one.
+  stats.recordLatency( key, 50.0 );
+  stats.recordThroughput( key, 10 << 20, 1.0 );
+  stats.recordSuccess( key );
+  BOOST_CHECK( stats.fresh( key ) );
+  BOOST_CHECK_LT( stats.cost( key ), stats.cost( "https://unknown.example.org" ) );
+  stats.recordFailure( "https://bad.example.org" );
+  BOOST_CHECK_GT( stats.cost( "https://bad.example.org" ), stats.cost( "https://unknown.example.org" ) );
+
+  // Another process saved meanwhile: its hosts are kept, ours replace the ones in the file.
+  writeStats( file, str::Str()
+              << "https://other.example.org 2000 20 0 " << now << endl
+              << key << " 1 1000 9 " << now << endl );
+  stats.save();
+  BOOST_CHECK_EQUAL( stats.get( "https://other.example.org" ).throughput, 2000.0 );
+  BOOST_CHECK_EQUAL( stats.get( "https://old.example.org" ).throughput, 0.0 );	// not in the file anymore
+
+  // Reload (switching the file saves and loads).
+  stats.setStatsFile( Pathname() );
+  BOOST_CHECK_EQUAL( stats.get( key ).lastSeen, 0 );
+  stats.setStatsFile( file );
+  MirrorStats::Entry entry { stats.get( key ) };
+  BOOST_CHECK_CLOSE( entry.latency, 50.0, 0.0001 );
+  BOOST_CHECK_CLOSE( entry.throughput, 10 << 20, 0.0001 );
+  BOOST_CHECK_EQUAL( entry.failures, 0.0 );
+  BOOST_CHECK_EQUAL( stats.get( "https://bad.example.org" ).failures, 1.0 );
+  BOOST_CHECK_EQUAL( stats.get( "https://other.example.org" ).latency, 20.0 );
+
+  stats.setStatsFile( Pathname() );
+}
@@ -0,0 +1,97 @@
+#include <iostream>
+#include <fstream>
+#include <unistd.h>
+#include <boost/test/unit_test.hpp>
+
+#include <zypp/Digest.h>
+#include <zypp/TmpPath.h>
+#include <zypp/PathInfo.h>
+#include <zypp-curl/private/zckchunkstore_p.h>
+
+using std::cout;
+using std::endl;
+using namespace zypp;
+using namespace zypp::media;
+
+namespace
+{
+  std::string storeChunk( ZckChunkStore & store_r, const std::string & data_r )
+  {
+    std::string digest { Digest::digest( Digest::sha256(), data_r ) };
+    store_r.store( Digest::sha256(), digest, data_r.data(), data_r.size() );
+    return digest;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(chunkstore_lookup)
+{
+  filesystem::TmpDir tmp;
+  ZckChunkStore & store { ZckChunkStore::instance() };
+  store.setStoreDir( tmp.path() / "chunks" );
+  BOOST_CHECK( store.enabled() );
+
+  std::string digest { storeChunk( store, "chunk one" ) };
+  BOOST_CHECK( store.contains( Digest::sha256(), digest ) );
+  BOOST_CHECK_EQUAL( store.stats().stored, 1 );
+
+  auto data { store.lookup( Digest::sha256(), digest ) };
+  BOOST_REQUIRE( data );
+  BOOST_CHECK_EQUAL( *data, "chunk one" );
+
+  // chunks are keyed by the digest as given
+  data = store.lookup( Digest::sha256(), digest.substr( 0, 32 ) );
+  BOOST_CHECK( ! data );
+
+  // not a hex string
+  BOOST_CHECK( ! store.lookup( Digest::sha256(), "../../etc" ) );
+
+  // corrupt chunks are removed
+  std::string other { storeChunk( store, "chunk two" ) };
+  Pathname file { tmp.path() / "chunks" / Digest::sha256() / other.substr( 0, 2 ) / other };
+  BOOST_REQUIRE( PathInfo( file ).isFile() );
+  filesystem::unlink( file );
+  BOOST_REQUIRE( ! PathInfo( file ).isExist() );
+  std::ofstream( file.c_str() ) << "garbage";
+  BOOST_CHECK( ! store.lookup( Digest::sha256(), other ) );
+  BOOST_CHECK( ! store.contains( Digest::sha256(), other ) );
+
+  store.recordHit( 9 );
+  store.commit();
+  BOOST_CHECK( PathInfo( tmp.path() / "chunks" / "stats" ).isFile() );
+
+  // stats are persistent
+  store.setStoreDir( Pathname() );
+  BOOST_CHECK( ! store.enabled() );
+  store.setStoreDir( tmp.path() / "chunks" );
+  BOOST_CHECK_EQUAL( store.stats().hits, 1 );
+  BOOST_CHECK_EQUAL( store.stats().bytesSaved, 9 );
+  store.setStoreDir( Pathname() );
+}
+
+BOOST_AUTO_TEST_CASE(chunkstore_trim)
+{
+  filesystem::TmpDir tmp;
+  ZckChunkStore & store { ZckChunkStore::instance() };
+  store.setStoreDir( tmp.path() / "chunks" );
+  store.setMaxSize( 1000 );
+
+  std::vector<std::string> digests;
+  for ( char ch = 'a'; ch < 'f'; ++ch )
+    digests.push_back( storeChunk( store, std::string( 300, ch ) ) );
+  // a hit makes the first one the most recently used
+  ::sleep( 1 );
+  BOOST_CHECK( store.lookup( Digest::sha256(), digests[0] ) );
+
+  // trimmed down to 90% of the limit
+  store.commit();
+  BOOST_CHECK_EQUAL( store.stats().evicted, 2 );
+  BOOST_CHECK( store.contains( Digest::sha256(), digests[0] ) );
+  unsigned kept = 0;
+  for ( const std::string & digest : digests )
+    if ( store.contains( Digest::sha256(), digest ) )
+      ++kept;
+  BOOST_CHECK_EQUAL( kept, 3 );
+
+  store.setMaxSize( ZckChunkStore::defaultMaxSize );
+  store.setStoreDir( Pathname() );
+}
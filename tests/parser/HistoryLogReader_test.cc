@@ -1,4 +1,6 @@
+#include <fstream>
 #include "TestSetup.h"
+#include <zypp/TmpPath.h>
 #include <zypp/parser/HistoryLogReader.h>
 #include <zypp-core/parser/ParseException>
 
@@ -38,3 +40,72 @@ BOOST_AUTO_TEST_CASE(basic)
   HistoryLogDataInstall::Ptr p = dynamic_pointer_cast<HistoryLogDataInstall>( history[1] );
   BOOST_CHECK_EQUAL( p->userdata(), "trans|ID" ); // properly (un)escaped?
 }
+
+BOOST_AUTO_TEST_CASE(range)
+{
+  filesystem::TmpFile log;
+  {
+    std::ofstream out( log.path().c_str() );
+    out << "# leading comment" << std::endl;
+    for ( unsigned day = 1; day <= 9; ++day )
+    {
+      out << "2020-01-0" << day << " 12:00:00|remove |pkg" << day << "|1-1|noarch|root@here|" << std::endl;
+      out << "# 2020-01-0" << day << " rpm output" << std::endl;
+    }
+  }
+
+  std::vector<std::string> names;
+  parser::HistoryLogReader parser( log.path(), parser::HistoryLogReader::Options(),
+    [&names]( HistoryLogData::Ptr ptr )->bool {
+      names.push_back( (*ptr)[HistoryLogDataRemove::NAME_INDEX] );
+      return true;
+    } );
+  const char * fmt = "%Y-%m-%d %H:%M:%S";
+
+  parser.readFrom( Date( "2020-01-07 12:00:00", fmt ) );
+  BOOST_CHECK_EQUAL( str::join( names ), "pkg8 pkg9" );
+
+  names.clear();
+  parser.readFrom( Date( "2019-12-31 00:00:00", fmt ) );
+  BOOST_CHECK_EQUAL( names.size(), 9 );
+
+  names.clear();
+  parser.readFrom( Date( "2020-02-01 00:00:00", fmt ) );
+  BOOST_CHECK( names.empty() );
+
+  names.clear();
+  parser.readFromTo( Date( "2020-01-02", "%Y-%m-%d" ), Date( "2020-01-05", "%Y-%m-%d" ) );
+  BOOST_CHECK_EQUAL( str::join( names ), "pkg2 pkg3 pkg4" );
+
+  names.clear();
+  parser.readFromTo( Date( "2020-01-05", "%Y-%m-%d" ), Date( "2020-01-02", "%Y-%m-%d" ) );
+  BOOST_CHECK( names.empty() );
+
+  names.clear();
+  parser.readAllReverse();
+  BOOST_CHECK_EQUAL( str::join( names ), "pkg9 pkg8 pkg7 pkg6 pkg5 pkg4 pkg3 pkg2 pkg1" );
+}
+
+BOOST_AUTO_TEST_CASE(reverse)
+{
+  std::vector<HistoryLogData::Ptr> history;
+  parser::HistoryLogReader parser( TESTS_SRC_DIR "/parser/HistoryLogReader_test.dat",
+                                   parser::HistoryLogReader::IGNORE_INVALID_ITEMS,
+    [&history]( HistoryLogData::Ptr ptr )->bool {
+      history.push_back( ptr );
+      return history.size() < 3;	// the last 3 entries only
+    } );
+
+  parser.readAllReverse();
+  BOOST_CHECK_EQUAL( history.size(), 3 );
+  BOOST_CHECK( dynamic_pointer_cast<HistoryLogPatchStateChange>	( history[0] ) );
+  BOOST_CHECK( dynamic_pointer_cast<HistoryLogDataStampCommand>	( history[1] ) );
+  BOOST_CHECK( dynamic_pointer_cast<HistoryLogData>		( history[2] ) );
+
+  history.clear();
+  parser.addActionFilter( HistoryActionID::REMOVE );
+  parser.readAllReverse();
+  BOOST_CHECK_EQUAL( history.size(), 2 );
+  BOOST_CHECK_EQUAL( (*history[0])[HistoryLogDataRemove::NAME_INDEX], "xchat-python" );
+  BOOST_CHECK_EQUAL( (*history[1])[HistoryLogDataRemove::NAME_INDEX], "PolicyKit-doc" );
+}
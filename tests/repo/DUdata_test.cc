@@ -3,6 +3,7 @@
 #include <fstream>
 #include <list>
 #include <string>
+#include <vector>
 
 #include <boost/test/unit_test.hpp>
 
@@ -110,3 +111,61 @@ BOOST_AUTO_TEST_CASE(dudata)
   ins.status().setTransact( false, ResStatus::USER );
   up3.status().setTransact( false, ResStatus::USER );
 }
+
+BOOST_AUTO_TEST_CASE(dudata_tracked)
+{
+  Pathname repodir( TEST_DIR );
+  TestSetup test( Arch_x86_64 );
+  test.loadTargetRepo( repodir/"system" );
+  test.loadRepo( repodir/"repo", "repo" );
+
+  ResPool pool( ResPool::instance() );
+  std::vector<PoolItem> pis {
+    piFind( "dutest", "1.0", true ),
+    piFind( "dutest", "1.0" ),
+    piFind( "dutest", "2.0" ),
+    piFind( "dutest", "3.0" ),	// no DU data
+  };
+
+  const DiskUsageCounter::MountPointSet mps { DiskUsageCounter::MountPoint( "/grow", DiskUsageCounter::MountPoint::Hint_growonly ),
+                                              DiskUsageCounter::MountPoint( "/norm" ) };
+  DiskUsageCounter duc( mps );	// keeps tracking the changes
+
+  // A fresh counter computes the disk usage from scratch.
+  auto checkTracked = [&]( const std::string & step_r ) {
+    BOOST_TEST_CONTEXT( step_r )
+    { BOOST_CHECK_EQUAL( getSize( duc, pool ), getSize( DiskUsageCounter( mps ), pool ) ); }
+  };
+
+  // Walk all transact combinations in gray code order (one toggle per step), several times.
+  unsigned state = 0;
+  for ( unsigned round = 0; round < 3; ++round )
+  {
+    for ( unsigned i = 1; i <= ( 1U << pis.size() ); ++i )
+    {
+      unsigned gray = i % ( 1U << pis.size() );	// back to 0 in the last step
+      unsigned next = gray ^ ( gray >> 1 );
+      for ( unsigned b = 0; b < pis.size(); ++b )
+      {
+        if ( ( state ^ next ) & ( 1U << b ) )
+          pis[b].status().setTransact( next & ( 1U << b ), ResStatus::USER );
+      }
+      state = next;
+      checkTracked( str::Str() << "round " << round << " state " << state );
+    }
+  }
+  BOOST_CHECK_EQUAL( getSize( duc, pool ), mkByteSet( 0, 0 ) );
+
+  // Installing the package without DU data is not additive; the totals must recover afterwards.
+  pis[1].status().setTransact( true, ResStatus::USER );
+  BOOST_CHECK_EQUAL( getSize( duc, pool ), mkByteSet( 15, 15 ) );
+  pis[3].status().setTransact( true, ResStatus::USER );
+  checkTracked( "known and unknown DU" );
+  pis[3].status().setTransact( false, ResStatus::USER );
+  BOOST_CHECK_EQUAL( getSize( duc, pool ), mkByteSet( 15, 15 ) );
+  pis[0].status().setTransact( true, ResStatus::USER );
+  BOOST_CHECK_EQUAL( getSize( duc, pool ), mkByteSet( 15, 10 ) );
+  pis[0].status().setTransact( false, ResStatus::USER );
+  pis[1].status().setTransact( false, ResStatus::USER );
+  BOOST_CHECK_EQUAL( getSize( duc, pool ), mkByteSet( 0, 0 ) );
+}
@@ -0,0 +1,84 @@
+#include <iostream>
+#include <set>
+#include <string>
+
+#include <boost/test/unit_test.hpp>
+
+#include <zypp/base/Logger.h>
+#include <zypp/ExternalProgram.h>
+#include <zypp/PathInfo.h>
+#include <zypp/TmpPath.h>
+#include <zypp/Repository.h>
+#include <zypp/sat/Pool.h>
+#include <zypp/sat/LookupAttr.h>
+#include <zypp/zypp_detail/repo2solv_p.h>
+
+using namespace zypp;
+
+namespace
+{
+  /** All solvables of \a repo_r with their dependencies and attributes, independent of the order. */
+  std::multiset<std::string> solvDump( const Repository & repo_r )
+  {
+    std::multiset<std::string> ret;
+    for ( const sat::Solvable & solv : repo_r.solvables() )
+    {
+      str::Str str;
+      dumpOn( str.stream(), solv );
+      for_( it, sat::LookupAttr( sat::SolvAttr::allAttr, solv ).begin(), sat::LookupAttr::iterator() )
+        str << it.inSolvAttr() << " = " << it.asString() << std::endl;
+      ret.insert( str );
+    }
+    return ret;
+  }
+
+  /** The repository attributes of \a repo_r (repomd, suseinfo, toolversion,..). */
+  std::multiset<std::string> repoDump( const Repository & repo_r )
+  {
+    std::multiset<std::string> ret;
+    for_( it, sat::LookupRepoAttr( sat::SolvAttr::allAttr, repo_r ).begin(), sat::LookupAttr::iterator() )
+      ret.insert( str::Str() << it.inSolvAttr() << " = " << it.asString() );
+    return ret;
+  }
+
+  /** The solv file built by the external <tt>repo2solv -X</tt>. */
+  void repo2solvExternal( const Pathname & productdatapath_r, const Pathname & solvfile_r )
+  {
+    ExternalProgram::Arguments cmd { "repo2solv", "-o", solvfile_r.asString(), "-X", productdatapath_r.asString() };
+    ExternalProgram prog( cmd, ExternalProgram::Stderr_To_Stdout );
+    for ( std::string line = prog.receiveLine(); ! line.empty(); line = prog.receiveLine() )
+      MIL << "  " << line;
+    BOOST_REQUIRE_EQUAL( prog.close(), 0 );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(repo2solv_rpmmd)
+{
+  if ( ! PathInfo( "/usr/bin/repo2solv" ).isFile() )
+  {
+    BOOST_WARN( "repo2solv test requires /usr/bin/repo2solv!" );
+    return;
+  }
+
+  // primary with filelist entries, susedata and suseinfo / updateinfo and deltainfo / a large updateinfo
+  for ( const char * fixture : { "/repo/yum/data/extensions", "/zypp/data/Delta", "/data/11.0-update" } )
+  {
+    BOOST_TEST_CONTEXT( fixture )
+    {
+      const Pathname productdatapath { Pathname(TESTS_SRC_DIR) / fixture };
+      filesystem::TmpDir tmp;
+      repo2solvRpmmd( productdatapath, tmp.path() / "inprocess.solv" );
+      repo2solvExternal( productdatapath, tmp.path() / "external.solv" );
+
+      Repository inprocess( sat::Pool::instance().addRepoSolv( tmp.path() / "inprocess.solv", "inprocess" ) );
+      Repository external( sat::Pool::instance().addRepoSolv( tmp.path() / "external.solv", "external" ) );
+      BOOST_CHECK_GT( inprocess.solvablesSize(), 0U );
+      BOOST_CHECK_EQUAL( inprocess.solvablesSize(), external.solvablesSize() );
+      BOOST_CHECK( solvDump( inprocess ) == solvDump( external ) );
+      BOOST_CHECK( repoDump( inprocess ) == repoDump( external ) );
+
+      inprocess.eraseFromPool();
+      external.eraseFromPool();
+    }
+  }
+}
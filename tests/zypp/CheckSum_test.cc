@@ -1,4 +1,5 @@
 #include <iostream>
+#include <fstream>
 #include <list>
 #include <string>
 
@@ -9,6 +10,8 @@
 #include <zypp/base/Exception.h>
 #include <zypp/ZYppFactory.h>
 #include <zypp/Digest.h>
+#include <zypp/TmpPath.h>
+#include <zypp-core/CheckSumBatch.h>
 #include <zypp/ZYpp.h>
 
 
@@ -51,3 +54,42 @@ BOOST_AUTO_TEST_CASE(checksum_test)
   chksumtest( CheckSum::sha384Type(),	"38b060a751ac96384cd9327eb1b1e36a21fdb71114be07434c0cc7bf63f6e1da274edebfe76f65fbd51ad2f14898b95b" );
   chksumtest( CheckSum::sha512Type(),	"cf83e1357eefb8bdf1542850d66d8007d620e4050b5715dc83f4a921d36ce9ce47d0d13c5d85f2b0ff8318d2877eec2f63b931bd47417a81a538327af927da3e" );
 }
+
+BOOST_AUTO_TEST_CASE(checksumbatch_test)
+{
+  filesystem::TmpDir tmp;
+  std::vector<CheckSumBatch::Item> items;
+  for ( unsigned i = 0; i < 20; ++i )
+  {
+    Pathname file( tmp.path() / str::numstring( i ) );
+    std::ofstream( file.c_str() ) << std::string( i * 1000, 'a' + i );
+    items.push_back( { file, CheckSum::sha256( std::ifstream( file.c_str() ) ) } );
+  }
+  items.push_back( { tmp.path() / "empty", CheckSum::sha1( "da39a3ee5e6b4b0d3255bfef95601890afd80709" ) } );
+  std::ofstream( (tmp.path() / "empty").c_str() );
+  items.push_back( { tmp.path() / "missing", CheckSum::sha1( "da39a3ee5e6b4b0d3255bfef95601890afd80709" ) } );
+  items.push_back( { tmp.path() / "1", CheckSum::md5( "d41d8cd98f00b204e9800998ecf8427e" ) } );	// wrong sum
+
+  for ( unsigned parallel : { 1U, 4U, 0U } )
+  {
+    const std::vector<CheckSumBatch::Result> & res( CheckSumBatch::verify( items, parallel ) );
+    BOOST_REQUIRE_EQUAL( res.size(), items.size() );
+    for ( unsigned i = 0; i < 20; ++i )
+    {
+      BOOST_CHECK_EQUAL( res[i].file, items[i].file );
+      BOOST_CHECK( res[i].ok() );
+    }
+    BOOST_CHECK( res[20].ok() );
+    BOOST_CHECK( ! res[21].ok() );
+    BOOST_CHECK( res[21].computed.empty() );
+    BOOST_CHECK( ! res[22].ok() );
+    BOOST_CHECK_EQUAL( res[22].computed, CheckSum::md5( std::ifstream( (tmp.path() / "1").c_str() ) ) );
+  }
+
+  CheckSumBatch batch;
+  BOOST_CHECK( batch.empty() );
+  batch.add( items[5].file, items[5].checksum );
+  BOOST_CHECK_EQUAL( batch.size(), 1 );
+  BOOST_CHECK( batch.verify().front().ok() );
+  BOOST_CHECK_EQUAL( CheckSumBatch::compute( items[5].file, CheckSum::sha256Type() ), items[5].checksum );
+}
@@ -0,0 +1,127 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <boost/test/unit_test.hpp>
+
+#include "TestSetup.h"
+#include "WebServer.h"
+
+#include <zypp/ZYppCallbacks.h>
+#include <zypp/PathInfo.h>
+#include <zypp/RepoManagerOptions.h>
+#include <zypp/target/rpm/RpmDb.h>
+#include <zypp/target/CommitPackagePreloader.h>
+
+using std::cout;
+using std::endl;
+using namespace zypp;
+
+#define DATADIR (Pathname(TESTS_SRC_DIR) + "/zypp/data/CommitPackagePreloader")
+
+namespace
+{
+  /** Record the DownloadResolvableReport sequence. */
+  struct DownloadReportRecorder : public callback::ReceiveReport<repo::DownloadResolvableReport>
+  {
+    void start( Resolvable::constPtr res_r, const Url & url_r ) override
+    {
+      _seq.push_back( "start " + res_r->name() );
+      _urls.push_back( url_r );
+    }
+
+    bool progress( int value_r, Resolvable::constPtr res_r ) override
+    {
+      _seq.push_back( "progress " + res_r->name() + " " + str::numstring( value_r ) );
+      return true;
+    }
+
+    void finish( Resolvable::constPtr res_r, Error error_r, const std::string & ) override
+    { _seq.push_back( "finish " + res_r->name() + ( error_r == NO_ERROR ? "" : " error" ) ); }
+
+    std::vector<std::string> _seq;
+    std::vector<Url> _urls;
+  };
+
+  std::vector<sat::Solvable> heap( const Repository & repo_r, const std::vector<std::string> & names_r )
+  {
+    std::vector<sat::Solvable> ret;
+    for ( const std::string & name : names_r )
+    {
+      for ( const sat::Solvable & solv : repo_r.solvables() )
+      {
+        if ( solv.name() == name )
+          ret.push_back( solv );
+      }
+    }
+    BOOST_REQUIRE_EQUAL( ret.size(), names_r.size() );
+    return ret;
+  }
+
+  /** Check \a seq_r contains a complete start/progress/finish sequence for each of \a names_r, one package at a time. */
+  void checkReports( const std::vector<std::string> & seq_r, std::vector<std::string> names_r )
+  {
+    BOOST_REQUIRE_EQUAL( seq_r.size(), 3 * names_r.size() );
+    std::vector<std::string> reported;
+    for ( unsigned i = 0; i < seq_r.size(); i += 3 )
+    {
+      BOOST_REQUIRE( str::hasPrefix( seq_r[i], "start " ) );
+      const std::string & name { seq_r[i].substr( 6 ) };
+      BOOST_CHECK_EQUAL( seq_r[i+1], "progress " + name + " 100" );
+      BOOST_CHECK_EQUAL( seq_r[i+2], "finish " + name );
+      reported.push_back( name );
+    }
+    // downloads may finish in any order
+    std::sort( reported.begin(), reported.end() );
+    std::sort( names_r.begin(), names_r.end() );
+    BOOST_CHECK_EQUAL_COLLECTIONS( reported.begin(), reported.end(), names_r.begin(), names_r.end() );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(preload_heaps)
+{
+  WebServer web( DATADIR, 10001 );
+  web.start();
+
+  TestSetup test( Arch_x86_64 );
+  test.loadRepo( DATADIR, "preload" );
+  Repository repo { test.satpool().reposFind( "preload" ) };
+  BOOST_REQUIRE( repo );
+
+  // Make it a downloading repo using the default package cache.
+  RepoInfo info { repo.info() };
+  info.setBaseUrl( web.url() );
+  info.setPackagesPath( RepoManagerOptions().repoPackagesCachePath / info.alias() );
+  info.setGpgCheck( false );
+  repo.setInfo( info );
+
+  DownloadReportRecorder recorder;
+  recorder.connect();
+
+  target::rpm::RpmDb rpmDb;
+  target::CommitPackagePreloader preloader( rpmDb, 2 );
+  preloader.setWorkerPath( Pathname( TESTS_BUILD_DIR ).dirname() / "tools" / "workers" );
+
+  // First heap: both packages are downloaded and reported one after the other.
+  BOOST_CHECK_EQUAL( preloader.preload( heap( repo, { "pkga", "pkgb" } ) ), 2U );
+  checkReports( recorder._seq, { "pkga", "pkgb" } );
+  for ( const Url & url : recorder._urls )
+    BOOST_CHECK_EQUAL( url.getScheme(), "http" );
+
+  // Second heap: a broken checksum and a missing file are left to the PackageProvider (not reported).
+  recorder._seq.clear();
+  BOOST_CHECK_EQUAL( preloader.preload( heap( repo, { "pkgc", "broken", "missing" } ) ), 1U );
+  checkReports( recorder._seq, { "pkgc" } );
+
+  for ( const std::string & name : { "pkga", "pkgb", "pkgc" } )
+    BOOST_CHECK( PathInfo( info.packagesPath() / "noarch" / ( name + "-1.0-1.noarch.rpm" ) ).isFile() );
+  for ( const std::string & name : { "broken", "missing" } )
+    BOOST_CHECK( ! PathInfo( info.packagesPath() / "noarch" / ( name + "-1.0-1.noarch.rpm" ) ).isExist() );
+
+  // Already cached packages are neither downloaded nor reported again.
+  recorder._seq.clear();
+  BOOST_CHECK_EQUAL( preloader.preload( heap( repo, { "pkga", "pkgb", "pkgc" } ) ), 0U );
+  BOOST_CHECK( recorder._seq.empty() );
+
+  recorder.disconnect();
+}
@@ -3,6 +3,7 @@
 #include <fstream>
 #include <list>
 #include <string>
+#include <vector>
 
 #include <boost/test/unit_test.hpp>
 
@@ -14,6 +15,7 @@
 #include <zypp/sat/Pool.h>
 #include <zypp/repo/DeltaCandidates.h>
 #include <zypp/repo/PackageDelta.h>
+#include <zypp/repo/Applydeltarpm.h>
 #include "KeyRingTestReceiver.h"
 
 using boost::unit_test::test_case;
@@ -58,6 +60,11 @@ BOOST_AUTO_TEST_CASE(delta)
     BOOST_CHECK(it->arch() == "i386");
     BOOST_CHECK(it->baseversion().edition().match(Edition("4.21.3-1"))
       ||it->baseversion().edition().match(Edition("4.21.2-3")));
+    // The sequence info is what applydeltarpm's quick check is run on before a delta is chosen.
+    BOOST_CHECK( str::startsWith( it->baseversion().sequenceinfo(), "libzypp-"+it->baseversion().edition().asString()+"-" ) );
+    // The base version is not on disk, so the delta must not be chosen.
+    if ( applydeltarpm::haveApplydeltarpm() )
+      BOOST_CHECK( ! applydeltarpm::quickcheck( it->baseversion().sequenceinfo() ) );
 
     cout << it->name() << " - " << it->edition() << " - " <<  it->arch()
       << " base: " << it->baseversion().edition() << endl;
@@ -67,4 +74,44 @@ BOOST_AUTO_TEST_CASE(delta)
     cout << (it->edition().match(Edition("4.21.3-2")) == 0) << endl; // match returns -1,0,1
     cout << (it->edition().match("4.21.3-2") == 0) << endl;          // match returns -1,0,1
   }
+  BOOST_CHECK_EQUAL( deltas.size(), repo::DeltaCandidates(std::list<Repository>(pool.reposBegin(),pool.reposEnd())).deltaRpms(0).size() );
+
+  // The delta is for i386, the repo provides libzypp-4.21.3-2 for other archs only.
+  std::vector<Package::constPtr> pkgs;
+  for ( const sat::Solvable & solv : pool.solvables() )
+  {
+    if ( solv.isKind<Package>() && solv.name() == "libzypp" )
+      pkgs.push_back( make<Package>( solv ) );
+  }
+  BOOST_REQUIRE( ! pkgs.empty() );
+  const std::vector<std::list<packagedelta::DeltaRpm>> & perPkg( dc.deltaRpms( pkgs ) );
+  BOOST_REQUIRE_EQUAL( perPkg.size(), pkgs.size() );
+  for ( unsigned i = 0; i < pkgs.size(); ++i )
+  {
+    BOOST_CHECK( perPkg[i].empty() );
+    BOOST_CHECK( dc.deltaRpms( pkgs[i] ).empty() );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(applydeltarpm_background)
+{
+  // The command the preloader runs in the background to build the package...
+  const std::vector<std::string> & cmd( applydeltarpm::provideCommand( "/tmp/a.drpm", "/tmp/a.rpm" ) );
+  BOOST_REQUIRE_EQUAL( cmd.size(), 5U );
+  BOOST_CHECK_EQUAL( cmd[1], "-p" );
+  BOOST_CHECK_EQUAL( cmd[2], "-p" );
+  BOOST_CHECK_EQUAL( cmd[3], "/tmp/a.drpm" );
+  BOOST_CHECK_EQUAL( cmd[4], "/tmp/a.rpm" );
+
+  // ...and the progress lines it reports.
+  unsigned percent = 0;
+  BOOST_CHECK( applydeltarpm::parseProgress( "42 percent finished.", percent ) );
+  BOOST_CHECK_EQUAL( percent, 42U );
+  BOOST_CHECK( applydeltarpm::parseProgress( "100 percent finished.\n", percent ) );
+  BOOST_CHECK_EQUAL( percent, 100U );
+  percent = 7;
+  BOOST_CHECK( ! applydeltarpm::parseProgress( "percent finished.", percent ) );
+  BOOST_CHECK( ! applydeltarpm::parseProgress( "md5 mismatch", percent ) );
+  BOOST_CHECK( ! applydeltarpm::parseProgress( "", percent ) );
+  BOOST_CHECK_EQUAL( percent, 7U );
 }
@@ -6,6 +6,7 @@
 
 #include <zypp/base/Logger.h>
 #include <zypp/base/Exception.h>
+#include <zypp/base/String.h>
 #include <zypp/KeyRing.h>
 #include <zypp/PublicKey.h>
 #include <zypp/TmpPath.h>
@@ -316,3 +317,29 @@ BOOST_AUTO_TEST_CASE(keyring_delete)
   }
 }
 
+
+BOOST_AUTO_TEST_CASE(keyring_lookup)
+{
+  PublicKey key( Pathname(DATADIR) + "public.asc" );
+  TmpDir tmp_dir;
+  KeyRing keyring( tmp_dir.path() );
+  keyring.importKey( key, false );
+
+  // fingerprint, long and short id, case insensitive
+  BOOST_CHECK_EQUAL( keyring.publicKeyData( key.fingerprint() ).fingerprint(), key.fingerprint() );
+  BOOST_CHECK_EQUAL( keyring.publicKeyData( key.id() ).fingerprint(), key.fingerprint() );
+  BOOST_CHECK_EQUAL( keyring.publicKeyData( str::toUpper( key.id() ) ).fingerprint(), key.fingerprint() );
+  BOOST_CHECK_EQUAL( keyring.publicKeyData( key.id().substr( 8 ) ).fingerprint(), key.fingerprint() );
+  for ( const PublicSubkeyData & sub : key.keyData().subkeys() )
+    BOOST_CHECK_EQUAL( keyring.publicKeyData( sub.id() ).fingerprint(), key.fingerprint() );
+
+  // neither a short nor a safe id
+  BOOST_CHECK( ! keyring.publicKeyData( key.id().substr( 4 ) ) );
+  BOOST_CHECK( ! keyring.publicKeyData( "0123456789abcdef" ) );
+
+  // index follows the keyring
+  keyring.deleteKey( key.id(), false );
+  BOOST_CHECK( ! keyring.isKeyKnown( key.id() ) );
+  keyring.importKey( key, false );
+  BOOST_CHECK( keyring.isKeyKnown( key.id() ) );
+}
@@ -8,6 +8,8 @@
 #include <zypp/PoolQueryUtil.tcc>
 #include <zypp/TmpPath.h>
 #include <zypp/Locks.h>
+#include <zypp/PoolQueryResult.h>
+#include <zypp/pool/HardLockMatcher.h>
 #include "TestSetup.h"
 
 #define BOOST_TEST_MODULE Locks
@@ -116,3 +118,65 @@ BOOST_AUTO_TEST_CASE( locks_empty )
   locks.removeEmpty();
   BOOST_CHECK( locks.size() == 0 );
 }
+
+BOOST_AUTO_TEST_CASE( locks_hardlockmatcher )
+{
+  cout << "****hard lock matcher****"  << endl;
+  std::list<PoolQuery> queries;
+  {
+    PoolQuery q;	// like ResPool's trivial lock
+    q.addAttribute( sat::SolvAttr::name, "zypper" );
+    q.addKind( ResKind::package );
+    q.setMatchExact();
+    q.setCaseSensitive( true );
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;	// like zypper's lock without wildcard
+    q.addAttribute( sat::SolvAttr::name, "libzypp" );
+    q.setMatchGlob();
+    q.setCaseSensitive( true );
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;	// name pattern
+    q.addAttribute( sat::SolvAttr::name, "kde*" );
+    q.addAttribute( sat::SolvAttr::name, "GNOME*" );
+    q.setMatchGlob();
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;	// name pattern restricted to a repo
+    q.addAttribute( sat::SolvAttr::name, "^yast2-[a-n]" );
+    q.addRepo( "opensuse" );
+    q.setMatchRegex();
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;	// needs to be queried
+    q.addDependency( sat::SolvAttr::name, "sat-solver", Rel::GE, Edition("0.13") );
+    queries.push_back( q );
+  }
+
+  PoolQueryResult expected;
+  for ( const PoolQuery & q : queries )
+    expected += q;
+  BOOST_CHECK( ! expected.empty() );
+
+  std::vector<sat::Solvable> all( sat::Pool::instance().solvablesBegin(), sat::Pool::instance().solvablesEnd() );
+  sat::SolvableSet locked( pool::HardLockMatcher( queries ).locked( all ) );
+  BOOST_CHECK_EQUAL( locked.size(), expected.size() );
+  for ( const sat::Solvable & solv : expected )
+    BOOST_CHECK( locked.contains( solv ) );
+
+  // just the @System solvables
+  std::vector<sat::Solvable> sys;
+  for ( const sat::Solvable & solv : all )
+    if ( solv.isSystem() )
+      sys.push_back( solv );
+  locked = pool::HardLockMatcher( queries ).locked( sys );
+  for ( const sat::Solvable & solv : sys )
+    BOOST_CHECK_EQUAL( locked.contains( solv ), expected.contains( solv ) );
+  for ( const sat::Solvable & solv : locked )
+    BOOST_CHECK( solv.isSystem() );
+}
@@ -0,0 +1,44 @@
+#include <iostream>
+#include <boost/test/unit_test.hpp>
+
+#include <zypp/target/modalias/Modalias.h>
+
+using std::cout;
+using std::endl;
+using namespace zypp;
+using target::Modalias;
+
+BOOST_AUTO_TEST_CASE(query)
+{
+  Modalias & modalias( Modalias::instance() );
+  modalias.modaliasList( {
+    "usb:v046DpC52Bd2410dc00dsc00dp00ic03isc01ip01in00",
+    "pci:v00008086d0000265Asv00008086sd00004556bc0Csc03i00",
+    "acpi:PNP0C0A:",
+    "pci:v0000104Cd00008400sv00001186sd00003B00bc02sc80i00",
+  } );
+  BOOST_CHECK_EQUAL( modalias.modaliasList().size(), 4 );
+  BOOST_CHECK_EQUAL( modalias.refresh(), false );	// manually set list
+
+  BOOST_CHECK( ! modalias.query( "" ) );
+  BOOST_CHECK( ! modalias.query( (const char *)nullptr ) );
+  BOOST_CHECK( modalias.query( "pci:v00008086d0000265Asv00008086sd00004556bc0Csc03i00" ) );
+  BOOST_CHECK( modalias.query( "pci:v00008086d0000265Asv*sd*bc*sc*i*" ) );
+  BOOST_CHECK( modalias.query( "pci:v00008086d0000265?sv*" ) );
+  BOOST_CHECK( ! modalias.query( "pci:v00008086d0000265Bsv*sd*bc*sc*i*" ) );
+  BOOST_CHECK( ! modalias.query( "pci:v00008086d0000265Asv*sd*bc*sc*i" ) );
+  BOOST_CHECK( modalias.query( "pci:v0000104Cd0000840[01]sv*sd*bc*sc*i*" ) );
+  BOOST_CHECK( ! modalias.query( "pci:v0000104Cd0000840[23]sv*sd*bc*sc*i*" ) );
+  BOOST_CHECK( modalias.query( "usb:v046Dp*" ) );
+  BOOST_CHECK( modalias.query( "*:PNP0C0A:" ) );
+  BOOST_CHECK( modalias.query( "*" ) );
+  BOOST_CHECK( ! modalias.query( "pci:v0000104C" ) );
+
+  // remembered results are discarded if the list changes
+  modalias.modaliasList( { "usb:v1234" } );
+  BOOST_CHECK( ! modalias.query( "usb:v046Dp*" ) );
+  BOOST_CHECK( modalias.query( "usb:v*" ) );
+  modalias.modaliasList( {} );
+  BOOST_CHECK( ! modalias.query( "usb:v*" ) );
+  BOOST_CHECK( ! modalias.query( "*" ) );
+}
@@ -1,6 +1,7 @@
 #include "TestSetup.h"
 #include <zypp/PoolQuery.h>
 #include <zypp/PoolQueryUtil.tcc>
+#include <zypp/sat/SearchIndex.h>
 
 #define BOOST_TEST_MODULE PoolQuery
 
@@ -635,6 +636,64 @@ BOOST_AUTO_TEST_CASE(pool_predicated_matcher)
   }
 }
 
+BOOST_AUTO_TEST_CASE(pool_query_parallel)
+{
+  cout << "****parallel****"  << endl;
+  auto sameResult = []( PoolQuery q ) {
+    std::vector<sat::Solvable> serial( q.begin(), q.end() );
+    q.setParallel( 4 );
+    std::vector<sat::Solvable> parallel( q.begin(), q.end() );
+    BOOST_CHECK( serial == parallel );
+    return serial.size();
+  };
+
+  { // one attribute: partitioned by repo
+    PoolQuery q;
+    q.addString( "zypp" );
+    q.addAttribute( sat::SolvAttr::description );
+    BOOST_CHECK( sameResult( q ) > 0 );
+
+    q.setInstalledOnly();
+    sameResult( q );
+  }
+  { // several attributes: partitioned by solvable ranges
+    PoolQuery q;
+    q.addString( "kde" );
+    q.addAttribute( sat::SolvAttr::name );
+    q.addAttribute( sat::SolvAttr::summary );
+    q.addAttribute( sat::SolvAttr::filelist );
+    q.addKind( ResKind::package );
+    BOOST_CHECK( sameResult( q ) > 0 );
+
+    q.addRepo( "opensuse" );
+    q.addRepo( "zyppsvn" );
+    BOOST_CHECK( sameResult( q ) > 0 );
+  }
+  { // predicated: evaluated single threaded
+    PoolQuery q;
+    q.addDependency( sat::SolvAttr::name, "zy*", Rel::ANY, Edition(), Arch_empty, Match::GLOB );
+    BOOST_CHECK_EQUAL( sameResult( q ), 5 );
+  }
+  { // 'kind:name' predicate: evaluated concurrently
+    PoolQuery q;
+    q.addDependency( sat::SolvAttr::name, "package:zy*", Rel::ANY, Edition(), Arch_empty, Match::GLOB );
+    BOOST_CHECK( sameResult( q ) > 0 );
+
+    q.addDependency( sat::SolvAttr::name, "pattern:*", Rel::ANY, Edition(), Arch_empty, Match::GLOB );
+    q.addAttribute( sat::SolvAttr::summary, "kde" );
+    BOOST_CHECK( sameResult( q ) > 0 );
+  }
+  { // match details are still available
+    PoolQuery q;
+    q.addString( "libzypp" );
+    q.addAttribute( sat::SolvAttr::name );
+    q.addDependency( sat::SolvAttr::requires );
+    q.setParallel( 0 );
+    for_( it, q.begin(), q.end() )
+      BOOST_CHECK( ! it.matchesEmpty() );
+  }
+}
+
 BOOST_AUTO_TEST_CASE(pool_query_serialize)
 {
   std::vector<PoolQuery> queries;
@@ -987,3 +1046,78 @@ BOOST_AUTO_TEST_CASE(zypperLocksSerialize)
     }
   }
 }
+
+BOOST_AUTO_TEST_CASE(pool_query_searchindex)
+{
+  cout << "****searchindex****"  << endl;
+  auto result = []( const PoolQuery & q ) {
+    std::set<std::string> ret;	// repo gets reloaded, so we can't compare Solvables
+    for ( const sat::Solvable & solv : q )
+      ret.insert( solv.repository().alias() + ":" + solv.asString() );
+    return ret;
+  };
+
+  std::vector<PoolQuery> queries;
+  {
+    PoolQuery q;
+    q.addString( "zypp" );
+    q.addAttribute( sat::SolvAttr::description );
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;
+    q.addString( "*Zypp*" );
+    q.addString( "*kde*" );
+    q.setMatchGlob();
+    q.addAttribute( sat::SolvAttr::summary );
+    q.addAttribute( sat::SolvAttr::description );
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;
+    q.addAttribute( sat::SolvAttr::filelist, "^/usr/lib/libzypp\\.so" );
+    q.setMatchRegex();
+    q.setFilesMatchFullPath();
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;
+    q.addAttribute( sat::SolvAttr::summary, "library" );
+    q.setMatchWord();
+    q.setCaseSensitive();
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;
+    q.addAttribute( sat::SolvAttr::description, "a|b" );	// no trigram: not shortlisted
+    q.setMatchRegex();
+    queries.push_back( q );
+  }
+
+  std::vector<std::set<std::string>> expected;
+  for ( const PoolQuery & q : queries )
+    expected.push_back( result( q ) );
+  BOOST_CHECK( ! expected[0].empty() );
+
+  // Build the index and reload the repo:
+  Pathname solvfile( RepoManagerOptions::makeTestSetup( test.root() ).repoSolvCachePath / "opensuse" / "solv" );
+  sat::SearchIndex::build( solvfile );
+  BOOST_REQUIRE( PathInfo( sat::SearchIndex::indexFile( solvfile ) ).isFile() );
+
+  sat::Pool::instance().reposErase( "opensuse" );
+  Repository repo( sat::Pool::instance().addRepoSolv( solvfile, "opensuse" ) );
+  sat::SearchIndex::Ptr index( sat::SearchIndex::get( repo ) );
+  BOOST_REQUIRE( index );
+
+  sat::SearchIndex::Trigrams trigrams;
+  sat::SearchIndex::addTrigrams( trigrams, "ZYPP" );
+  BOOST_CHECK_EQUAL( trigrams.size(), 2 );
+  std::vector<sat::Solvable> candidates;
+  BOOST_CHECK( index->candidates( { trigrams }, candidates ) );
+  BOOST_CHECK( ! candidates.empty() );
+  BOOST_CHECK( candidates.size() < repo.solvablesSize() );
+  BOOST_CHECK( ! index->candidates( { sat::SearchIndex::Trigrams() }, candidates ) );
+
+  for ( unsigned i = 0; i < queries.size(); ++i )
+    BOOST_CHECK( result( queries[i] ) == expected[i] );
+}
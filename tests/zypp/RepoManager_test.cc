@@ -2,6 +2,7 @@
 #include <iostream>
 #include <fstream>
 #include <list>
+#include <vector>
 #include <string>
 
 #include <zypp/base/LogTools.h>
@@ -271,6 +272,46 @@ BOOST_AUTO_TEST_CASE(repomanager_test)
 
 }
 
+BOOST_AUTO_TEST_CASE(refresh_repos_test)
+{
+  TmpDir tmpCachePath;
+  RepoManagerOptions opts( RepoManagerOptions::makeTestSetup( tmpCachePath ) ) ;
+  RepoManager manager(opts);
+
+  KeyRingTestReceiver keyring_callbacks;
+  KeyRingTestSignalReceiver receiver;
+
+  // disable sgnature checking
+  keyring_callbacks.answerAcceptKey(KeyRingReport::KEY_TRUST_TEMPORARILY);
+  keyring_callbacks.answerAcceptVerFailed(true);
+  keyring_callbacks.answerAcceptUnknownKey(true);
+
+  std::vector<RepoInfo> repos;
+  for ( const char * alias : { "foo", "bar", "baz" } )
+  {
+    RepoInfo repo;
+    repo.setAlias( alias );
+    repo.setBaseUrl( (Pathname(TESTS_SRC_DIR) / "/repo/yum/data/10.2-updates-subset").asDirUrl() );
+    repos.push_back( repo );
+  }
+  RepoInfo broken;
+  broken.setAlias( "broken" );
+  broken.setBaseUrl( (Pathname(TESTS_SRC_DIR) / "/repo/yum/data/does-not-exist").asDirUrl() );
+  repos.insert( repos.begin()+1, broken );
+
+  RepoManager::RefreshReposResult result( manager.refreshRepos( repos, RepoManager::RefreshIfNeeded, RepoManager::BuildIfNeeded, 2 ) );
+  BOOST_CHECK_EQUAL( result.size(), repos.size() );
+
+  // a failing repo does not stop the others
+  BOOST_CHECK( result["broken"] );
+  BOOST_CHECK_MESSAGE( !manager.isCached(broken), "Broken repo must not be cached" );
+  for ( const char * alias : { "foo", "bar", "baz" } )
+  {
+    BOOST_CHECK_MESSAGE( !result[alias], std::string("Repo should be refreshed: ") + alias );
+    BOOST_CHECK_MESSAGE( PathInfo(opts.repoCachePath / "solv" / alias / "solv").isExist(), std::string("Solv file is created: ") + alias );
+  }
+}
+
 BOOST_AUTO_TEST_CASE(repo_seting_test)
 {
   RepoInfo repo;
@@ -1,5 +1,6 @@
 #include "TestSetup.h"
 
+#include <zypp/ExternalProgram.h>
 #include <zypp/target/rpm/RpmDb.h>
 using target::rpm::RpmDb;
 
@@ -18,6 +19,8 @@ BOOST_GLOBAL_FIXTURE( TestInit );
 //
 // - RpmDb::checkPackage (legacy) and RpmDb::checkPackageSignature are
 // expected to produce the same result, except for ...
+// - RpmDb::checkPackageSignatureCommand evaluated by checkPackageSignatureResult
+// is expected to produce the same result as RpmDb::checkPackageSignature.
 //
 // Result comparison is not very sophisticated. As the detail strings are
 // user visible (at least in zypper) we want a notification (breaking testcase)
@@ -89,6 +92,25 @@ namespace
 //     cout << res << endl;
     return res;
   }
+
+  /** RpmDb::checkPackageSignature as done by the commit preloader in a separate process. */
+  CheckResult gcheckPackageSignatureCommand( const Pathname & path_r )
+  {
+    const RpmDb & rpmDb { test.target().rpmDb() };
+    ExternalProgram prog( rpmDb.checkPackageSignatureCommand( path_r ), ExternalProgram::Stderr_To_Stdout, false, -1, /*default_locale*/true );
+    std::vector<std::string> output;
+    for ( std::string line( prog.receiveLine() ); line.length(); line = prog.receiveLine() )
+    {
+      if ( line.back() == '\n' )
+        line.pop_back();
+      output.push_back( std::move(line) );
+    }
+    int status = prog.close();
+
+    CheckResult res;
+    res.result = rpmDb.checkPackageSignatureResult( path_r, status, output, res.detail );
+    return res;
+  }
 } // namespace
 
 
@@ -97,6 +119,7 @@ BOOST_AUTO_TEST_CASE(no_pkg)
   Pathname rpm { DATADIR/"no.rpm" };
   CheckResult cp { gcheckPackage( rpm ) };
   CheckResult cs { gcheckPackageSignature( rpm ) };
+  BOOST_CHECK_EQUAL( cs, gcheckPackageSignatureCommand( rpm ) );
   BOOST_CHECK_EQUAL( cp, cs );
 
   CheckResult xpct { RpmDb::CHK_ERROR, {/*empty details*/} };
@@ -108,6 +131,7 @@ BOOST_AUTO_TEST_CASE(unsigned_pkg)
   Pathname rpm { DATADIR/"unsigned.rpm" };
   CheckResult cp { gcheckPackage( rpm ) };
   CheckResult cs { gcheckPackageSignature( rpm ) };
+  BOOST_CHECK_EQUAL( cs, gcheckPackageSignatureCommand( rpm ) );
   // For unsigned packages the final result differs!
   // (but only if the digests are OK)
   BOOST_CHECK_EQUAL( cp.result, RpmDb::CHK_OK );
@@ -129,6 +153,7 @@ BOOST_AUTO_TEST_CASE(unsigned_broken_pkg)
   Pathname rpm { DATADIR/"unsigned_broken.rpm" };
   CheckResult cp { gcheckPackage( rpm ) };
   CheckResult cs { gcheckPackageSignature( rpm ) };
+  BOOST_CHECK_EQUAL( cs, gcheckPackageSignatureCommand( rpm ) );
   // Unsigned, but a broken digest 'superseeds' CHK_NOSIG
   BOOST_CHECK_EQUAL( cp, cs );
 
@@ -146,6 +171,7 @@ BOOST_AUTO_TEST_CASE(unsigned_broken_header_pkg)
   Pathname rpm { DATADIR/"unsigned_broken_header.rpm" };
   CheckResult cp { gcheckPackage( rpm ) };
   CheckResult cs { gcheckPackageSignature( rpm ) };
+  BOOST_CHECK_EQUAL( cs, gcheckPackageSignatureCommand( rpm ) );
   // Unsigned, but a broken digest 'superseeds' CHK_NOSIG
   BOOST_CHECK_EQUAL( cp, cs );
 
@@ -163,6 +189,7 @@ BOOST_AUTO_TEST_CASE(signed_pkg_nokey)
   Pathname rpm { DATADIR/"signed.rpm" };
   CheckResult cp { gcheckPackage( rpm ) };
   CheckResult cs { gcheckPackageSignature( rpm ) };
+  BOOST_CHECK_EQUAL( cs, gcheckPackageSignatureCommand( rpm ) );
   BOOST_CHECK_EQUAL( cp, cs );
 
   CheckResult xpct { RpmDb::CHK_NOKEY, {
@@ -181,6 +208,7 @@ BOOST_AUTO_TEST_CASE(signed_broken_pkg_nokey)
   Pathname rpm { DATADIR/"signed_broken.rpm" };
   CheckResult cp { gcheckPackage( rpm ) };
   CheckResult cs { gcheckPackageSignature( rpm ) };
+  BOOST_CHECK_EQUAL( cs, gcheckPackageSignatureCommand( rpm ) );
   BOOST_CHECK_EQUAL( cp, cs );
 
   CheckResult xpct { RpmDb::CHK_FAIL, {
@@ -199,6 +227,7 @@ BOOST_AUTO_TEST_CASE(signed_broken_header_pkg_nokey)
   Pathname rpm { DATADIR/"signed_broken_header.rpm" };
   CheckResult cp { gcheckPackage( rpm ) };
   CheckResult cs { gcheckPackageSignature( rpm ) };
+  BOOST_CHECK_EQUAL( cs, gcheckPackageSignatureCommand( rpm ) );
   BOOST_CHECK_EQUAL( cp, cs );
 
   CheckResult xpct { RpmDb::CHK_FAIL, {
@@ -228,6 +257,7 @@ BOOST_AUTO_TEST_CASE(signed_pkg_withkey)
   Pathname rpm { DATADIR/"signed.rpm" };
   CheckResult cp { gcheckPackage( rpm ) };
   CheckResult cs { gcheckPackageSignature( rpm ) };
+  BOOST_CHECK_EQUAL( cs, gcheckPackageSignatureCommand( rpm ) );
   BOOST_CHECK_EQUAL( cp, cs );
 
   CheckResult xpct { RpmDb::CHK_OK, {
@@ -246,6 +276,7 @@ BOOST_AUTO_TEST_CASE(signed_broken_pkg_withkey)
   Pathname rpm { DATADIR/"signed_broken.rpm" };
   CheckResult cp { gcheckPackage( rpm ) };
   CheckResult cs { gcheckPackageSignature( rpm ) };
+  BOOST_CHECK_EQUAL( cs, gcheckPackageSignatureCommand( rpm ) );
   BOOST_CHECK_EQUAL( cp, cs );
 
   CheckResult xpct { RpmDb::CHK_FAIL, {
@@ -264,6 +295,7 @@ BOOST_AUTO_TEST_CASE(signed_broken_header_pkg_withkey)
   Pathname rpm { DATADIR/"signed_broken_header.rpm" };
   CheckResult cp { gcheckPackage( rpm ) };
   CheckResult cs { gcheckPackageSignature( rpm ) };
+  BOOST_CHECK_EQUAL( cs, gcheckPackageSignatureCommand( rpm ) );
   BOOST_CHECK_EQUAL( cp, cs );
 
   CheckResult xpct { RpmDb::CHK_FAIL, {
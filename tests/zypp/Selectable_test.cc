@@ -352,3 +352,85 @@ BOOST_AUTO_TEST_CASE(pickstatus_cycle)
 }
 
 /////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE(save_restore_state)
+{
+  ResPoolProxy poolProxy( test.poolProxy() );
+  poolProxy.saveState();
+  BOOST_CHECK( ! poolProxy.diffState() );
+
+  PoolItem pi( *poolProxy.lookup( ResKind::package, "candidate" )->availableBegin() );
+  BOOST_REQUIRE( pi );
+  BOOST_CHECK( pi.status().setTransact( true, ResStatus::USER ) );
+  BOOST_CHECK( poolProxy.diffState() );
+  BOOST_CHECK( poolProxy.diffState<Package>() );
+  BOOST_CHECK( ! poolProxy.diffState<Pattern>() );
+
+  poolProxy.restoreState();
+  BOOST_CHECK( ! pi.status().transacts() );
+  BOOST_CHECK( ! poolProxy.diffState() );
+
+  // by kind
+  poolProxy.saveState<Package>();
+  BOOST_CHECK( pi.status().setTransact( true, ResStatus::USER ) );
+  BOOST_CHECK( poolProxy.diffState<Package>() );
+  poolProxy.restoreState<Package>();
+  BOOST_CHECK( ! pi.status().transacts() );
+  BOOST_CHECK( ! poolProxy.diffState<Package>() );
+}
+
+BOOST_AUTO_TEST_CASE(incremental_update)
+{
+  // Removing or adding a repo just rebuilds the Selectables of the affected idents.
+  auto checkSelectables = []( const ResPoolProxy & proxy_r ) {
+    std::set<IdString> idents;
+    for ( const PoolItem & pi : test.pool() )
+      idents.insert( pi.satSolvable().ident() );
+    BOOST_CHECK_EQUAL( proxy_r.size(), idents.size() );
+    for ( const ui::Selectable::Ptr & sel : proxy_r )
+    {
+      BOOST_CHECK( idents.count( sel->ident() ) );
+      BOOST_CHECK_EQUAL( sel->availableSize() + sel->installedSize(),
+                         size_t(std::distance( test.pool().byIdentBegin( sel->kind(), sel->name() ), test.pool().byIdentEnd( sel->kind(), sel->name() ) )) );
+    }
+  };
+
+  ResPoolProxy poolProxy( test.poolProxy() );
+  ui::Selectable::Ptr candidate( poolProxy.lookup( ResKind::package, "candidate" ) );
+  BOOST_CHECK_EQUAL( candidate->availableSize(), 6 );
+  ui::Selectable::Ptr untouched;
+  for ( const ui::Selectable::Ptr & sel : poolProxy )
+  {
+    bool inHigh = false;
+    for ( const PoolItem & pi : sel->available() )
+      if ( pi.repoInfo().alias() == "RepoHIGH" )
+        inHigh = true;
+    if ( ! inHigh )
+    {
+      untouched = sel;
+      break;
+    }
+  }
+  BOOST_REQUIRE( untouched );
+
+  RepoInfo info( test.satpool().reposFind( "RepoHIGH" ).info() );
+  test.satpool().reposErase( "RepoHIGH" );
+  {
+    ResPoolProxy proxy( test.poolProxy() );
+    BOOST_CHECK_EQUAL( proxy.lookup( ResKind::package, "candidate" )->availableSize(), 4 );
+    BOOST_CHECK_EQUAL( proxy.lookup( untouched->kind(), untouched->name() ), untouched );
+    checkSelectables( proxy );
+  }
+
+  Repository repo( test.satpool().reposInsert( "RepoHIGH" ) );
+  repo.setInfo( info );
+  repo.addTesttags( TESTS_SRC_DIR"/data/TCSelectable/RepoHIGH.repo" );
+  {
+    ResPoolProxy proxy( test.poolProxy() );
+    ui::Selectable::Ptr sel( proxy.lookup( ResKind::package, "candidate" ) );
+    BOOST_CHECK_EQUAL( sel->availableSize(), 6 );
+    BOOST_CHECK_EQUAL( sel->available().begin()->repoInfo().alias(), "RepoHIGH" );	// highest priority 1st
+    BOOST_CHECK_EQUAL( proxy.lookup( untouched->kind(), untouched->name() ), untouched );
+    checkSelectables( proxy );
+  }
+}
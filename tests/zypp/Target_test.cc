@@ -1,6 +1,7 @@
 #include <iostream>
 #include <fstream>
 #include <list>
+#include <set>
 #include <string>
 
 // Boost.Test
@@ -12,6 +13,15 @@
 #include <zypp/ZYpp.h>
 #include <zypp/ZYppFactory.h>
 #include <zypp/TmpPath.h>
+#include <zypp/PathInfo.h>
+#include <zypp/ExternalProgram.h>
+#include <zypp/RepoManager.h>
+#include <zypp/ResPool.h>
+#include <zypp/ZYppCommitPolicy.h>
+#include <zypp/ZYppCommitResult.h>
+#include <zypp/sat/Pool.h>
+#include <zypp/sat/LookupAttr.h>
+#include <zypp/target/rpm/librpmDb.h>
 
 using boost::unit_test::test_case;
 using namespace zypp;
@@ -54,3 +64,82 @@ BOOST_AUTO_TEST_CASE(target_test)
     BOOST_CHECK_EQUAL( dlabel.summary, "A cool distribution" );
     BOOST_CHECK_EQUAL( dlabel.shortName, "" );
 }
+
+namespace
+{
+  /** All solvables of \a repo_r with their dependencies and attributes, independent of the order. */
+  std::multiset<std::string> solvDump( const Repository & repo_r )
+  {
+    std::multiset<std::string> ret;
+    for ( const sat::Solvable & solv : repo_r.solvables() )
+    {
+      str::Str str;
+      dumpOn( str.stream(), solv );
+      for_( it, sat::LookupAttr( sat::SolvAttr::allAttr, solv ).begin(), sat::LookupAttr::iterator() )
+        str << it.inSolvAttr() << " = " << it.asString() << std::endl;
+      ret.insert( str );
+    }
+    return ret;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(target_incremental_solv)
+{
+  if ( geteuid() != 0 )
+  {
+    BOOST_WARN( "Incremental solv test requires root permissions! (rpm --root)" );
+    return;
+  }
+
+  filesystem::TmpDir tmp;
+  filesystem::TmpDir plaindir;
+  BOOST_REQUIRE( copy( Pathname(TESTS_SRC_DIR) / "/zypp/data/RpmPkgSigCheck/unsigned.rpm", plaindir.path() / "unsigned.rpm" ) == 0 );
+
+  ZYpp::Ptr z = getZYpp();
+  z->initializeTarget( tmp.path() );	// the initial solv file is built by rpmdb2solv
+  z->target()->load();
+
+  RepoManager manager( RepoManagerOptions::makeTestSetup( tmp.path() / "repos" ) );
+  RepoInfo info;
+  info.setAlias( "plaindir" );
+  info.setType( repo::RepoType::RPMPLAINDIR );
+  info.setBaseUrl( Url( "dir:" + plaindir.path().asString() ) );
+  info.setGpgCheck( false );
+  manager.buildCache( info );
+  manager.loadFromCache( info );
+
+  Repository repo( sat::Pool::instance().reposFind( "plaindir" ) );
+  BOOST_REQUIRE( ! repo.solvablesEmpty() );
+  for ( const sat::Solvable & solv : repo.solvables() )
+    PoolItem( solv ).status().setToBeInstalled( ResStatus::USER );
+
+  // After the commit just the installed package is added to the solv file.
+  ZYppCommitPolicy policy;
+  policy.rpmInstFlags( policy.rpmInstFlags() | target::rpm::RPMINST_JUSTDB | target::rpm::RPMINST_NODEPS );
+  ZYppCommitResult result( z->commit( policy ) );
+  BOOST_REQUIRE( result.allDone() );
+  z->target()->buildCache();
+
+  Pathname incremental( tmp.path() / "/var/cache/zypp/solv/@System/solv" );
+  Pathname full( tmp.path() / "full.solv" );
+  {
+    ExternalProgram::Arguments cmd {
+      "rpmdb2solv",
+      "-r", tmp.path().asString(),
+      "-D", target::rpm::librpmDb::suggestedDbPath( tmp.path() ).asString(),
+      "-X",
+      "-p", ( tmp.path() / "/etc/products.d" ).asString(),
+      "-o", full.asString()
+    };
+    ExternalProgram prog( cmd, ExternalProgram::Stderr_To_Stdout );
+    for ( std::string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() )
+      std::cout << "  " << output;
+    BOOST_REQUIRE_EQUAL( prog.close(), 0 );
+  }
+
+  z->finishTarget();
+  const std::multiset<std::string> & incrementalDump( solvDump( sat::Pool::instance().addRepoSolv( incremental, "incremental" ) ) );
+  const std::multiset<std::string> & fullDump( solvDump( sat::Pool::instance().addRepoSolv( full, "full" ) ) );
+  BOOST_CHECK_EQUAL( incrementalDump.size(), fullDump.size() );
+  BOOST_CHECK( incrementalDump == fullDump );
+}
@@ -0,0 +1,197 @@
+#include <boost/test/unit_test.hpp>
+
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <atomic>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <zypp/base/Logger.h>
+#include <zypp/base/LogControl.h>
+#include <zypp/base/String.h>
+#include <zypp-core/base/LogRing_p.h>
+
+using namespace zypp;
+
+namespace
+{
+  /** Encode/decode producer and sequence number in a line. */
+  std::string mkline( unsigned producer_r, unsigned seq_r )
+  { return str::numstring( producer_r ) + " " + str::numstring( seq_r ); }
+
+  std::pair<unsigned,unsigned> parseline( const std::string & line_r )
+  {
+    std::string::size_type sep = line_r.find( ' ' );
+    return { str::strtonum<unsigned>( line_r.substr( 0, sep ) ), str::strtonum<unsigned>( line_r.substr( sep+1 ) ) };
+  }
+
+  /** Remember the written lines. */
+  struct RecordingLineWriter : public log::LineWriter
+  {
+    void writeOut( const std::string & formated_r ) override
+    {
+      std::lock_guard<std::mutex> guard( _mutex );
+      _lines.push_back( formated_r );
+    }
+
+    std::vector<std::string> lines()
+    {
+      std::lock_guard<std::mutex> guard( _mutex );
+      return _lines;
+    }
+
+    std::mutex _mutex;
+    std::vector<std::string> _lines;
+  };
+}
+
+BOOST_AUTO_TEST_CASE(logring_wraparound)
+{
+  LogRing ring;
+  std::string line;
+  BOOST_CHECK( ring.empty() );
+  BOOST_CHECK( ! ring.pop( line ) );
+
+  // Lines are taken in order, also after the positions wrapped around several times.
+  unsigned next = 0;
+  for ( unsigned i = 0; i < 3 * LogRing::capacity + 7; ++i )
+  {
+    BOOST_REQUIRE( ring.push( mkline( 0, i ) ) );
+    if ( i >= 5 )	// keep some lines pending
+    {
+      BOOST_REQUIRE( ring.pop( line ) );
+      BOOST_REQUIRE_EQUAL( line, mkline( 0, next++ ) );
+    }
+  }
+  while ( ring.pop( line ) )
+    BOOST_REQUIRE_EQUAL( line, mkline( 0, next++ ) );
+  BOOST_CHECK_EQUAL( next, 3 * LogRing::capacity + 7 );
+  BOOST_CHECK_EQUAL( ring.takeDropped(), 0U );
+
+  // A full ring drops and counts, a taken line frees a slot.
+  for ( unsigned i = 0; i < LogRing::capacity; ++i )
+    BOOST_REQUIRE( ring.push( mkline( 1, i ) ) );
+  BOOST_CHECK( ! ring.push( mkline( 1, LogRing::capacity ) ) );
+  BOOST_CHECK( ! ring.push( mkline( 1, LogRing::capacity ) ) );
+  BOOST_CHECK_EQUAL( ring.takeDropped(), 2U );
+  BOOST_CHECK_EQUAL( ring.takeDropped(), 0U );
+  BOOST_REQUIRE( ring.pop( line ) );
+  BOOST_CHECK_EQUAL( line, mkline( 1, 0 ) );
+  BOOST_CHECK( ring.push( mkline( 1, LogRing::capacity ) ) );
+  for ( unsigned i = 1; i <= LogRing::capacity; ++i )
+  {
+    BOOST_REQUIRE( ring.pop( line ) );
+    BOOST_REQUIRE_EQUAL( line, mkline( 1, i ) );
+  }
+  BOOST_CHECK( ring.empty() );
+}
+
+BOOST_AUTO_TEST_CASE(logring_multi_producer)
+{
+  static constexpr unsigned producers = 4;
+  static constexpr unsigned lines = 4 * LogRing::capacity;
+
+  LogRing ring;
+  std::vector<size_t> pushed( producers, 0 );
+  std::vector<size_t> rejected( producers, 0 );
+  std::atomic<unsigned> running { producers };
+
+  std::vector<std::thread> threads;
+  for ( unsigned p = 0; p < producers; ++p )
+  {
+    threads.emplace_back( [&,p]() {
+      for ( unsigned i = 0; i < lines; ++i )
+      {
+        if ( ring.push( mkline( p, i ) ) )
+          ++pushed[p];
+        else
+          ++rejected[p];
+      }
+      --running;
+    });
+  }
+
+  // Consume while the producers are running, lines of a producer must keep their order.
+  std::vector<long> last( producers, -1 );
+  std::vector<size_t> popped( producers, 0 );
+  size_t dropped = 0;
+  bool ordered = true;
+  std::string line;
+  while ( true )
+  {
+    const bool done = ( running == 0 );	// check before draining, so nothing is missed
+    while ( ring.pop( line ) )
+    {
+      auto [p, i] = parseline( line );
+      BOOST_REQUIRE( p < producers );
+      if ( long(i) <= last[p] )
+        ordered = false;
+      last[p] = i;
+      ++popped[p];
+    }
+    dropped += ring.takeDropped();
+    if ( done )
+      break;
+    std::this_thread::yield();
+  }
+  for ( auto & t : threads )
+    t.join();
+  BOOST_CHECK( ordered );
+
+  size_t totalRejected = 0;
+  for ( unsigned p = 0; p < producers; ++p )
+  {
+    BOOST_CHECK_EQUAL( popped[p], pushed[p] );
+    BOOST_CHECK_EQUAL( pushed[p] + rejected[p], lines );
+    totalRejected += rejected[p];
+  }
+  BOOST_CHECK_EQUAL( dropped, totalRejected );
+  BOOST_CHECK( ring.empty() );
+}
+
+BOOST_AUTO_TEST_CASE(logcontrol_fork_flush)
+{
+  static constexpr unsigned producers = 4;
+  static constexpr unsigned lines = 500;
+
+  shared_ptr<RecordingLineWriter> writer( new RecordingLineWriter );
+  base::LogControl::TmpLineWriter guard( writer );
+
+  std::vector<std::thread> threads;
+  for ( unsigned p = 0; p < producers; ++p )
+  {
+    threads.emplace_back( [p]() {
+      for ( unsigned i = 0; i < lines; ++i )
+        MIL << "LOGRING " << mkline( p, i ) << std::endl;
+    });
+  }
+  for ( auto & t : threads )
+    t.join();
+
+  // The lines pushed before we fork are written out before fork returns.
+  pid_t pid = ::fork();
+  BOOST_REQUIRE( pid >= 0 );
+  if ( pid == 0 )
+    ::_exit( 0 );
+  ::waitpid( pid, nullptr, 0 );
+
+  std::vector<long> last( producers, -1 );
+  size_t found = 0;
+  for ( const std::string & l : writer->lines() )
+  {
+    std::string::size_type pos = l.find( "LOGRING " );
+    if ( pos == std::string::npos )
+      continue;
+    auto [p, i] = parseline( l.substr( pos + 8 ) );
+    BOOST_REQUIRE( p < producers );
+    BOOST_CHECK_GT( long(i), last[p] );
+    last[p] = i;
+    ++found;
+  }
+  // the ring is large enough to hold them all
+  BOOST_CHECK_EQUAL( found, producers * lines );
+}
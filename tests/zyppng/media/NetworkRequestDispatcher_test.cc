@@ -734,3 +734,55 @@ BOOST_DATA_TEST_CASE(nwdispatcher_multipart_many_chunks_dl, bdata::make( withSSL
   }
 }
 
+
+// Many small files from the same host, limited per host streams must be honored
+// and connections are expected to be reused
+BOOST_DATA_TEST_CASE(nwdispatcher_host_streams_connection_reuse, bdata::make( withSSL ), withSSL )
+{
+  auto ev = zyppng::EventLoop::create();
+  auto disp = std::make_shared<zyppng::NetworkRequestDispatcher>();
+  disp->setMaximumStreamsPerHost( 2 );
+  BOOST_REQUIRE_EQUAL( disp->maximumStreamsPerHost(), 2 );
+
+  int running = 0;
+  int maxRunning = 0;
+  disp->sigDownloadStarted().connect( [&]( zyppng::NetworkRequestDispatcher &, zyppng::NetworkRequest & ){
+    running++;
+    maxRunning = std::max( maxRunning, running );
+  });
+  disp->sigDownloadFinished().connect( [&]( zyppng::NetworkRequestDispatcher &, zyppng::NetworkRequest & ){
+    running--;
+  });
+  disp->sigQueueFinished().connect( [&ev]( const zyppng::NetworkRequestDispatcher& ){
+    ev->quit();
+  });
+
+  WebServer web((zypp::Pathname(TESTS_SRC_DIR)/"zypp/data/Fetcher/remote-site").c_str(), 10001, withSSL );
+  BOOST_REQUIRE( web.start() );
+
+  zyppng::TransferSettings set = web.transferSettings();
+
+  std::vector<zypp::filesystem::TmpFile> targetFiles( 10 );
+  std::vector<zyppng::NetworkRequest::Ptr> reqs;
+  for ( auto &targetFile : targetFiles ) {
+    auto weburl = web.url();
+    weburl.setPathName("/file-1.txt");
+    auto req = std::make_shared<zyppng::NetworkRequest>( weburl, targetFile.path() );
+    req->transferSettings() = set;
+    reqs.push_back( req );
+    disp->enqueue( req );
+  }
+
+  disp->run();
+  if ( disp->count () ) ev->run();
+
+  for ( const auto &req : reqs )
+    BOOST_TEST_REQ_SUCCESS( req );
+
+  BOOST_REQUIRE_LE( maxRunning, 2 );
+
+  const auto &stats = disp->connectionStats();
+  BOOST_REQUIRE_EQUAL( stats.transfers, reqs.size() );
+  BOOST_REQUIRE_EQUAL( stats.newConnections + stats.reusedConnections, reqs.size() );
+  BOOST_REQUIRE_GT( stats.reusedConnections, 0 );
+}
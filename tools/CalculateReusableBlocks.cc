@@ -7,11 +7,29 @@
 #include <zypp-core/base/String.h>
 #include <iostream>
 #include <algorithm>
+#include <chrono>
 
 int main ( int argc, char *argv[] )
 {
+  bool useOld = false;
+  unsigned repeat = 1;
+  while ( argc > 1 && argv[1][0] == '-' ) {
+    const std::string opt( argv[1] );
+    if ( opt == "--old" ) {
+      useOld = true;
+    } else if ( opt == "--repeat" && argc > 2 ) {
+      repeat = std::max( zypp::str::strtonum<unsigned>( argv[2] ), 1U );
+      --argc, ++argv;
+    } else {
+      break;
+    }
+    --argc, ++argv;
+  }
+
   if ( argc < 3 ) {
-    std::cerr << "Usage: CalculateReusebleBlocks <metalinkfile> <deltafile>" << std::endl;
+    std::cerr << "Usage: CalculateReusebleBlocks [--old] [--repeat N] <metalinkfile> <deltafile>" << std::endl;
+    std::cerr << "  --old        use MediaBlockList::reuseBlocksOld" << std::endl;
+    std::cerr << "  --repeat N   scan the deltafile N times and report the best rate" << std::endl;
     return 1;
   }
 
@@ -71,10 +89,33 @@ int main ( int argc, char *argv[] )
 
   std::cout << "Blocks parsed from Metalink file: " << numBlocksBefore << std::endl;
   if ( numBlocksBefore ) {
-    zypp::AutoFILE f( fopen( "Out.test.gz", "w"));
-    if ( *f ) {
-      blocks.reuseBlocks( *f, deltaFile.asString() );
+    const zypp::ByteCount deltaSize( zypp::PathInfo( deltaFile ).size() );
+    const zypp::media::MediaBlockList origBlocks( blocks );
+    std::chrono::duration<double> best( 0 );
+
+    for ( unsigned run = 0; run < repeat; ++run ) {
+      zypp::AutoFILE f( fopen( "Out.test.gz", "w"));
+      if ( !*f ) {
+        std::cerr << "Can't open Out.test.gz for writing" << std::endl;
+        return 1;
+      }
+
+      blocks = origBlocks;
+      const auto start = std::chrono::steady_clock::now();
+      if ( useOld )
+        blocks.reuseBlocksOld( *f, deltaFile.asString() );
+      else
+        blocks.reuseBlocks( *f, deltaFile.asString() );
+      const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+      if ( run == 0 || elapsed < best )
+        best = elapsed;
     }
+
+    std::cout << "Scanned " << deltaSize << " in " << best.count() << "s";
+    if ( best.count() > 0 )
+      std::cout << " (" << zypp::ByteCount( zypp::ByteCount::SizeType( deltaSize / best.count() ) ) << "/s)";
+    std::cout << std::endl;
   }
 
   const size_t numBlocksAfter = blocks.numBlocks();
@@ -10,7 +10,10 @@
 #include <zypp-core/base/StringV.h>
 
 #include <boost/interprocess/sync/file_lock.hpp>
+#include <chrono>
+#include <condition_variable>
 #include <mutex>
+#include <thread>
 
 // we do not link against libzypp, but these are pure header only files, if that changes
 // a copy should be created directly in the zypp-rpm project
@@ -30,8 +33,10 @@ extern "C"
 
 #include <cstdio>
 #include <iostream>
+#include <fcntl.h>
 #include <signal.h>
 #include <unistd.h>
+#include <sys/resource.h>
 
 // Messages to the zypp log sent on stdout/stderr
 #define ZDBG std::cout
@@ -48,6 +53,17 @@ namespace env
     }();
     return val;
   }
+
+  /// Number of threads reading the package headers (default: number of CPUs, at most 8; limited to 1..64)
+  inline unsigned ZYPP_RPM_HEADER_THREADS()
+  {
+    static unsigned val = [](){
+      const char * env = getenv("ZYPP_RPM_HEADER_THREADS");
+      unsigned ret = env ? zypp::str::strtonum<unsigned>( env ) : std::min( std::thread::hardware_concurrency(), 8U );
+      return std::min( std::max( ret, 1U ), 64U );
+    }();
+    return val;
+  }
 } // namespace env
 
 // this is the order we expect the FDs we need to communicate to be set up
@@ -135,12 +151,14 @@ bool pushTransactionErrorMessage ( rpmps ps )
 
 
 using RpmHeader = std::shared_ptr<std::remove_pointer_t<Header>>;
-std::pair<RpmHeader, int> readPackage( rpmts ts_r, const zypp::filesystem::Pathname &path_r )
+
+/** Open \a path_r for reading the package. */
+FD_t openPackage( const zypp::filesystem::Pathname &path_r )
 {
   zypp::PathInfo file( path_r );
   if ( ! file.isFile() ) {
     ZERR << "Not a file: " << path_r << std::endl;
-    return std::make_pair( RpmHeader(), -1 );
+    return nullptr;
   }
 
   FD_t fd = ::Fopen( path_r.c_str(), "r.ufdio" );
@@ -149,12 +167,19 @@ std::pair<RpmHeader, int> readPackage( rpmts ts_r, const zypp::filesystem::Pathn
     ZERR << "Can't open file for reading: " << path_r << " (" << ::Fstrerror(fd) << ")" << std::endl;
     if ( fd )
       ::Fclose( fd );
-    return std::make_pair( RpmHeader(), -1 );
+    return nullptr;
   }
+  return fd;
+}
+
+/** Read the header from the package opened as \a fd_r. */
+std::pair<RpmHeader, int> readPackage( rpmts ts_r, FD_t fd_r, const zypp::filesystem::Pathname &path_r )
+{
+  if ( ! fd_r )
+    return std::make_pair( RpmHeader(), -1 );
 
   Header nh = 0;
-  int res = ::rpmReadPackageFile( ts_r, fd, path_r.asString().c_str(), &nh );
-  ::Fclose( fd );
+  int res = ::rpmReadPackageFile( ts_r, fd_r, path_r.asString().c_str(), &nh );
 
   if ( ! nh )
   {
@@ -166,6 +191,181 @@ std::pair<RpmHeader, int> readPackage( rpmts ts_r, const zypp::filesystem::Pathn
   return std::make_pair( h, res );
 }
 
+/**
+ * Reads the headers of the packages to install concurrently.
+ *
+ * Worker threads open the packages (and ask the kernel to read them ahead)
+ * a few steps in front of the main thread, which adds the headers to the
+ * transaction in step order. If the keyring can be shared between threads,
+ * each worker verifies and reads the header using its own transaction set,
+ * otherwise the main thread reads it from the already opened file.
+ *
+ * As long as the fd limit permits, the opened packages are handed out to be
+ * reused in the install callback instead of opening them once more.
+ */
+class HeaderPreloader
+{
+public:
+  HeaderPreloader( rpmts ts_r, const zypp::proto::target::Commit &commit_r )
+    : _commit( commit_r )
+    , _slots( commit_r.steps_size() )
+  {
+    const unsigned threads = std::min<unsigned>( env::ZYPP_RPM_HEADER_THREADS(), std::max( commit_r.steps_size(), 1 ) );
+    _window = 4 * threads;
+
+    // Keep up to half of the fds available for the install, rpm needs some too.
+    // The workers may hold up to _window packages open on top of the kept ones.
+    struct rlimit lim {};
+    if ( ::getrlimit( RLIMIT_NOFILE, &lim ) == 0 ) {
+      if ( lim.rlim_cur == RLIM_INFINITY )
+        _maxKeptFds = commit_r.steps_size();
+      else if ( lim.rlim_cur / 2 > rlim_t( _window ) + 64 )
+        _maxKeptFds = std::min<rlim_t>( lim.rlim_cur / 2 - _window, commit_r.steps_size() );
+    }
+
+#ifdef HAVE_RPM_THREADSAFE_KEYRING
+    // All transaction sets are set up here in the main thread and share the
+    // already loaded keyring of the main transaction.
+    zypp::AutoDispose<rpmKeyring> keyring( ::rpmtsGetKeyring( ts_r, 1 ), ::rpmKeyringFree );
+    for ( unsigned i = 0; i < threads; ++i ) {
+      zypp::AutoDispose<rpmts> wts( ::rpmtsCreate(), ::rpmtsFree );
+      ::rpmtsSetRootDir( wts, ::rpmtsRootDir( ts_r ) );
+      ::rpmtsSetVSFlags( wts, ::rpmtsVSFlags( ts_r ) );
+#ifdef HAVE_RPMTSSETVFYLEVEL
+      ::rpmtsSetVfyLevel( wts, ::rpmtsVfyLevel( ts_r ) );
+#endif
+      ::rpmtsSetKeyring( wts, keyring );
+      _workerTs.push_back( std::move(wts) );
+    }
+#endif
+
+    for ( unsigned i = 0; i < threads; ++i )
+      _threads.emplace_back( [this, i](){ work( i ); } );
+  }
+
+  HeaderPreloader( const HeaderPreloader & ) = delete;
+  HeaderPreloader &operator= ( const HeaderPreloader & ) = delete;
+
+  ~HeaderPreloader()
+  {
+    {
+      std::lock_guard<std::mutex> guard( _mutex );
+      _stop = true;
+    }
+    _cv.notify_all();
+    for ( auto &t : _threads )
+      t.join();
+
+    // close packages not taken (e.g. if we returned early)
+    for ( Slot &slot : _slots ) {
+      if ( slot.fd )
+        ::Fclose( slot.fd );
+    }
+  }
+
+  /** Number of threads used. */
+  unsigned threads() const
+  { return _threads.size(); }
+
+  /** Number of packages handed out to be reused in the install callback. */
+  unsigned keptFds() const
+  { return _keptFds; }
+
+  /**
+   * The header of the install step \a i_r (waits for the workers).
+   * Install steps must be taken in order. If the package may stay open, \a fd_r
+   * takes the file, positioned at the start for the install callback.
+   */
+  std::pair<RpmHeader, int> take( rpmts ts_r, int i_r, zypp::AutoDispose<FD_t> &fd_r )
+  {
+    Slot slot;
+    {
+      std::unique_lock<std::mutex> lock( _mutex );
+      _cv.wait( lock, [&](){ return _slots[i_r].done; } );
+      std::swap( slot, _slots[i_r] );
+      --_pending;
+    }
+    _cv.notify_all();
+
+    const auto &path = _commit.steps( i_r ).install().pathname();
+    if ( !slot.read )
+      std::tie( slot.header, slot.res ) = readPackage( ts_r, slot.fd, path );
+
+    if ( slot.fd ) {
+      if ( slot.header && _keptFds < _maxKeptFds && ::Fseek( slot.fd, 0, SEEK_SET ) == 0 ) {
+        fd_r = zypp::AutoDispose<FD_t>( slot.fd, ::Fclose );
+        ++_keptFds;
+      } else {
+        ::Fclose( slot.fd );
+      }
+    }
+    return std::make_pair( slot.header, slot.res );
+  }
+
+private:
+  struct Slot {
+    bool done = false;   //< the worker is done with the slot
+    bool read = false;   //< the header was read by the worker
+    FD_t fd = nullptr;
+    RpmHeader header;
+    int res = -1;
+  };
+
+  void work( unsigned id_r )
+  {
+    while ( true ) {
+      int i = 0;
+      {
+        // stay at most _window packages in front of the main thread
+        std::unique_lock<std::mutex> lock( _mutex );
+        _cv.wait( lock, [&](){ return _stop || _pending < _window; } );
+        while ( _next < _commit.steps_size() && !_commit.steps( _next ).has_install() )
+          ++_next;  // nothing to preload for removals
+        if ( _stop || _next >= _commit.steps_size() )
+          return;
+        i = _next++;
+        ++_pending;
+      }
+
+      Slot slot;
+      const zypp::Pathname path( _commit.steps( i ).install().pathname() );
+      slot.fd = openPackage( path );
+      if ( slot.fd ) {
+        // the package is read once more for the install, let the kernel start early
+        ::posix_fadvise( ::Fileno( slot.fd ), 0, 0, POSIX_FADV_WILLNEED );
+#ifdef HAVE_RPM_THREADSAFE_KEYRING
+        std::tie( slot.header, slot.res ) = readPackage( _workerTs[id_r], slot.fd, path );
+        slot.read = true;
+#endif
+      }
+      slot.done = true;
+
+      {
+        std::lock_guard<std::mutex> guard( _mutex );
+        _slots[i] = std::move(slot);
+      }
+      _cv.notify_all();
+    }
+  }
+
+private:
+  const zypp::proto::target::Commit &_commit;
+  std::vector<Slot> _slots;
+  std::vector<zypp::AutoDispose<rpmts>> _workerTs;
+  std::vector<std::thread> _threads;
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  int _next = 0;              //< next step for a worker
+  int _pending = 0;           //< packages preloaded but not yet taken
+  int _window = 0;
+  bool _stop = false;
+  unsigned _keptFds = 0;
+  unsigned _maxKeptFds = 0;
+};
+
+/** Milliseconds since \a start_r. */
+inline uint64_t msSince( std::chrono::steady_clock::time_point start_r )
+{ return std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now() - start_r ).count(); }
 
 struct TransactionData {
   zypp::proto::target::Commit &commitData;
@@ -175,6 +375,9 @@ struct TransactionData {
 
   // the fd used by rpm to dump script output
   zypp::AutoDispose<FD_t> rpmFd = {};
+
+  // packages opened while reading the header, to be reused by the install callback
+  std::unordered_map<const zypp::proto::target::TransactionStep *, zypp::AutoDispose<FD_t>> keptFds = {};
 };
 
 int main( int, char ** )
@@ -335,13 +538,23 @@ int main( int, char ** )
   // do we care about knowing the public key?
   const bool allowUntrusted = ( rpmInstFlags & RpmInstFlag::RPMINST_ALLOWUNTRUSTED );
 
+  // report where the time went, whenever we leave
+  zypp::proto::target::TransactionTiming timing;
+  zypp::OnScopeExit sendTiming( [&timing](){ pushMessage( timing ); } );
+
+  auto phaseStart = std::chrono::steady_clock::now();
+  std::optional<HeaderPreloader> preloader;
+  preloader.emplace( ts, msg );
+  timing.set_headerthreads( preloader->threads() );
+
   for ( int i = 0; i < msg.steps_size(); i++ ) {
     const auto &step = msg.steps(i);
 
     if ( step.has_install() ) {
 
       const auto &file = step.install().pathname();
-      auto rpmHeader = readPackage( ts, step.install().pathname() );
+      zypp::AutoDispose<FD_t> fd;
+      auto rpmHeader = preloader->take( ts, i, fd );
 
       switch(rpmHeader.second) {
         case RPMRC_OK:
@@ -380,6 +593,9 @@ int main( int, char ** )
         return FailedToAddStepToTransaction;
       }
 
+      if ( fd.value() )
+        data.keptFds.emplace( &step, std::move(fd) );
+
     } else if ( step.has_remove() ) {
 
       const auto &remove = step.remove();
@@ -419,6 +635,10 @@ int main( int, char ** )
 
   }
 
+  timing.set_keptfds( preloader->keptFds() );
+  preloader.reset();
+  timing.set_readheaders( msSince( phaseStart ) );
+
   // set the callback function for progress reporting and things
   ::rpmtsSetNotifyCallback( ts, rpmLibCallback, &data );
 
@@ -457,7 +677,10 @@ int main( int, char ** )
 
   // handle --nodeps
   if ( !( msg.flags() & RpmInstFlag::RPMINST_NODEPS) ) {
-    if ( ::rpmtsCheck(ts) ) {
+    phaseStart = std::chrono::steady_clock::now();
+    const auto checkRes = ::rpmtsCheck(ts);
+    timing.set_check( msSince( phaseStart ) );
+    if ( checkRes ) {
       zypp::AutoDispose<rpmps> ps( ::rpmtsProblems(ts), ::rpmpsFree );
       pushTransactionErrorMessage( ps );
 
@@ -496,7 +719,9 @@ int main( int, char ** )
   if ( msg.flags() & RpmInstFlag::RPMINST_IGNORESIZE )
     tsProbFilterFlags |= RPMPROB_FILTER_DISKSPACE | RPMPROB_FILTER_DISKNODES;
 
+  phaseStart = std::chrono::steady_clock::now();
   const auto orderRes = rpmtsOrder( ts );
+  timing.set_order( msSince( phaseStart ) );
   if ( orderRes ) {
     ZERR << zypp::str::Format( "Failed with error %1% while ordering transaction." )% orderRes << std::endl;
     return RpmOrderFailed;
@@ -509,7 +734,9 @@ int main( int, char ** )
   // the way how libRPM works is that it will try to install all packages even if some of them fail
   // we need to go over the rpm problem set to mark those steps that have failed, we get no other hint on wether
   // it worked or not
+  phaseStart = std::chrono::steady_clock::now();
   const auto transRes = ::rpmtsRun( ts, nullptr, tsProbFilterFlags );
+  timing.set_run( msSince( phaseStart ) );
   //data.finishCurrentStep( );
 
   if ( transRes != 0 ) {
@@ -610,7 +837,13 @@ void *rpmLibCallback( const void *h, const rpmCallbackType what, const rpm_loff_
         return NULL;
       if ( fd != NULL )
         ZERR << "ERR opening a file before closing the old one?  Really ? " << std::endl;
-      fd = Fopen( iStep->install().pathname().data(), "r.ufdio" );
+      if ( auto kept = that->keptFds.find( iStep ); kept != that->keptFds.end() ) {
+        // still open from reading the header
+        fd = kept->second;
+        kept->second.resetDispose();
+        that->keptFds.erase( kept );
+      } else
+        fd = Fopen( iStep->install().pathname().data(), "r.ufdio" );
       if (fd == NULL || Ferror(fd)) {
         ZERR << "Error when opening file " << iStep->install().pathname().data() << std::endl;
         if (fd != NULL) {
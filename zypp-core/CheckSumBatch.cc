@@ -0,0 +1,199 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp-core/CheckSumBatch.cc
+ *
+*/
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#include <zypp-core/base/Logger.h>
+#include <zypp-core/base/Errno.h>
+#include <zypp-core/AutoDispose.h>
+#include <zypp-core/Digest.h>
+#include <zypp-core/CheckSumBatch.h>
+
+#undef  ZYPP_BASE_LOGGER_LOGGROUP
+#define ZYPP_BASE_LOGGER_LOGGROUP "zypp::checksum"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace
+  {
+    constexpr size_t chunkSize   = 4 * 1024 * 1024;	///< bytes passed to Digest::update at once
+    constexpr size_t bufferSize  = 1024 * 1024;		///< read(2) buffer if mmap is not possible
+    constexpr size_t bufferAlign = 4096;
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class Hasher
+    /// \brief Per thread state: a \ref Digest and a lazily allocated read buffer.
+    ///////////////////////////////////////////////////////////////////
+    class Hasher
+    {
+    public:
+      CheckSum compute( const Pathname & file_r, const std::string & type_r )
+      {
+        if ( type_r.empty() )
+          return CheckSum();
+
+        if ( _digest.name() != type_r ? ! _digest.create( type_r ) : ! _digest.reset() )
+        {
+          WAR << "Unsupported checksum type '" << type_r << "'" << endl;
+          return CheckSum();
+        }
+
+        AutoFD fd { ::open( file_r.c_str(), O_RDONLY | O_CLOEXEC ) };
+        if ( fd == -1 )
+        {
+          DBG << "Can't open " << file_r << ": " << Errno() << endl;
+          return CheckSum();
+        }
+
+        struct stat st;
+        if ( ::fstat( fd, &st ) != 0 )
+          return CheckSum();
+
+        if ( ! ( S_ISREG(st.st_mode) && st.st_size > 0 && hashMapped( fd, st.st_size ) ) )
+        {
+          if ( ! hashRead( fd ) )
+          {
+            DBG << "Can't read " << file_r << ": " << Errno() << endl;
+            return CheckSum();
+          }
+        }
+
+        std::string sum { _digest.digest() };
+        if ( sum.empty() )
+          return CheckSum();
+        return CheckSum( type_r, sum );
+      }
+
+    private:
+      /** Hash the whole file via \c mmap. \c false if the file can't be mapped. */
+      bool hashMapped( int fd_r, off_t size_r )
+      {
+        void * addr = ::mmap( nullptr, size_r, PROT_READ, MAP_PRIVATE, fd_r, 0 );
+        if ( addr == MAP_FAILED )
+          return false;
+        ::madvise( addr, size_r, MADV_SEQUENTIAL );
+
+        const char * data = static_cast<const char *>( addr );
+        bool ok = true;
+        for ( off_t done = 0; ok && done < size_r; done += chunkSize )
+          ok = _digest.update( data + done, std::min<off_t>( chunkSize, size_r - done ) );
+
+        ::munmap( addr, size_r );
+        return ok;
+      }
+
+      /** Hash the remaining file content via \c read. */
+      bool hashRead( int fd_r )
+      {
+        if ( ! _buffer )
+        {
+          void * buf = nullptr;
+          if ( ::posix_memalign( &buf, bufferAlign, bufferSize ) != 0 )
+            return false;
+          _buffer.reset( static_cast<char *>( buf ) );
+        }
+        ::posix_fadvise( fd_r, 0, 0, POSIX_FADV_SEQUENTIAL );
+
+        while ( true )
+        {
+          ssize_t got = ::read( fd_r, _buffer.get(), bufferSize );
+          if ( got == 0 )
+            return true;
+          if ( got < 0 )
+          {
+            if ( errno == EINTR )
+              continue;
+            return false;
+          }
+          if ( ! _digest.update( _buffer.get(), got ) )
+            return false;
+        }
+      }
+
+    private:
+      struct FreeBuffer
+      { void operator()( char * ptr_r ) const { ::free( ptr_r ); } };
+
+      Digest _digest;
+      std::unique_ptr<char, FreeBuffer> _buffer;
+    };
+
+  } // namespace
+  ///////////////////////////////////////////////////////////////////
+
+  std::vector<CheckSumBatch::Result> CheckSumBatch::verify( const std::vector<Item> & items_r, unsigned parallel_r )
+  {
+    std::vector<Result> ret( items_r.size() );
+    if ( items_r.empty() )
+      return ret;
+
+    // Initialize the crypto library in this thread, before the workers use it.
+    Digest().create( Digest::md5() );
+
+    if ( parallel_r == 0 )
+      parallel_r = std::max( std::thread::hardware_concurrency(), 1U );
+    parallel_r = std::min<size_t>( parallel_r, items_r.size() );
+
+    std::atomic<size_t> next { 0 };
+    auto worker = [&]() {
+      Hasher hasher;
+      for ( size_t idx = next++; idx < items_r.size(); idx = next++ )
+      {
+        const Item & item { items_r[idx] };
+        Result & res { ret[idx] };
+        res.file     = item.file;
+        res.expected = item.checksum;
+        res.computed = hasher.compute( item.file, item.checksum.type() );
+      }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve( parallel_r - 1 );
+    for ( unsigned i = 1; i < parallel_r; ++i )
+      threads.emplace_back( worker );
+    worker();	// this thread takes part as well
+    for ( std::thread & t : threads )
+      t.join();
+
+    DBG << "Verified " << ret.size() << " files using " << parallel_r << " threads ("
+        << std::count_if( ret.begin(), ret.end(), []( const Result & res_r ) { return ! res_r.ok(); } ) << " failed)" << endl;
+    return ret;
+  }
+
+  CheckSum CheckSumBatch::compute( const Pathname & file_r, const std::string & type_r )
+  { return Hasher().compute( file_r, type_r ); }
+
+  std::ostream & operator<<( std::ostream & str, const CheckSumBatch::Result & obj )
+  {
+    str << obj.file << " " << ( obj.ok() ? "OK" : "FAILED" ) << " (expected " << obj.expected;
+    if ( ! obj.ok() )
+      str << ", got " << obj.computed;
+    return str << ")";
+  }
+
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
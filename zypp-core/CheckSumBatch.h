@@ -0,0 +1,118 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp-core/CheckSumBatch.h
+ *
+*/
+#ifndef ZYPP_CORE_CHECKSUMBATCH_H
+#define ZYPP_CORE_CHECKSUMBATCH_H
+
+#include <iosfwd>
+#include <vector>
+
+#include <zypp-core/CheckSum.h>
+#include <zypp-core/Pathname.h>
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  /// \class CheckSumBatch
+  /// \brief Verify the \ref CheckSum of many files concurrently.
+  ///
+  /// Collect the files and their expected checksums via \ref add and
+  /// call \ref verify. The files are distributed across a pool of
+  /// threads, each one using its own \ref Digest. Regular files are
+  /// hashed via a read only \c mmap; if this is not possible, the file
+  /// is read in large aligned chunks.
+  ///
+  /// \code
+  ///   CheckSumBatch batch;
+  ///   for ( const auto & el : files )
+  ///     batch.add( el.path, el.checksum );
+  ///   for ( const CheckSumBatch::Result & res : batch.verify() )
+  ///     if ( ! res.ok() )
+  ///       WAR << res << endl;
+  /// \endcode
+  ///////////////////////////////////////////////////////////////////
+  class CheckSumBatch
+  {
+  public:
+    /** A file and the checksum it is expected to have. */
+    struct Item
+    {
+      Pathname file;
+      CheckSum checksum;
+    };
+
+    /** The outcome of verifying one \ref Item. */
+    struct Result
+    {
+      Pathname file;
+      CheckSum expected;
+      CheckSum computed;	///< Empty if the file could not be read or the checksum type is not supported.
+
+      /** Whether the file exists and matches the expected (non empty) checksum. */
+      bool ok() const
+      { return ! expected.empty() && computed == expected; }
+    };
+
+  public:
+    /** Ctor. Use at most \a parallel_r threads, \c 0 meaning one per CPU. */
+    CheckSumBatch( unsigned parallel_r = 0 )
+    : _parallel { parallel_r }
+    {}
+
+  public:
+    /** Add \a file_r expected to have \a checksum_r. */
+    void add( Pathname file_r, CheckSum checksum_r )
+    { _items.push_back( Item { std::move(file_r), std::move(checksum_r) } ); }
+
+    /** Number of files to verify. */
+    size_t size() const
+    { return _items.size(); }
+
+    /** Whether there are no files to verify. */
+    bool empty() const
+    { return _items.empty(); }
+
+    /** Forget all files. */
+    void clear()
+    { _items.clear(); }
+
+    /** Verify all files.
+     * \returns One \ref Result per added file, in the order they were added.
+     */
+    std::vector<Result> verify() const
+    { return verify( _items, _parallel ); }
+
+  public:
+    /** Verify \a items_r using at most \a parallel_r threads (\c 0 meaning one per CPU).
+     * \returns One \ref Result per item, in the same order.
+     */
+    static std::vector<Result> verify( const std::vector<Item> & items_r, unsigned parallel_r = 0 );
+
+    /** Compute the \a type_r checksum of \a file_r using \c mmap or large aligned reads.
+     * This is what \ref verify does per file; it returns the same as
+     * <tt>CheckSum( type_r, std::ifstream( file_r.c_str() ) )</tt>.
+     * \returns An empty \ref CheckSum if the file could not be read or \a type_r is not supported.
+     */
+    static CheckSum compute( const Pathname & file_r, const std::string & type_r );
+
+  private:
+    std::vector<Item> _items;
+    unsigned _parallel;
+  };
+  ///////////////////////////////////////////////////////////////////
+
+  /** \relates CheckSumBatch::Result Stream output */
+  std::ostream & operator<<( std::ostream & str, const CheckSumBatch::Result & obj );
+
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_CORE_CHECKSUMBATCH_H
@@ -14,9 +14,11 @@
 #include <zypp-core/Pathname.h>
 #include <zypp-core/base/Gettext.h>
 #include <zypp-core/base/String.h>
-#include <zypp-core/base/Regex.h>
+#include <atomic>
 #include <stdexcept>
 #include <iostream>
+#include <string_view>
+#include <unordered_map>
 #include <utility>
 
 
@@ -31,12 +33,10 @@ namespace zypp
   // -----------------------------------------------------------------
   /*
    * url       = [scheme:] [//authority] /path [?query] [#fragment]
+   *
+   * Split as by the regex
+   *   "^([^:/?#]+:|)(//[^/?#]*|)([^?#]*)([?][^#]*|)(#.*|)"
    */
-  #define RX_SPLIT_URL                       "^([^:/?#]+:|)" \
-                                             "(//[^/?#]*|)"  \
-                                             "([^?#]*)"        \
-                                             "([?][^#]*|)"   \
-                                             "(#.*|)"
 
 
   ////////////////////////////////////////////////////////////////////
@@ -277,6 +277,97 @@ namespace zypp
       return _v;
     }
 
+    /** Changed whenever a scheme is registered (invalidates the \ref ParsedUrlCache). */
+    std::atomic<unsigned> g_urlSchemeGeneration { 0 };
+
+
+    // ---------------------------------------------------------------
+    /** The components of an encoded Url (views into the string). */
+    struct UrlComponents
+    {
+      std::string_view scheme;
+      std::string_view authority;
+      std::string_view pathdata;
+      std::string_view querystr;
+      std::string_view fragment;
+    };
+
+    UrlComponents splitUrl( std::string_view url_r )
+    {
+      static constexpr auto npos = std::string_view::npos;
+      UrlComponents ret;
+
+      // "^([^:/?#]+:|)"
+      std::string_view::size_type pos = url_r.find_first_of( ":/?#" );
+      if ( pos != npos && pos > 0 && url_r[pos] == ':' )
+      {
+        ret.scheme = url_r.substr( 0, pos );
+        url_r.remove_prefix( pos+1 );
+      }
+      // "(//[^/?#]*|)"
+      if ( url_r.size() >= 2 && url_r[0] == '/' && url_r[1] == '/' )
+      {
+        pos = url_r.find_first_of( "/?#", 2 );
+        ret.authority = url_r.substr( 2, pos == npos ? npos : pos-2 );
+        url_r.remove_prefix( pos == npos ? url_r.size() : pos );
+      }
+      // "([^?#]*)"
+      pos = url_r.find_first_of( "?#" );
+      ret.pathdata = url_r.substr( 0, pos );
+      url_r.remove_prefix( pos == npos ? url_r.size() : pos );
+      // "([?][^#]*|)" (a lone '?' was never stripped)
+      if ( ! url_r.empty() && url_r[0] == '?' )
+      {
+        pos = url_r.find( '#' );
+        ret.querystr = url_r.substr( 0, pos );
+        if ( ret.querystr.size() > 1 )
+          ret.querystr.remove_prefix( 1 );
+        url_r.remove_prefix( pos == npos ? url_r.size() : pos );
+      }
+      // "(#.*|)" (a lone '#' was never stripped)
+      if ( ! url_r.empty() )
+      {
+        ret.fragment = url_r;
+        if ( ret.fragment.size() > 1 )
+          ret.fragment.remove_prefix( 1 );
+      }
+      return ret;
+    }
+
+
+    // ---------------------------------------------------------------
+    /** Recently parsed Urls per thread.
+     * Parsing the same strings again and again is common (baseUrls, mirrors, ...).
+     * A Url shares the cached \ref UrlBase until it is modified (COW).
+     */
+    struct ParsedUrlCache
+    {
+      static constexpr std::size_t maxSize = 256;
+
+      UrlRef get( const std::string & encodedUrl_r )
+      {
+        unsigned generation = g_urlSchemeGeneration;
+        if ( generation != _generation )
+        {
+          _urls.clear();
+          _generation = generation;
+        }
+        auto it = _urls.find( encodedUrl_r );
+        return it != _urls.end() ? it->second : UrlRef( nullptr );
+      }
+
+      void put( const std::string & encodedUrl_r, const UrlRef & url_r )
+      {
+        if ( _urls.size() >= maxSize )
+          _urls.clear();
+        _urls.emplace( encodedUrl_r, url_r );
+      }
+
+    private:
+      unsigned _generation = 0;
+      std::unordered_map<std::string, UrlRef> _urls;
+    };
+
     //////////////////////////////////////////////////////////////////
   } // anonymous namespace
   ////////////////////////////////////////////////////////////////////
@@ -365,6 +456,7 @@ namespace zypp
   Url::registerScheme(const std::string &scheme,
                       UrlRef            urlImpl)
   {
+    ++g_urlSchemeGeneration;
     return g_urlSchemeRepository().addUrlByScheme(scheme, std::move(urlImpl));
   }
 
@@ -374,41 +466,23 @@ namespace zypp
   UrlRef
   Url::parseUrl(const std::string &encodedUrl)
   {
-    UrlRef      url;
-    str::smatch out;
-    bool        ret = false;
+    thread_local ParsedUrlCache cache;
+    UrlRef url( cache.get(encodedUrl));
+    if( url)
+      return url;
 
-    try
-    {
-      str::regex  rex(RX_SPLIT_URL);
-      ret = str::regex_match(encodedUrl, out, rex);
-    }
-    catch( ... )
-    {}
+    UrlComponents out( splitUrl(encodedUrl));
 
-    if(ret && out.size() == 6)
+    std::string scheme( out.scheme);
+    url = g_urlSchemeRepository().getUrlByScheme(scheme);
+    if( !url)
     {
-      std::string scheme = out[1];
-      if (scheme.size() > 1)
-        scheme = scheme.substr(0, scheme.size()-1);
-      std::string authority = out[2];
-      if (authority.size() >= 2)
-        authority = authority.substr(2);
-      std::string query = out[4];
-      if (query.size() > 1)
-        query = query.substr(1);
-      std::string fragment = out[5];
-      if (fragment.size() > 1)
-        fragment = fragment.substr(1);
-
-      url = g_urlSchemeRepository().getUrlByScheme(scheme);
-      if( !url)
-      {
-        url.reset( new UrlBase());
-      }
-      url->init(scheme, authority, out[3],
-                query, fragment);
+      url.reset( new UrlBase());
     }
+    url->init(scheme, std::string(out.authority), std::string(out.pathdata),
+              std::string(out.querystr), std::string(out.fragment));
+
+    cache.put(encodedUrl, url);
     return url;
   }
 
@@ -22,21 +22,17 @@
 #include <zypp-core/Date.h>
 #include <zypp-core/TriBool.h>
 #include <zypp-core/AutoDispose.h>
+#include <zypp-core/base/LogRing_p.h>
 
 #include <utility>
-#include <zypp-core/zyppng/io/Socket>
-#include <zypp-core/zyppng/io/SockAddr>
-#include <zypp-core/zyppng/base/EventLoop>
-#include <zypp-core/zyppng/base/EventDispatcher>
-#include <zypp-core/zyppng/base/Timer>
 #include <zypp-core/zyppng/base/private/linuxhelpers_p.h>
 #include <zypp-core/zyppng/thread/Wakeup>
 #include <zypp-core/zyppng/base/private/threaddata_p.h>
-#include <zypp-core/zyppng/base/SocketNotifier>
 
 #include <thread>
 #include <variant>
 #include <atomic>
+#include <optional>
 #include <csignal>
 
 extern "C"
@@ -46,6 +42,7 @@ extern "C"
 #include <fcntl.h>
 #include <unistd.h>
 #include <dirent.h>
+#include <poll.h>
 }
 
 using std::endl;
@@ -80,6 +77,11 @@ namespace zypp
     std::atomic_flag _atomicLock = ATOMIC_FLAG_INIT;
   };
 
+  /*!
+   * \internal The thread writing the log. Other threads push their formatted lines
+   * into a \ref LogRing and return immediately. The log thread wakes up if lines
+   * are pending and writes them out to the \ref log::LineWriter in batches.
+   */
   class LogThread
   {
 
@@ -89,13 +91,24 @@ namespace zypp
     LogThread &operator=(const LogThread &) = delete;
     LogThread &operator=(LogThread &&) = delete;
 
-    ~LogThread() { stop(); }
+    ~LogThread() {
+      stop();
+      _created.store( false, std::memory_order_release );
+    }
 
     static LogThread &instance () {
       static LogThread t;
       return t;
     }
 
+    /*!
+     * The log thread if it is already running, otherwise \c nullptr.
+     * Unlike \ref instance, this never starts the thread.
+     */
+    static LogThread *existingInstance () {
+      return _created.load( std::memory_order_acquire ) ? &instance() : nullptr;
+    }
+
     void setLineWriter ( boost::shared_ptr<log::LineWriter> writer ) {
       std::lock_guard lk( _lineWriterLock );
       _lineWriter = std::move(writer);
@@ -108,8 +121,9 @@ namespace zypp
     }
 
     void stop () {
-      _stopSignal.notify();
-      if ( _thread.get_id() != std::this_thread::get_id() )
+      _stop.store( true, std::memory_order_release );
+      _wakeup.notify();
+      if ( _thread.joinable() && _thread.get_id() != std::this_thread::get_id() )
         _thread.join();
     }
 
@@ -117,9 +131,34 @@ namespace zypp
       return _thread.get_id();
     }
 
-    static std::string sockPath () {
-      static std::string path = zypp::str::Format("zypp-logsocket-%1%") % getpid();
-      return path;
+    /*!
+     * Queue a line for the log thread. Once the thread is stopped,
+     * lines are written out synchronously.
+     */
+    void pushMessage ( std::string &&msg ) {
+      if ( _stop.load( std::memory_order_acquire ) ) {
+        std::lock_guard lk( _flushLock );
+        writeOut( std::move(msg) );
+        return;
+      }
+
+      if ( !_ring.push( std::move(msg) ) )
+        return;
+
+      // Only pay for the syscall if the log thread is waiting for work.
+      // The fence pairs with the one in workerMain: either we see the flag,
+      // or the log thread sees our line (store->load needs seq_cst ordering).
+      std::atomic_thread_fence( std::memory_order_seq_cst );
+      if ( _sleeping.load( std::memory_order_relaxed ) && _sleeping.exchange( false, std::memory_order_seq_cst ) )
+        _wakeup.notify();
+    }
+
+    /*!
+     * Synchronously write out all pending lines, e.g. before we fork.
+     */
+    void flush () {
+      std::lock_guard lk( _flushLock );
+      writeOut();
     }
 
   private:
@@ -131,6 +170,23 @@ namespace zypp
       _thread = std::thread( [this] () {
         workerMain();
       });
+      _created.store( true, std::memory_order_release );
+    }
+
+    /*!
+     * Write out \a msg after all pending lines. Requires \ref _flushLock.
+     */
+    void writeOut ( std::optional<std::string> msg = std::nullopt ) {
+      auto writer = getLineWriter();
+      std::string line;
+      while ( _ring.pop( line ) ) {
+        if ( writer )
+          writer->writeOut( line );
+      }
+      if ( size_t dropped = _ring.takeDropped(); dropped && writer )
+        writer->writeOut( str::form( "---<%zu LOGLINES DROPPED, LOG BUFFER FULL>---", dropped ) );
+      if ( msg && writer )
+        writer->writeOut( *msg );
     }
 
     void workerMain () {
@@ -140,72 +196,40 @@ namespace zypp
 
       zyppng::ThreadData::current().setName("Zypp-Log");
 
-      auto ev = zyppng::EventLoop::create();
-      auto server = zyppng::Socket::create( AF_UNIX, SOCK_STREAM, 0 );
-      auto stopNotifyWatch = _stopSignal.makeNotifier( );
-
-      std::vector<zyppng::Socket::Ptr> clients;
-
-      // bind to a abstract unix domain socket address, which means we do not need to care about cleaning it up
-      server->bind( std::make_shared<zyppng::UnixSockAddr>( sockPath(), true ) );
-      server->listen();
-
-      // wait for incoming connections from other threads
-      server->connectFunc( &zyppng::Socket::sigIncomingConnection, [&](){
-
-        auto cl = server->accept();
-        if ( !cl ) return;
-        clients.push_back( cl );
-
-        // wait until data is available, we operate line by line so we only
-        // log a string once we encounter \n
-        cl->connectFunc( &zyppng::Socket::sigReadyRead, [ this, sock = cl.get() ](){
-          auto writer = getLineWriter();
-          if ( !writer ) return;
-          while ( sock->canReadLine() ) {
-            auto br = sock->readLine();
-            writer->writeOut( std::string( br.data(), br.size() - 1 ) );
-          }
-        }, *cl);
-
-        // once a client disconnects we remove it from the std::vector so that the socket is not leaked
-        cl->connectFunc( &zyppng::Socket::sigDisconnected, [&clients, sock = std::weak_ptr(cl)](){
-          auto lock = sock.lock();
-          if ( !lock  )
-            return;
-
-          auto idx = std::find_if( clients.begin(), clients.end(), [lock]( const auto &s ){ return lock.get() == s.get(); } );
-          clients.erase( idx );
-        });
-
-      });
-
-      stopNotifyWatch->connectFunc( &zyppng::SocketNotifier::sigActivated, [&ev]( const auto &, auto ) {
-        ev->quit();
-      });
-
-      ev->run();
-
-      // make sure we have written everything
-      auto writer = getLineWriter();
-      if ( writer ) {
-        for ( auto &sock : clients ){
-          auto br = sock->readLine();
-          while ( !br.empty() ) {
-            if ( br.back () == '\n' )
-              writer->writeOut( std::string( br.data(), br.size() - 1 ) );
-            else
-              writer->writeOut( std::string( br.data(), br.size() ) );
-
-            br = sock->readLine();
+      while ( true ) {
+        const bool stopping = _stop.load( std::memory_order_acquire );
+        {
+          std::lock_guard lk( _flushLock );
+          writeOut();
+          if ( stopping )
+            break;	// we have written everything
+
+          // announce we are going to sleep, then check again to not miss a line
+          // pushed before a producer could see the flag.
+          _sleeping.store( true, std::memory_order_seq_cst );
+          std::atomic_thread_fence( std::memory_order_seq_cst );
+          if ( !_ring.empty() ) {
+            _sleeping.store( false, std::memory_order_relaxed );
+            continue;
           }
         }
+
+        pollfd pfd { _wakeup.pollfd(), POLLIN, 0 };
+        zyppng::eintrSafeCall( ::poll, &pfd, 1, -1 );
+        _wakeup.ack();
+        _sleeping.store( false, std::memory_order_release );
       }
     }
 
   private:
     std::thread _thread;
-    zyppng::Wakeup _stopSignal;
+    zyppng::Wakeup _wakeup;
+    std::atomic<bool> _stop { false };
+    std::atomic<bool> _sleeping { false };
+    static inline std::atomic<bool> _created { false };	///< whether \ref instance was constructed
+
+    LogRing _ring;
+    std::mutex _flushLock;	///< serializes the consumers of \ref _ring (log thread and \ref flush)
 
     // since the public API uses boost::shared_ptr we can not use the atomic
     // functionalities provided in std.
@@ -228,23 +252,7 @@ namespace zypp
     LogClient &operator=(const LogClient &) = delete;
     LogClient &operator=(LogClient &&) = delete;
 
-    ~LogClient() { ::close(_sockFD); }
-
-    /*!
-     * Tries to connect to the log threads socket, returns true on success or
-     * if the socket is already connected
-     */
-    bool ensureConnection () {
-      if ( _sockFD >= 0 )
-        return true;
-
-      _sockFD = ::socket( AF_UNIX, SOCK_STREAM, 0 );
-      if ( _sockFD == -1 )
-        return false;
-
-      zyppng::UnixSockAddr addr( LogThread::sockPath(), true );
-      return zyppng::trySocketConnection( _sockFD, addr, 100 );
-    }
+    ~LogClient() = default;
 
     /*!
      * Sends a message to the log thread.
@@ -260,7 +268,7 @@ namespace zypp
       });
       inPushMessage = true;
 
-      // if we are in the same thread as the Log worker we can directly push our messages out, no need to use the socket
+      // if we are in the same thread as the Log worker we can directly push our messages out, no need to use the ring
       if ( std::this_thread::get_id() == LogThread::instance().threadId() ) {
         auto writer = LogThread::instance().getLineWriter();
         if ( writer )
@@ -268,27 +276,13 @@ namespace zypp
         return;
       }
 
-      if(!ensureConnection())
-        return;
-
-      if ( msg.back() != '\n' )
-        msg.push_back('\n');
+      if ( !msg.empty() && msg.back() == '\n' )
+        msg.pop_back();
 
-      size_t written = 0;
-      while ( written < msg.size() ) {
-        const auto res = zyppng::eintrSafeCall( ::send, _sockFD, msg.data() + written, msg.size() - written, MSG_NOSIGNAL );
-        if ( res == -1 ) {
-          //assume broken socket
-          ::close( _sockFD );
-          _sockFD = -1;
-          return;
-        }
-        written += res;
-      }
+      LogThread::instance().pushMessage( std::move(msg) );
     }
 
     private:
-      int _sockFD = -1;
       bool inPushMessage = false;
   };
 
@@ -690,7 +684,6 @@ namespace zypp
         using StreamTable = std::map<std::string, StreamSet>;
         /** one streambuffer per group and level */
         StreamTable _streamtable;
-        zyppng::Socket::Ptr _sock;
 
       private:
 
@@ -715,8 +708,12 @@ namespace zypp
           logControlValidFlag() = 1;
           std::call_once( flagReadEnvAutomatically, &LogControlImpl::readEnvVars, this);
 
-          // make sure the LogControl is invalidated when we fork
-          pthread_atfork( nullptr, nullptr, &LogControl::notifyFork );
+          // make sure pending lines are written before and the LogControl is invalidated after we fork
+          pthread_atfork( [](){
+            // don't start the log thread right before we fork
+            if ( LogThread *t = LogThread::existingInstance() )
+              t->flush();
+          }, nullptr, &LogControl::notifyFork );
         }
 
       public:
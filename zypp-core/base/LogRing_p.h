@@ -0,0 +1,117 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/base/LogRing_p.h
+ * This file contains private API, it will change without notice.
+ * You have been warned.
+*/
+#ifndef ZYPP_CORE_BASE_LOGRING_P_H
+#define ZYPP_CORE_BASE_LOGRING_P_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace zypp
+{
+
+  /*!
+   * \internal Bounded lock-free multi-producer queue of log lines, drained by a
+   * single consumer. Producers never block: if the ring is full, the line is
+   * dropped and counted. Each slot carries a sequence number telling whether it
+   * is free for the producer or filled for the consumer (bounded MPMC queue as
+   * described by D. Vyukov, reduced to a single consumer).
+   */
+  class LogRing
+  {
+  public:
+    static constexpr size_t capacity = 16384;	///< Max. number of pending lines (power of 2)
+
+    LogRing()
+    : _slots( new Slot[capacity] )
+    {
+      for ( size_t i = 0; i < capacity; ++i )
+        _slots[i]._seq.store( i, std::memory_order_relaxed );
+    }
+
+    LogRing(const LogRing &) = delete;
+    LogRing(LogRing &&) = delete;
+    LogRing &operator=(const LogRing &) = delete;
+    LogRing &operator=(LogRing &&) = delete;
+
+    /*!
+     * Append a line, may be called concurrently from any thread.
+     * Returns false if the line was dropped because the ring is full.
+     */
+    bool push( std::string && line_r ) {
+      size_t pos = _head.load( std::memory_order_relaxed );
+      while ( true ) {
+        Slot & slot = _slots[pos & (capacity-1)];
+        const size_t seq = slot._seq.load( std::memory_order_acquire );
+        const auto diff = static_cast<std::ptrdiff_t>( seq - pos );
+        if ( diff == 0 ) {
+          // slot is free, try to claim it
+          if ( _head.compare_exchange_weak( pos, pos+1, std::memory_order_relaxed ) ) {
+            slot._line = std::move(line_r);
+            slot._seq.store( pos+1, std::memory_order_release );
+            return true;
+          }
+        } else if ( diff < 0 ) {
+          // slot still holds a line from the previous round: ring is full
+          _dropped.fetch_add( 1, std::memory_order_relaxed );
+          return false;
+        } else {
+          // another producer claimed the slot
+          pos = _head.load( std::memory_order_relaxed );
+        }
+      }
+    }
+
+    /*!
+     * Take the oldest line. Must only be called by one consumer at a time.
+     * Returns false if no (completely written) line is available.
+     */
+    bool pop( std::string & line_r ) {
+      Slot & slot = _slots[_tail & (capacity-1)];
+      if ( slot._seq.load( std::memory_order_acquire ) != _tail+1 )
+        return false;
+      line_r = std::move(slot._line);
+      slot._line = std::string();	// don't keep the memory around
+      slot._seq.store( _tail+capacity, std::memory_order_release );
+      ++_tail;
+      return true;
+    }
+
+    /*!
+     * Whether \ref pop would return a line. Consumer only.
+     */
+    bool empty() const {
+      return _slots[_tail & (capacity-1)]._seq.load( std::memory_order_acquire ) != _tail+1;
+    }
+
+    /*!
+     * Returns and resets the number of lines dropped since the last call.
+     */
+    size_t takeDropped() {
+      return _dropped.exchange( 0, std::memory_order_relaxed );
+    }
+
+  private:
+    struct Slot {
+      std::atomic<size_t> _seq;
+      std::string _line;
+    };
+    std::unique_ptr<Slot[]> _slots;
+    alignas(64) std::atomic<size_t> _head { 0 };	///< next slot to claim by a producer
+    alignas(64) size_t _tail = 0;			///< next slot to read by the consumer
+    alignas(64) std::atomic<size_t> _dropped { 0 };	///< lines dropped because the ring was full
+  };
+
+}
+#endif // ZYPP_CORE_BASE_LOGRING_P_H
@@ -15,7 +15,9 @@
 #include <zypp-core/base/Regex.h>
 #include <zypp-core/base/StringV.h>
 
+#include <array>
 #include <stdexcept>
+#include <string_view>
 #include <climits>
 #include <errno.h>
 #include <sys/types.h>
@@ -48,6 +50,14 @@
 #define RX_VALID_HOSTIPV6  \
         "^\\[[:a-fA-F0-9]+(:[0-9]{1,3}(\\.[0-9]{1,3}){3})?\\]$"
 
+// Default patterns of the component checks (config "rx_*")
+#define RX_VALID_USERNAME   "^([" a_zA_Z "0-9!$&'\\(\\)*+=,;~\\._-]|%[a-fA-F0-9]{2})+$"
+#define RX_VALID_PASSWORD   "^([" a_zA_Z "0-9!$&'\\(\\)*+=,:;~\\._-]|%[a-fA-F0-9]{2})+$"
+#define RX_VALID_PATHNAME   "^([" a_zA_Z "0-9!$&'\\(\\){}*+=,:@/~\\._-]|%[a-fA-F0-9]{2})+$"
+#define RX_VALID_PATHPARAMS "^([" a_zA_Z "0-9!$&'\\(\\){}*+=,:;@/~\\._-]|%[a-fA-F0-9]{2})+$"
+#define RX_VALID_QUERYSTR   "^([" a_zA_Z "0-9!$&'\\(\\){}*+=,:;@/?~\\._-]|%[a-fA-F0-9]{2})+$"
+#define RX_VALID_FRAGMENT   "^([" a_zA_Z "0-9!$&'\\(\\){}*+=,:;@/?~\\._-]|%[a-fA-F0-9]{2})+$"
+
 
 //////////////////////////////////////////////////////////////////////
 namespace zypp
@@ -208,7 +218,106 @@ namespace zypp
     namespace // anonymous
     {
 
-                        // -------------------------------------------------------------
+      // -------------------------------------------------------------
+      /*
+      ** Character classes used to validate the components without
+      ** compiling the RX_VALID_* patterns on each call. They follow the
+      ** POSIX bracket expressions, where a backslash is an ordinary char.
+      */
+      enum CharClass : unsigned short
+      {
+        CC_ALNUM      = 1 << 0,
+        CC_DIGIT      = 1 << 1,
+        CC_HEX        = 1 << 2,
+        CC_SCHEME     = 1 << 3,   // [a-zA-Z0-9\\.+-]
+        CC_HOSTNAME   = 1 << 4,   // [[:alnum:]${_}]
+        CC_USERNAME   = 1 << 5,
+        CC_PASSWORD   = 1 << 6,
+        CC_PATHNAME   = 1 << 7,
+        CC_PATHPARAMS = 1 << 8,
+        CC_QUERYSTR   = 1 << 9,
+        CC_FRAGMENT   = 1 << 10,
+      };
+
+      constexpr void addCharClass( std::array<unsigned short,256> & table_r, const char * chars_r, unsigned short cc_r )
+      {
+        for ( ; *chars_r; ++chars_r )
+          table_r[(unsigned char)*chars_r] |= cc_r;
+      }
+
+      constexpr std::array<unsigned short,256> makeCharClassTable()
+      {
+        std::array<unsigned short,256> table {};
+        // in the Estonian locale, a-z excludes t (see a_zA_Z); we don't care about the locale at all
+        addCharClass( table, a_zA_Z "0123456789",
+                      CC_ALNUM|CC_SCHEME|CC_HOSTNAME|CC_USERNAME|CC_PASSWORD|CC_PATHNAME|CC_PATHPARAMS|CC_QUERYSTR|CC_FRAGMENT );
+        addCharClass( table, "0123456789", CC_DIGIT );
+        addCharClass( table, "0123456789abcdefABCDEF", CC_HEX );
+        addCharClass( table, "\\.+-", CC_SCHEME );
+        addCharClass( table, "${_}", CC_HOSTNAME );
+        for ( unsigned ch = 0x80; ch < 0x100; ++ch )
+          table[ch] |= CC_HOSTNAME; // [:alnum:] in a UTF-8 locale accepts (IDN) letters
+        addCharClass( table, "!$&'\\()*+=,;~._-", CC_USERNAME );
+        addCharClass( table, "!$&'\\()*+=,:;~._-", CC_PASSWORD );
+        addCharClass( table, "!$&'\\(){}*+=,:@/~._-", CC_PATHNAME );
+        addCharClass( table, "!$&'\\(){}*+=,:;@/~._-", CC_PATHPARAMS );
+        addCharClass( table, "!$&'\\(){}*+=,:;@/?~._-", CC_QUERYSTR|CC_FRAGMENT );
+        return table;
+      }
+
+      constexpr std::array<unsigned short,256> charClassTable { makeCharClassTable() };
+
+      inline bool isCharClass( char ch_r, unsigned short cc_r )
+      { return charClassTable[(unsigned char)ch_r] & cc_r; }
+
+      /** Whether \a data_r matches <tt>^([cc_r]|%[a-fA-F0-9]{2})+$</tt>. */
+      inline bool matchEncoded( std::string_view data_r, unsigned short cc_r )
+      {
+        if ( data_r.empty() )
+          return false;
+        for ( std::string_view::size_type i = 0; i < data_r.size(); ++i )
+        {
+          if ( data_r[i] == '%' )
+          {
+            if ( data_r.size() - i < 3 || ! isCharClass( data_r[i+1], CC_HEX ) || ! isCharClass( data_r[i+2], CC_HEX ) )
+              return false;
+            i += 2;
+          }
+          else if ( ! isCharClass( data_r[i], cc_r ) )
+            return false;
+        }
+        return true;
+      }
+
+      /** Whether \a data_r consists of 1 to \a max_r digits. */
+      inline bool matchDigits( std::string_view data_r, std::string_view::size_type max_r )
+      {
+        if ( data_r.empty() || data_r.size() > max_r )
+          return false;
+        for ( char ch : data_r )
+          if ( ! isCharClass( ch, CC_DIGIT ) )
+            return false;
+        return true;
+      }
+
+      /** The \ref CharClass to use instead of one of the default \c rx_* patterns (or \c 0). */
+      inline unsigned short defaultPatternClass( const std::string & regx_r )
+      {
+        static const std::pair<std::string,unsigned short> patterns[] = {
+          { RX_VALID_USERNAME,   CC_USERNAME },
+          { RX_VALID_PASSWORD,   CC_PASSWORD },
+          { RX_VALID_PATHNAME,   CC_PATHNAME },
+          { RX_VALID_PATHPARAMS, CC_PATHPARAMS },
+          { RX_VALID_QUERYSTR,   CC_QUERYSTR },
+          { RX_VALID_FRAGMENT,   CC_FRAGMENT },
+        };
+        for ( const auto & p : patterns )
+          if ( regx_r == p.first )
+            return p.second;
+        return 0;
+      }
+
+      // -------------------------------------------------------------
       inline void
       checkUrlData(const std::string &data,
                    const std::string &name,
@@ -224,7 +333,11 @@ namespace zypp
         else
         {
           bool valid = false;
-          try
+          if( unsigned short cc = defaultPatternClass(regx))
+          {
+            valid = matchEncoded(data, cc);
+          }
+          else try
           {
             str::regex rex(regx);
             valid = str::regex_match(data, rex);
@@ -344,14 +457,14 @@ namespace zypp
       // n=no  (don't encode 2. slash if authority present)
       config("path_encode_slash2", "n");
 
-      config("rx_username",     "^([" a_zA_Z "0-9!$&'\\(\\)*+=,;~\\._-]|%[a-fA-F0-9]{2})+$");
-      config("rx_password",     "^([" a_zA_Z "0-9!$&'\\(\\)*+=,:;~\\._-]|%[a-fA-F0-9]{2})+$");
+      config("rx_username",     RX_VALID_USERNAME);
+      config("rx_password",     RX_VALID_PASSWORD);
 
-      config("rx_pathname",     "^([" a_zA_Z "0-9!$&'\\(\\){}*+=,:@/~\\._-]|%[a-fA-F0-9]{2})+$");
-      config("rx_pathparams",   "^([" a_zA_Z "0-9!$&'\\(\\){}*+=,:;@/~\\._-]|%[a-fA-F0-9]{2})+$");
+      config("rx_pathname",     RX_VALID_PATHNAME);
+      config("rx_pathparams",   RX_VALID_PATHPARAMS);
 
-      config("rx_querystr",     "^([" a_zA_Z "0-9!$&'\\(\\){}*+=,:;@/?~\\._-]|%[a-fA-F0-9]{2})+$");
-      config("rx_fragment",     "^([" a_zA_Z "0-9!$&'\\(\\){}*+=,:;@/?~\\._-]|%[a-fA-F0-9]{2})+$");
+      config("rx_querystr",     RX_VALID_QUERYSTR);
+      config("rx_fragment",     RX_VALID_FRAGMENT);
     }
 
 
@@ -440,14 +553,12 @@ namespace zypp
     bool
     UrlBase::isValidScheme(const std::string &scheme) const
     {
-      bool valid = false;
-      try
+      // RX_VALID_SCHEME
+      bool valid = !scheme.empty() && isCharClass(scheme[0], CC_ALNUM) && !isCharClass(scheme[0], CC_DIGIT);
+      for( std::string::size_type i = 1; valid && i < scheme.size(); ++i)
       {
-        str::regex rex(RX_VALID_SCHEME);
-        valid = str::regex_match(scheme, rex);
+        valid = isCharClass(scheme[i], CC_SCHEME);
       }
-      catch( ... )
-      {}
 
       if(valid)
       {
@@ -1402,28 +1513,34 @@ namespace zypp
     bool
     UrlBase::isValidHost(const std::string &host) const
     {
-      try
+      // RX_VALID_HOSTIPV6 (roughly, inet_pton does the rest)
+      if( host.size() > 2 && host.front() == '[' && host.back() == ']')
       {
-        str::regex regx(RX_VALID_HOSTIPV6);
-        if( str::regex_match(host, regx))
+        std::string temp( host.substr(1, host.size()-2));
+        for( char ch : temp)
         {
-          struct in6_addr ip;
-          std::string temp( host.substr(1, host.size()-2));
-
-          return inet_pton(AF_INET6, temp.c_str(), &ip) > 0;
+          if( ! ( isCharClass(ch, CC_HEX) || ch == ':' || ch == '.'))
+            return false;
         }
-        else
+        struct in6_addr ip;
+        return inet_pton(AF_INET6, temp.c_str(), &ip) > 0;
+      }
+      else
+      {
+        // RX_VALID_HOSTNAME, matches also IPv4 dotted-decimal adresses...
+        std::string temp( zypp::url::decode(host));
+        bool label = false;	// inside a label
+        for( char ch : temp)
         {
-          // matches also IPv4 dotted-decimal adresses...
-          std::string temp( zypp::url::decode(host));
-          str::regex  regx(RX_VALID_HOSTNAME);
-          return str::regex_match(temp, regx);
+          if( isCharClass(ch, CC_HOSTNAME))
+            label = true;
+          else if( label && ( ch == '.' || ch == '-'))
+            label = false;
+          else
+            return false;
         }
+        return label;
       }
-      catch( ... )
-      {}
-
-      return false;
     }
 
 
@@ -1431,17 +1548,12 @@ namespace zypp
     bool
     UrlBase::isValidPort(const std::string &port) const
     {
-      try
+      // RX_VALID_PORT
+      if( matchDigits(port, 5))
       {
-        str::regex regx(RX_VALID_PORT);
-        if( str::regex_match(port, regx))
-        {
-          long pnum = str::strtonum<long>(port);
-          return ( pnum >= 1 && pnum <= USHRT_MAX);
-        }
+        long pnum = str::strtonum<long>(port);
+        return ( pnum >= 1 && pnum <= USHRT_MAX);
       }
-      catch( ... )
-      {}
       return false;
     }
 
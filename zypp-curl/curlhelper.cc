@@ -77,6 +77,37 @@ uint curlVersion()
   return curlV->version_num;
 }
 
+CURLSH *curlShareHandle()
+{
+  struct ShareHandle
+  {
+    ShareHandle()
+    : _share( curl_share_init() )
+    {
+      if ( !_share )
+        return;
+      curl_share_setopt( _share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS );
+      curl_share_setopt( _share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION );
+#if CURLVERSION_AT_LEAST(7,57,0)
+      if ( curlVersion() >= CURL_VERSION_BITS(7,57,0) )
+        curl_share_setopt( _share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT );
+#endif
+    }
+    ~ShareHandle()
+    {
+      // fails (and leaves it alone) if easy handles still use it; no logging, as
+      // this may run after the logger is gone
+      if ( _share )
+        curl_share_cleanup( _share );
+    }
+    CURLSH *_share;
+  };
+
+  globalInitCurlOnce();
+  static thread_local ShareHandle _handle;
+  return _handle._share;
+}
+
 int log_curl( CURL * curl, curl_infotype info, char * ptr, size_t len, void * max_lvl )
 {
   if ( max_lvl == nullptr )
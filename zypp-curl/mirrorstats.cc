@@ -0,0 +1,281 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+----------------------------------------------------------------------*/
+#include "private/mirrorstats_p.h"
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <locale>
+#include <sstream>
+#include <vector>
+
+#include <boost/interprocess/sync/file_lock.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
+
+#include <zypp-core/fs/PathInfo.h>
+#include <zypp-core/base/Logger.h>
+#include <zypp-core/base/String.h>
+
+using std::endl;
+
+namespace zypp
+{
+  namespace media
+  {
+    namespace
+    {
+      const std::string magic { "# zypp mirror stats 1" };
+
+      constexpr double ewmaAlpha = 0.3;             // weight of a new sample
+      constexpr double defaultLatency = 200.0;      // ms
+      constexpr double defaultThroughput = 1 << 20; // bytes per second
+      constexpr double blockSize = 256 * 1024;      // bytes, used to estimate the transfer time
+      constexpr double failureCost = 2000.0;        // ms
+
+      /** Parse a double written by \ref MirrorStats::save (independent of the locale). */
+      inline double toDouble( const std::string & str_r )
+      {
+        std::istringstream in { str_r };
+        in.imbue( std::locale::classic() );
+        double ret = 0.0;
+        in >> ret;
+        return ret;
+      }
+
+      /** Weighted mean of \a val_r and \a default_r, \a val_r == 0 meaning unknown. */
+      inline double blend( double val_r, double default_r, double weight_r )
+      { return val_r > 0.0 ? weight_r * val_r + ( 1.0 - weight_r ) * default_r : default_r; }
+
+      /** Update the EWMA \a avg_r. Stale averages (low \a weight_r) are replaced faster. */
+      inline void ewma( double & avg_r, double sample_r, double weight_r )
+      {
+        if ( avg_r <= 0.0 )
+          avg_r = sample_r;
+        else
+        {
+          double alpha = 1.0 - ( 1.0 - ewmaAlpha ) * weight_r;
+          avg_r = alpha * sample_r + ( 1.0 - alpha ) * avg_r;
+        }
+      }
+    } // namespace
+
+    double MirrorStats::Entry::weight( std::time_t now_r ) const
+    {
+      if ( now_r <= lastSeen )
+        return 1.0;
+      return std::exp2( -double( now_r - lastSeen ) / halfLife );
+    }
+
+    MirrorStats & MirrorStats::instance()
+    {
+      static MirrorStats * _instance = new MirrorStats;
+      return *_instance;
+    }
+
+    std::string MirrorStats::makeKey( const zypp::Url & url_r )
+    {
+      return url_r.asString( zypp::Url::ViewOptions::WITH_SCHEME +
+                             zypp::Url::ViewOptions::WITH_HOST +
+                             zypp::Url::ViewOptions::WITH_PORT +
+                             zypp::Url::ViewOptions::EMPTY_AUTHORITY );
+    }
+
+    void MirrorStats::setStatsFile( const zypp::Pathname & file_r )
+    {
+      if ( file_r == _file )
+        return;
+      save();
+      _file = file_r;
+      load();
+    }
+
+    void MirrorStats::load()
+    {
+      _entries.clear();
+      _changed.clear();
+      if ( _file.empty() )
+        return;
+      if ( read( _entries ) )
+        MIL << "Loaded " << *this << endl;
+    }
+
+    bool MirrorStats::read( std::unordered_map<std::string, Entry> & entries_r ) const
+    {
+      std::ifstream in( _file.c_str() );
+      if ( ! in )
+      {
+        DBG << "No mirror stats in " << _file << endl;
+        return false;
+      }
+
+      std::string line;
+      if ( ! std::getline( in, line ) || line != magic )
+      {
+        WAR << "Ignore mirror stats in " << _file << ": unknown format" << endl;
+        return false;
+      }
+
+      std::time_t now = std::time( nullptr );
+      std::vector<std::string> words;
+      while ( std::getline( in, line ) )
+      {
+        words.clear();
+        if ( zypp::str::split( line, std::back_inserter( words ) ) != 5 )
+          continue;
+        Entry entry;
+        entry.throughput = toDouble( words[1] );
+        entry.latency    = toDouble( words[2] );
+        entry.failures   = toDouble( words[3] );
+        entry.lastSeen   = zypp::str::strtonum<std::time_t>( words[4] );
+        if ( now - entry.lastSeen > maxAge )
+          continue;
+        entries_r[words[0]] = entry;
+      }
+      return true;
+    }
+
+    void MirrorStats::save()
+    {
+      if ( _file.empty() || _changed.empty() )
+        return;
+
+      if ( zypp::filesystem::assert_dir( _file.dirname() ) != 0 )
+      {
+        WAR << "Can't save mirror stats to " << _file << endl;
+        return;
+      }
+
+      try
+      {
+        // Concurrent processes: lock, re-read and just replace the hosts we updated.
+        zypp::Pathname lockfile { _file.extend( ".lck" ) };
+        std::ofstream( lockfile.c_str(), std::ios_base::app );	// file_lock needs an existing file
+        boost::interprocess::file_lock flock( lockfile.c_str() );
+        boost::interprocess::scoped_lock<boost::interprocess::file_lock> guard( flock );
+
+        std::unordered_map<std::string, Entry> merged;
+        read( merged );
+        for ( const std::string & key : _changed )
+        {
+          auto it = _entries.find( key );
+          if ( it != _entries.end() )
+            merged[key] = it->second;
+        }
+        _changed.clear();
+        _entries.swap( merged );
+
+        zypp::Pathname tmp { _file.extend( ".new" ) };
+        {
+          std::ofstream out( tmp.c_str() );
+          if ( ! out )
+          {
+            WAR << "Can't save mirror stats to " << tmp << endl;
+            return;
+          }
+          out << magic << endl;
+          out.imbue( std::locale::classic() );
+          out.precision( 12 );	// bytes per second exceed the default 6 digits
+          for ( const auto & el : _entries )
+          {
+            const Entry & entry { el.second };
+            out << el.first << ' ' << entry.throughput << ' ' << entry.latency
+                << ' ' << entry.failures << ' ' << entry.lastSeen << '\n';
+          }
+          if ( ! out.flush() )
+          {
+            WAR << "Error writing mirror stats to " << tmp << endl;
+            zypp::filesystem::unlink( tmp );
+            return;
+          }
+        }
+        if ( zypp::filesystem::rename( tmp, _file ) != 0 )
+        {
+          zypp::filesystem::unlink( tmp );
+          return;
+        }
+      }
+      catch ( const boost::interprocess::interprocess_exception & excpt )
+      {
+        WAR << "Can't lock mirror stats " << _file << ": " << excpt.what() << endl;
+        return;
+      }
+      DBG << "Saved " << *this << endl;
+    }
+
+    MirrorStats::Entry MirrorStats::get( const std::string & key_r ) const
+    {
+      auto it = _entries.find( key_r );
+      if ( it == _entries.end() )
+        return Entry();
+      Entry ret { it->second };
+      ret.failures *= ret.weight( std::time( nullptr ) );
+      return ret;
+    }
+
+    bool MirrorStats::fresh( const std::string & key_r ) const
+    {
+      auto it = _entries.find( key_r );
+      return it != _entries.end() && std::time( nullptr ) - it->second.lastSeen <= freshAge;
+    }
+
+    double MirrorStats::cost( const std::string & key_r ) const
+    {
+      auto it = _entries.find( key_r );
+      if ( it == _entries.end() )
+        return defaultLatency + blockSize / defaultThroughput * 1000.0;
+
+      const Entry & entry { it->second };
+      double weight = entry.weight( std::time( nullptr ) );
+      return blend( entry.latency, defaultLatency, weight )
+           + blockSize / blend( entry.throughput, defaultThroughput, weight ) * 1000.0
+           + entry.failures * weight * failureCost;
+    }
+
+    MirrorStats::Entry & MirrorStats::touch( const std::string & key_r )
+    {
+      Entry & entry { _entries[key_r] };
+      std::time_t now = std::time( nullptr );
+      entry.failures *= entry.weight( now );
+      entry.lastSeen = now;
+      _changed.insert( key_r );
+      return entry;
+    }
+
+    void MirrorStats::recordLatency( const std::string & key_r, double ms_r )
+    {
+      if ( ms_r <= 0.0 )
+        return;
+      auto it = _entries.find( key_r );
+      double weight = it != _entries.end() ? it->second.weight( std::time( nullptr ) ) : 1.0;
+      ewma( touch( key_r ).latency, ms_r, weight );
+    }
+
+    void MirrorStats::recordThroughput( const std::string & key_r, double bytes_r, double seconds_r )
+    {
+      if ( bytes_r <= 0.0 || seconds_r <= 0.0 )
+        return;
+      auto it = _entries.find( key_r );
+      double weight = it != _entries.end() ? it->second.weight( std::time( nullptr ) ) : 1.0;
+      ewma( touch( key_r ).throughput, bytes_r / seconds_r, weight );
+    }
+
+    void MirrorStats::recordSuccess( const std::string & key_r )
+    { touch( key_r ).failures = 0.0; }
+
+    void MirrorStats::recordFailure( const std::string & key_r )
+    { touch( key_r ).failures += 1.0; }
+
+    std::ostream & operator<<( std::ostream & str, const MirrorStats & obj )
+    {
+      return str << "MirrorStats(" << obj._entries.size() << " hosts, " << obj._file << ")";
+    }
+
+  } // namespace media
+} // namespace zypp
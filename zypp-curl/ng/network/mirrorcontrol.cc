@@ -8,10 +8,12 @@
 ----------------------------------------------------------------------*/
 #include "private/mirrorcontrol_p.h"
 #include "private/mediadebug_p.h"
+#include <zypp-curl/private/mirrorstats_p.h>
 #include <zypp-core/zyppng/base/EventDispatcher>
 #include <zypp-core/zyppng/base/Signals>
 #include <zypp-core/base/String.h>
 #include <iostream>
+#include <cmath>
 
 namespace zyppng {
 
@@ -29,13 +31,16 @@ namespace zyppng {
 
   void MirrorControl::Mirror::finishTransfer(const bool success)
   {
+    auto &stats = zypp::media::MirrorStats::instance();
     if ( success ) {
       if ( penalty >= penaltyIncrease ) penalty -= penaltyIncrease;
       successfulTransfers++;
       failedTransfers = 0;
+      stats.recordSuccess( _parent.makeKey( mirrorUrl ) );
     } else {
       penalty += penaltyIncrease;
       failedTransfers++;
+      stats.recordFailure( _parent.makeKey( mirrorUrl ) );
     }
     transferUnref();
   }
@@ -110,6 +115,7 @@ namespace zyppng {
   {
     // do not send signals to us while we are destructing
     _queueEmptyConn.disconnect();
+    zypp::media::MirrorStats::instance().save();
 
     if ( _dispatcher->count() > 0 ) {
       MIL << "Destroying MirrorControl while measurements are still running, aborting" << std::endl;
@@ -125,6 +131,7 @@ namespace zyppng {
 
   void MirrorControl::registerMirrors( const std::vector<zypp::media::MetalinkMirror> &urls )
   {
+    auto &stats = zypp::media::MirrorStats::instance();
     bool doesKnowSomeMirrors = false;
     for ( const auto &mirror : urls ) {
 
@@ -146,11 +153,24 @@ namespace zyppng {
         mirrorHandle->mirrorUrl       = mirror.url;
         mirrorHandle->mirrorUrl.setPathName("/");
 
+        // seed the penalty from failures in previous runs
+        const auto stored = stats.get( urlKey );
+        mirrorHandle->penalty = std::lround( stored.failures ) * penaltyIncrease;
+
+        if ( stats.fresh( urlKey ) && stored.latency > 0 ) {
+          // recently measured, no need to probe the mirror again
+          mirrorHandle->rating += std::lround( stored.latency );
+          DBG_MEDIA << "Using stored rating for mirror: " <<  mirrorHandle->mirrorUrl << ", rating is " << mirrorHandle->rating << ", penalty is " << mirrorHandle->penalty << std::endl;
+          _handles.insert( std::make_pair(urlKey, mirrorHandle ) );
+          doesKnowSomeMirrors = true;
+          continue;
+        }
+
         mirrorHandle->_request = std::make_shared<NetworkRequest>( mirrorHandle->mirrorUrl, "/dev/null", NetworkRequest::WriteShared );
         mirrorHandle->_request->setOptions( NetworkRequest::ConnectionTest );
         mirrorHandle->_request->transferSettings().setTimeout( defaultSampleTime );
         mirrorHandle->_request->transferSettings().setConnectTimeout( defaultSampleTime );
-        mirrorHandle->_finishedConn = mirrorHandle->_request->connectFunc( &NetworkRequest::sigFinished, [ mirrorHandle, &someReadyDelay = _newMirrSigDelay ](  NetworkRequest &req, const NetworkRequestError & ){
+        mirrorHandle->_finishedConn = mirrorHandle->_request->connectFunc( &NetworkRequest::sigFinished, [ mirrorHandle, urlKey, &someReadyDelay = _newMirrSigDelay ](  NetworkRequest &req, const NetworkRequestError & ){
 
           if ( req.hasError() )
             ERR << "Mirror request failed: " << req.error().toString() << " ; " << req.extendedErrorString() << "; for url: "<<req.url()<<std::endl;
@@ -159,7 +179,9 @@ namespace zyppng {
           std::chrono::milliseconds connTime;
           if ( timings ) {
             connTime = std::chrono::duration_cast<std::chrono::milliseconds>(timings->connect - timings->namelookup);
+            zypp::media::MirrorStats::instance().recordLatency( urlKey, connTime.count() );
           } else {
+            zypp::media::MirrorStats::instance().recordFailure( urlKey );
             // we can not get any measurements, maximum penalty
             connTime = std::chrono::seconds( defaultSampleTime );
           }
@@ -213,7 +235,7 @@ namespace zyppng {
     }
 
     std::stable_sort( possibleMirrs.begin(), possibleMirrs.end(), []( const auto &a, const auto &b ) {
-      return a.second->rating < b.second->rating;
+      return a.second->rating + a.second->penalty < b.second->rating + b.second->penalty;
     });
 
     bool hasLoadedOne = false; // do we have a mirror that will be ready again later?
@@ -247,11 +269,7 @@ namespace zyppng {
 
   std::string MirrorControl::makeKey(const zypp::Url &url) const
   {
-    return url.asString( zypp::Url::ViewOptions::WITH_SCHEME +
-                         zypp::Url::ViewOptions::WITH_HOST +
-                         zypp::Url::ViewOptions::WITH_PORT +
-                         zypp::Url::ViewOptions::EMPTY_AUTHORITY
-      );
+    return zypp::media::MirrorStats::makeKey( url );
   }
 
 #if 0
@@ -57,9 +57,12 @@ NetworkRequestDispatcherPrivate::NetworkRequestDispatcherPrivate(  NetworkReques
   curl_multi_setopt( _multi, CURLMOPT_SOCKETFUNCTION, NetworkRequestDispatcherPrivate::static_socket_callback );
   curl_multi_setopt( _multi, CURLMOPT_SOCKETDATA, reinterpret_cast<void *>( this ) );
 
-  // disabled explicit pipelining since it breaks our tests on releases < 15.2
-  // we could consider enabling it starting with a specific CURL version
-  // curl_multi_setopt( _multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX|CURLPIPE_HTTP1 );
+  // explicit pipelining broke our tests on releases < 15.2, so multiplexing is enabled
+  // by default only starting with curl 7.62, which uses it by default too
+#if CURLVERSION_AT_LEAST(7,62,0)
+  _http2Multiplexing = ( ::internal::curlVersion() >= CURL_VERSION_BITS(7,62,0) );
+#endif
+  curl_multi_setopt( _multi, CURLMOPT_PIPELINING, _http2Multiplexing ? CURLPIPE_MULTIPLEX : CURLPIPE_NOTHING );
 
   _timer->setSingleShot( true );
   _timer->connect( &Timer::sigExpired, *this, &NetworkRequestDispatcherPrivate::multiTimerTimout );
@@ -223,6 +226,8 @@ void NetworkRequestDispatcherPrivate::handleMultiSocketAction(curl_socket_t nati
         continue;
       }
 
+      updateConnectionStats( easy );
+
       NetworkRequestPrivate *request = reinterpret_cast<NetworkRequestPrivate *>( privatePtr );
       request->dequeueNotify();
 
@@ -258,6 +263,37 @@ void NetworkRequestDispatcherPrivate::handleMultiSocketAction(curl_socket_t nati
   }
 }
 
+void NetworkRequestDispatcherPrivate::updateConnectionStats( CURL *easy )
+{
+  _connStats.transfers++;
+
+  long connects = 0;
+  if ( curl_easy_getinfo( easy, CURLINFO_NUM_CONNECTS, &connects ) == CURLE_OK ) {
+    if ( connects > 0 )
+      _connStats.newConnections += connects;
+    else
+      _connStats.reusedConnections++;
+  }
+
+#if CURLVERSION_AT_LEAST(7,50,0)
+  long httpVersion = 0;
+  if ( curl_easy_getinfo( easy, CURLINFO_HTTP_VERSION, &httpVersion ) == CURLE_OK && httpVersion == CURL_HTTP_VERSION_2_0 )
+    _connStats.http2Transfers++;
+#endif
+}
+
+bool NetworkRequestDispatcherPrivate::hostHasFreeStreams( const NetworkRequest &req ) const
+{
+  if ( _maxStreamsPerHost < 0 )
+    return true;
+
+  const auto &url = req.url();
+  const auto running = std::count_if( _runningDownloads.begin(), _runningDownloads.end(), [&]( const std::shared_ptr<NetworkRequest> &r ) {
+    return r->url().getHost() == url.getHost() && r->url().getPort() == url.getPort();
+  });
+  return running < _maxStreamsPerHost;
+}
+
 void NetworkRequestDispatcherPrivate::cancelAll( const NetworkRequestError& result )
 {
   //prevent dequeuePending from filling up the runningDownloads again
@@ -341,8 +377,15 @@ void NetworkRequestDispatcherPrivate::dequeuePending()
     if ( !_pendingDownloads.size() )
       break;
 
-    std::shared_ptr<NetworkRequest> req = std::move( _pendingDownloads.front() );
-    _pendingDownloads.pop_front();
+    // take the first request whose host has not reached its stream limit
+    auto it = std::find_if( _pendingDownloads.begin(), _pendingDownloads.end(), [this]( const std::shared_ptr<NetworkRequest> &r ) {
+      return hostHasFreeStreams( *r );
+    });
+    if ( it == _pendingDownloads.end() )
+      break;
+
+    std::shared_ptr<NetworkRequest> req = std::move( *it );
+    _pendingDownloads.erase( it );
 
     std::string errBuf = "Failed to initialize easy handle";
     if ( !req->d_func()->initialize( errBuf ) ) {
@@ -364,6 +407,9 @@ void NetworkRequestDispatcherPrivate::dequeuePending()
   if ( _pendingDownloads.size() == 0 && _runningDownloads.size() == 0 ) {
     //once we finished all requests, cancel the timer too, so curl is not called without requests
     _timer->stop();
+    DBG_MEDIA << "Queue finished, connections: " << _connStats.transfers << " transfers, "
+              << _connStats.newConnections << " new, " << _connStats.reusedConnections << " reused, "
+              << _connStats.http2Transfers << " via HTTP/2" << std::endl;
     _sigQueueFinished.emit( *z_func() );
   }
 }
@@ -405,6 +451,35 @@ int NetworkRequestDispatcher::maximumConcurrentConnections () const
   return d_func()->_maxConnections;
 }
 
+void NetworkRequestDispatcher::setHttp2Multiplexing( const bool enable )
+{
+  Z_D();
+  d->_http2Multiplexing = enable;
+  curl_multi_setopt( d->_multi, CURLMOPT_PIPELINING, enable ? CURLPIPE_MULTIPLEX : CURLPIPE_NOTHING );
+}
+
+bool NetworkRequestDispatcher::http2Multiplexing() const
+{
+  return d_func()->_http2Multiplexing;
+}
+
+void NetworkRequestDispatcher::setMaximumStreamsPerHost( const int maxStreams )
+{
+  Z_D();
+  d->_maxStreamsPerHost = maxStreams;
+  d->dequeuePending();
+}
+
+int NetworkRequestDispatcher::maximumStreamsPerHost() const
+{
+  return d_func()->_maxStreamsPerHost;
+}
+
+const NetworkRequestDispatcher::ConnectionStats &NetworkRequestDispatcher::connectionStats() const
+{
+  return d_func()->_connStats;
+}
+
 void NetworkRequestDispatcher::enqueue(const std::shared_ptr<NetworkRequest> &req )
 {
   if ( !req )
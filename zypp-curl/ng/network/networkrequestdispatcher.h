@@ -101,6 +101,51 @@ namespace zyppng {
        */
       int maximumConcurrentConnections () const;
 
+      /*!
+       * Enables or disables HTTP/2 multiplexing. If enabled, requests to the same host
+       * wait for an existing HTTP/2 connection to become available and are sent as streams
+       * over it, instead of opening a new connection each. Requests to HTTP/1 servers
+       * are not affected.
+       *
+       * This is enabled by default if the used libcurl is 7.62 or newer.
+       * \note Changing this affects only requests started afterwards.
+       */
+      void setHttp2Multiplexing ( const bool enable );
+
+      /*!
+       * Returns whether HTTP/2 multiplexing is enabled, \sa setHttp2Multiplexing
+       */
+      bool http2Multiplexing () const;
+
+      /*!
+       * Change the number of concurrently running requests to the same host,
+       * the default is -1 which means there is no limit other than \ref maximumConcurrentConnections.
+       * With HTTP/2 multiplexing this limits the number of streams per host.
+       */
+      void setMaximumStreamsPerHost ( const int maxStreams );
+
+      /*!
+       * Returns the maximum number of concurrently running requests to the same host.
+       */
+      int maximumStreamsPerHost () const;
+
+      /*!
+       * Statistics about the connections used by the finished transfers.
+       * Connections are shared by all dispatchers and \ref zypp::media::MediaCurl
+       * handlers of the same thread, so a transfer may reuse a connection opened by another one.
+       */
+      struct ConnectionStats {
+        size_t transfers   = 0; //< number of finished transfers
+        size_t newConnections = 0; //< number of connections opened for the transfers
+        size_t reusedConnections = 0; //< number of transfers using an already open connection
+        size_t http2Transfers = 0; //< number of transfers done via HTTP/2
+      };
+
+      /*!
+       * Returns the connection statistics of all transfers finished by this dispatcher.
+       */
+      const ConnectionStats &connectionStats () const;
+
       /*!
        * Enqueues a new \a request and puts it into the waiting queue. If the dispatcher
        * is already running and has free capacatly the request might be started right away
@@ -13,12 +13,14 @@
 #include <zypp-curl/ng/network/private/mediadebug_p.h>
 #include <zypp-curl/ng/network/private/networkrequesterror_p.h>
 #include <zypp-core/AutoDispose.h>
+#include <zypp-curl/private/zckchunkstore_p.h>
 
 #include "zck_p.h"
 
 #include <iostream>
 #include <fstream>
 #include <fcntl.h>
+#include <unistd.h>
 
 extern "C" {
 #include <zck.h>
@@ -26,6 +28,32 @@ extern "C" {
 
 namespace zyppng {
 
+  namespace {
+    /*!
+     * The \ref zypp::Digest name of the zchunk chunk hash type \a type.
+     * Returns an empty string for unsupported types. \a truncated is set
+     * if zchunk keeps only the leading bytes of the digest.
+     */
+    std::string chunkChecksumName( int type, bool &truncated )
+    {
+      truncated = false;
+      switch ( type ) {
+        case ZCK_HASH_SHA1:
+          return zypp::Digest::sha1();
+        case ZCK_HASH_SHA256:
+          return zypp::Digest::sha256();
+        case ZCK_HASH_SHA512:
+          return zypp::Digest::sha512();
+        case ZCK_HASH_SHA512_128:
+          // defined in zchunk as
+          // SHA-512/128 (first 128 bits of SHA-512 checksum)
+          truncated = true;
+          return zypp::Digest::sha512();
+      }
+      return std::string();
+    }
+  }
+
   bool isZchunkFile ( const zypp::Pathname &file ) {
     std::ifstream dFile( file.c_str() );
     if ( !dFile.is_open() )
@@ -191,6 +219,7 @@ namespace zyppng {
     // we calculate what is already downloaded by substracting the block sizes we still need to download from the full file size
     _downloadedMultiByteCount = _fileSize;
 
+    auto &chunkStore = zypp::media::ZckChunkStore::instance();
     auto chunk = zck_get_first_chunk( zckTarget );
     do {
       // Get validity of current chunk: 1 = valid, 0 = missing, -1 = invalid
@@ -199,37 +228,27 @@ namespace zyppng {
 
       zypp::AutoFREE<char> zckDigest( zck_get_chunk_digest( chunk ) );
       UByteArray chksumVec = zypp::Digest::hexStringToUByteArray( std::string_view( zckDigest.value() ) );
-      std::string chksumName;
-      std::optional<size_t> chksumCompareLen;
+      bool truncated = false;
+      std::string chksumName = chunkChecksumName( targetHashType, truncated );
+      if ( chksumName.empty() )
+        return setFailed ( zypp::str::Format( "Unsupported chunk hash type: %1%.") % zck_hash_name_from_type( targetHashType ) );
 
-      switch ( targetHashType ) {
-        case ZCK_HASH_SHA1: {
-          chksumName = zypp::Digest::sha1();
-          break;
-        }
-        case ZCK_HASH_SHA256: {
-          chksumName = zypp::Digest::sha256();
-          break;
-        }
-        case ZCK_HASH_SHA512: {
-          chksumName = zypp::Digest::sha512();
-          break;
-        }
-        case ZCK_HASH_SHA512_128: {
-          // defined in zchunk as
-          // SHA-512/128 (first 128 bits of SHA-512 checksum)
-          chksumName = zypp::Digest::sha512();
-          chksumCompareLen = chksumVec.size();
-          break;
-        }
-        default: {
-          return setFailed ( zypp::str::Format( "Unsupported chunk hash type: %1%.") % zck_hash_name_from_type( targetHashType ) );
-        }
-      }
+      std::optional<size_t> chksumCompareLen;
+      if ( truncated )
+        chksumCompareLen = chksumVec.size();
 
       const auto s = static_cast<off_t>( zck_get_chunk_start( chunk ) );
       const auto l = static_cast<size_t>( zck_get_chunk_comp_size ( chunk ) );
 
+      // the chunk may be known from a file of another repo
+      if ( auto data = chunkStore.lookup( chksumName, zckDigest.value() ); data && data->size() == l ) {
+        if ( ::pwrite( target_fd, data->data(), l, s ) == static_cast<ssize_t>(l) ) {
+          MIL_MEDIA << "Reusing stored block " << s << " with length " << l << " checksum " << zckDigest.value() << std::endl;
+          chunkStore.recordHit( l );
+          continue;
+        }
+      }
+
       MIL_MEDIA << "Downloading block " << s << " with length " << l << " checksum " << zckDigest.value() << " type " << chksumName << std::endl;
 
       _ranges.push_back( Block{
@@ -287,7 +306,27 @@ namespace zyppng {
       return setFailed( "zck_validate_checksums returned a unknown error." );
     }
 
-    // everything is valid
+    // everything is valid, offer the chunks to other repos
+    auto &chunkStore = zypp::media::ZckChunkStore::instance();
+    if ( chunkStore.enabled() ) {
+      bool truncated = false;
+      const std::string chksumName = chunkChecksumName( zck_get_chunk_hash_type( zckTarget ), truncated );
+      std::string buf;
+      for ( auto chunk = zck_get_first_chunk( zckTarget ); !chksumName.empty() && chunk; chunk = zck_get_next_chunk( chunk ) ) {
+        zypp::AutoFREE<char> zckDigest( zck_get_chunk_digest( chunk ) );
+        const auto l = static_cast<size_t>( zck_get_chunk_comp_size ( chunk ) );
+        if ( !zckDigest.value() || l == 0 || chunkStore.contains( chksumName, zckDigest.value() ) )
+          continue;
+
+        buf.resize( l );
+        if ( ::pread( target_fd, buf.data(), l, static_cast<off_t>( zck_get_chunk_start( chunk ) ) ) != static_cast<ssize_t>(l) )
+          break;
+        chunkStore.store( chksumName, zckDigest.value(), buf.data(), l );
+      }
+      chunkStore.commit();
+      MIL << chunkStore << std::endl;
+    }
+
     RangeDownloaderBaseState::setFinished();
   }
 
@@ -34,6 +34,9 @@ public:
   ~NetworkRequestDispatcherPrivate() override;
 
   int _maxConnections = 10;
+  int _maxStreamsPerHost = -1;
+  bool _http2Multiplexing = false;
+  NetworkRequestDispatcher::ConnectionStats _connStats;
 
   std::deque< std::shared_ptr<NetworkRequest> > _pendingDownloads;
   std::vector< std::shared_ptr<NetworkRequest> > _runningDownloads;
@@ -70,6 +73,8 @@ private:
   void onSocketActivated  ( const SocketNotifier &listener, int events );
 
   void handleMultiSocketAction ( curl_socket_t nativeSocket, int evBitmask );
+  void updateConnectionStats ( CURL *easy );
+  bool hostHasFreeStreams ( const NetworkRequest &req ) const;
   void dequeuePending ();
 };
 }
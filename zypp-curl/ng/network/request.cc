@@ -117,6 +117,8 @@ namespace zyppng {
       setCurlOption( CURLOPT_NOPROGRESS, 0L);
       setCurlOption( CURLOPT_FAILONERROR, 1L);
       setCurlOption( CURLOPT_NOSIGNAL, 1L);
+      // share DNS cache, TLS sessions and connections with all other handles
+      setCurlOption( CURLOPT_SHARE, ::internal::curlShareHandle() );
 
       std::string urlBuffer( _url.asString() );
       setCurlOption( CURLOPT_URL, urlBuffer.c_str() );
@@ -124,6 +126,11 @@ namespace zyppng {
       setCurlOption( CURLOPT_WRITEFUNCTION, nwr_writeCallback );
       setCurlOption( CURLOPT_WRITEDATA, this );
 
+      // rather wait for a HTTP/2 connection to become available than opening a new one
+      if ( _dispatcher && _dispatcher->http2Multiplexing() && _protocolMode == ProtocolMode::HTTP
+           && !( _options & NetworkRequest::ConnectionTest ) )
+        setCurlOption( CURLOPT_PIPEWAIT, 1L );
+
       if ( _options & NetworkRequest::ConnectionTest ) {
         setCurlOption( CURLOPT_CONNECT_ONLY, 1L );
         setCurlOption( CURLOPT_FRESH_CONNECT, 1L );
@@ -95,6 +95,19 @@
   Zsync additionally can require that always a sequence of 2 neighboring blocks need to match before they are considered a match. This depends on the filesize and is specified in the zsync metadata file.
   According to the zsync docs this greatly lowers the probability of a false match and allows to send smaller checksums for the blocks, minimizing the data we need to download in the meta datafile.
 
+  Calculating the rolling checksum byte by byte and looking up the hashtable at every offset is what makes the scan CPU bound. So instead
+  of rolling, the checksums of all offsets in a chunk of the buffer are derived from two prefix sums over the chunk. With
+  \f$P_m = \sum_{i<m} X_i\f$ and \f$Q_m = \sum_{i<m} iX_i\f$ a block of length \a L at offset \a k has:
+  \f[
+    a(k,k+L-1) = (P_{k+L} - P_k) \bmod M
+  \f]
+  \f[
+    b(k,k+L-1) = ((k+L)(P_{k+L} - P_k) - (Q_{k+L} - Q_k)) \bmod M
+  \f]
+  The checksums of different offsets no longer depend on each other, so the compiler is able to vectorize the loop (on x86_64 a
+  AVX2 and a default SSE2 version are built and chosen at runtime). A bitset over the checksum hashes of all blocks we are looking for
+  then filters the offsets, only the few passing it need to look into the hashtable.
+
   More in depth docs can be found at http://zsync.moria.org.uk/paper and https://rsync.samba.org/tech_report
 */
 
@@ -107,6 +120,8 @@
 
 #include <utility>
 #include <vector>
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <fstream>
 
@@ -142,8 +157,146 @@ namespace zypp {
         return rsum{ a, b };
       }
 
-      // update the rsum by removing the old and adding the new char
-      #define UPDATE_RSUM(a, b, oldc, newc, bshift) do { (a) += ((unsigned char)(newc)) - ((unsigned char)(oldc)); (b) += (a) - ((oldc) << (bshift)); } while (0)
+      // build a AVX2 and a default version of the hot loops, the best one is chosen at runtime
+#if defined(__x86_64__) && defined(__has_attribute)
+#if __has_attribute(target_clones)
+#if defined(__clang__)
+#define RSUM_TARGET_CLONES __attribute__((target_clones("avx2","default")))
+#else
+#define RSUM_TARGET_CLONES __attribute__((target_clones("avx2","default"),optimize("tree-vectorize")))
+#endif
+#endif
+#endif
+#ifndef RSUM_TARGET_CLONES
+#define RSUM_TARGET_CLONES
+#endif
+
+      /** The \a a part of the rsum of the block of length \a len at offset \a off, derived from the prefix sum \a p. */
+      inline uint16_t rsumAFromPrefix( const uint16_t *p, size_t off, size_t len )
+      { return uint16_t( p[off+len] - p[off] ); }
+
+      /** The \a b part of the rsum of the block of length \a len at offset \a off, derived from the prefix sums \a p and \a q. */
+      inline uint16_t rsumBFromPrefix( const uint16_t *p, const uint16_t *q, size_t off, size_t len )
+      {
+        // unsigned arithmetic wraps around, truncating to 16bit gives the result mod 2^16
+        return uint16_t( uint32_t(off+len) * rsumAFromPrefix( p, off, len ) - uint32_t( uint16_t( q[off+len] - q[off] ) ) );
+      }
+
+      /** Calculate the prefix sums of \a len bytes of \a data into \a p and \a q (\a len+1 entries each). */
+      void calcRsumPrefix( const unsigned char *data, size_t len, uint16_t *p, uint16_t *q )
+      {
+        uint16_t ps = 0;
+        uint16_t qs = 0;
+        p[0] = q[0] = 0;
+        for ( size_t i = 0; i < len; ++i ) {
+          ps += data[i];
+          qs += uint16_t( uint32_t(i) * data[i] );
+          p[i+1] = ps;
+          q[i+1] = qs;
+        }
+      }
+
+      /**
+       * Calculate the rsum hash (same as calc_rhash in \ref MediaBlockList::reuseBlocks) of the block sequence
+       * starting at each of the \a count offsets covered by the prefix sums \a p and \a q.
+       */
+      RSUM_TARGET_CLONES
+      void calcRsumHashes( const uint16_t *p, const uint16_t *q, size_t count, size_t blksize, uint rsumseq, unsigned rsumAMask, uint32_t *hashes )
+      {
+        if ( rsumseq == 2 ) {
+          // the common zsync case, in one pass
+          for ( size_t k = 0; k < count; ++k )
+            hashes[k] = rsumBFromPrefix( p, q, k, blksize ) ^ ( uint32_t( rsumBFromPrefix( p, q, k + blksize, blksize ) ) << 3 );
+        } else if ( rsumseq > 2 ) {
+          for ( size_t k = 0; k < count; ++k )
+            hashes[k] = rsumBFromPrefix( p, q, k, blksize );
+          for ( uint s = 1; s < rsumseq; ++s ) {
+            const size_t soff = s * blksize;
+            for ( size_t k = 0; k < count; ++k )
+              hashes[k] ^= uint32_t( rsumBFromPrefix( p, q, k + soff, blksize ) ) << 3;
+          }
+        } else {
+          for ( size_t k = 0; k < count; ++k )
+            hashes[k] = rsumBFromPrefix( p, q, k, blksize ) ^ ( uint32_t( rsumAFromPrefix( p, k, blksize ) & rsumAMask ) << 3 );
+        }
+      }
+
+      /**
+       * Scans a chunk of the read buffer for offsets whose rsum hash passes a bitset filter.
+       * Offsets are relative to the read buffer, so the scanner must be \ref reset whenever
+       * the buffer content is moved.
+       */
+      struct RsumScanner
+      {
+        RsumScanner( size_t blksize_r, uint rsumseq_r, unsigned rsumAMask_r, const std::vector<uint64_t> & filter_r, unsigned filterMask_r )
+        : _blksize( blksize_r )
+        , _rsumseq( rsumseq_r )
+        , _rsumAMask( rsumAMask_r )
+        , _filter( filter_r )
+        , _filterMask( filterMask_r )
+        {}
+
+        void reset()
+        { _begin = _end = 0; _candidates.clear(); _next = 0; }
+
+        bool covers( off_t off_r ) const
+        { return off_r >= _begin && off_r < _end; }
+
+        off_t end() const
+        { return _end; }
+
+        /** Scan the offsets [begin_r,end_r) of \a buf_r. The buffer must provide the data for a full block sequence at each offset. */
+        void scan( const unsigned char *buf_r, off_t begin_r, off_t end_r )
+        {
+          reset();
+          if ( end_r <= begin_r )
+            return;
+          const size_t count = end_r - begin_r;
+          const size_t span  = count - 1 + _rsumseq * _blksize;
+          _p.resize( span + 1 );
+          _q.resize( span + 1 );
+          _hashes.resize( count );
+          calcRsumPrefix( buf_r + begin_r, span, _p.data(), _q.data() );
+          calcRsumHashes( _p.data(), _q.data(), count, _blksize, _rsumseq, _rsumAMask, _hashes.data() );
+          for ( size_t k = 0; k < count; ++k ) {
+            const uint32_t h = _hashes[k] & _filterMask;
+            if ( _filter[h >> 6] & ( uint64_t(1) << ( h & 63 ) ) )
+              _candidates.push_back( k );
+          }
+          _begin = begin_r;
+          _end   = end_r;
+        }
+
+        /** The first offset >= \a off_r passing the filter, or \ref end. */
+        off_t next( off_t off_r )
+        {
+          while ( _next < _candidates.size() && _begin + off_t(_candidates[_next]) < off_r )
+            ++_next;
+          return _next < _candidates.size() ? _begin + off_t(_candidates[_next]) : _end;
+        }
+
+        /** The rsum of the \a seq_r th block of the sequence at offset \a off_r. */
+        rsum rsumAt( off_t off_r, uint seq_r ) const
+        {
+          const size_t off = ( off_r - _begin ) + seq_r * _blksize;
+          return rsum{ rsumAFromPrefix( _p.data(), off, _blksize ), rsumBFromPrefix( _p.data(), _q.data(), off, _blksize ) };
+        }
+
+      private:
+        size_t _blksize;
+        uint _rsumseq;
+        unsigned _rsumAMask;
+        const std::vector<uint64_t> & _filter;
+        unsigned _filterMask;
+
+        off_t _begin = 0;
+        off_t _end   = 0;
+        std::vector<uint16_t> _p;
+        std::vector<uint16_t> _q;
+        std::vector<uint32_t> _hashes;
+        std::vector<uint32_t> _candidates;
+        size_t _next = 0;
+      };
 
       /**
        * Zsync uses a different rsum length based on the blocksize, since we always calculate the big
@@ -456,6 +609,9 @@ void MediaBlockList::reuseBlocks(FILE *wfp, const std::string& filename)
   std::vector<bool> found( nblks + 1 );
   if (rsumlen && !rsums.empty()) {
 
+      if (!rsumseq)
+        rsumseq = nblks > 1 && chksumlen < 16 ? 2 : 1;
+
       const auto rsumAMask = rsumlen < 3 ? 0 : rsumlen == 3 ? 0xff : 0xffff;
 
       // we are building a array of rsum structs to directly access a and b parts of the checksum
@@ -514,6 +670,17 @@ void MediaBlockList::reuseBlocks(FILE *wfp, const std::string& filename)
         hashList.push_back(id);
       }
 
+      // a bitset over the hashes of all blocks, offsets not passing it can't match
+      // we aim for ~1/16 of the bits set, the hash has at most 19 significant bits
+      unsigned filterMask = 4095;
+      while ( filterMask < 0x7ffff && filterMask / 16 < nblks )
+        filterMask = filterMask * 2 + 1;
+      std::vector<uint64_t> filter( ( filterMask >> 6 ) + 1 );
+      for ( size_t id = 0; id < nblks; id++) {
+        const auto hash = calc_rhash( &zsyncRsums[id] ) & filterMask;
+        filter[hash >> 6] |= uint64_t(1) << ( hash & 63 );
+      }
+
       // we read in 16 sequences at once to speed up processing
       constexpr auto BLOCKCNT = 16;
 
@@ -532,12 +699,8 @@ void MediaBlockList::reuseBlocks(FILE *wfp, const std::string& filename)
       auto seqRsumsData = std::make_unique<rsum[]> ( rsumseq );
       auto seqRsums = seqRsumsData.get();
 
-      // use byteshift instead of multiplication if the blksize is a power of 2
-      // a value is a power of 2 if  ( N & N-1 ) == 0
-      int bshift = 0; // how many bytes do we need to shift
-      if ((blksize & (blksize - 1)) == 0)
-        for (bshift = 0; size_t(1 << bshift) != blksize; bshift++)
-          ;
+      // finds the offsets worth a look into the hashtable
+      RsumScanner scanner( blksize, rsumseq, rsumAMask, filter, filterMask );
 
       bool init = true;
       // when we are in a run of matches, we remember which block ID would need to match next in order
@@ -608,9 +771,6 @@ void MediaBlockList::reuseBlocks(FILE *wfp, const std::string& filename)
         return targetBlocksWritten;
       };
 
-      if (!rsumseq)
-        rsumseq = nblks > 1 && chksumlen < 16 ? 2 : 1;
-
       const off_t seqMatchLen = ( blksize * rsumseq ); //< how many bytes do we need to match when searching a block
 
       while (! feof(fp) ) {
@@ -628,6 +788,7 @@ void MediaBlockList::reuseBlocks(FILE *wfp, const std::string& filename)
             dataLen += remainLen;
             dataOffset = 0;
           }
+          scanner.reset();
 
           // if we hit eof, pad with zeros
           if ( feof(fp) ) {
@@ -648,17 +809,27 @@ void MediaBlockList::reuseBlocks(FILE *wfp, const std::string& filename)
             if ( dataOffset + seqMatchLen > dataLen )
               break;
 
-            u_char *currBuf = readBuf + dataOffset;
-
             // the number of deltafile blocks we have matched, e.g. how much blocks
             // can we skip forward
             uint deltaBlocksMatched = 0;
 
             if ( nextReqMatchInSequence.has_value() ) {
-              if ( tryWriteMatchingBlocks( { *nextReqMatchInSequence }, currBuf, 1 ) > 0 )
+              if ( tryWriteMatchingBlocks( { *nextReqMatchInSequence }, readBuf + dataOffset, 1 ) > 0 )
                 deltaBlocksMatched = 1;
 
             } else {
+              // skip forward to the next offset passing the filter
+              if ( !scanner.covers( dataOffset ) )
+                scanner.scan( readBuf, dataOffset, std::min<off_t>( dataLen - seqMatchLen + 1, dataOffset + readBufSize ) );
+
+              dataOffset = scanner.next( dataOffset );
+              if ( dataOffset == scanner.end() )
+                continue;
+
+              for( uint i = 0; i < rsumseq; i++ )
+                seqRsums[i] = scanner.rsumAt( dataOffset, i );
+
+              u_char *currBuf = readBuf + dataOffset;
               const auto hash = calc_rhash( seqRsums );
 
               // reference to the list of blocks that share our calculated hash
@@ -685,16 +856,8 @@ void MediaBlockList::reuseBlocks(FILE *wfp, const std::string& filename)
 
 
             } else {
-              // we found nothing advance the window by one byte and update the rsums
+              // we found nothing advance the window by one byte, the scanner provides the rsums
               dataOffset++;
-              if ( dataOffset + seqMatchLen > dataLen )
-                break;
-              for ( uint i = 0; i < rsumseq; i++ ) {
-                const auto blkOff = ( i*blksize );
-                u_char oldC = (currBuf + blkOff)[0];
-                u_char newC = (currBuf + blkOff)[blksize];
-                UPDATE_RSUM( seqRsums[i].a, seqRsums[i].b, oldC, newC, bshift );
-              }
             }
           }
         }
@@ -49,6 +49,14 @@ void globalInitCurlOnce();
 
 uint curlVersion();
 
+/*!
+ * The curl share handle of the calling thread. Easy handles using it (\c CURLOPT_SHARE)
+ * share the DNS cache, TLS sessions and (since curl 7.57) the connection cache,
+ * so connections are reused across all downloads done by the thread.
+ * It is per thread, as curl does not support sharing connections between threads.
+ */
+CURLSH *curlShareHandle();
+
 /** Setup CURLOPT_VERBOSE and CURLOPT_DEBUGFUNCTION according to env::ZYPP_MEDIA_CURL_DEBUG. */
 void setupZYPP_MEDIA_CURL_DEBUG( CURL *curl );
 size_t log_redirects_curl( char *ptr, size_t size, size_t nmemb, void *userdata);
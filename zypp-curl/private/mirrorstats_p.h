@@ -0,0 +1,146 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+----------------------------------------------------------------------/
+*
+* This file contains private API, this might break at any time between releases.
+* You have been warned!
+*
+*/
+#ifndef ZYPP_CURL_PRIVATE_MIRRORSTATS_P_H_INCLUDED
+#define ZYPP_CURL_PRIVATE_MIRRORSTATS_P_H_INCLUDED
+
+#include <ctime>
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <zypp-core/Pathname.h>
+#include <zypp-core/Url.h>
+#include <zypp-core/base/NonCopyable.h>
+
+namespace zypp
+{
+  namespace media
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class MirrorStats
+    /// \brief Mirror performance remembered across processes.
+    ///
+    /// Per host (scheme, host and port of the mirror URL) the throughput and
+    /// latency (exponentially weighted moving averages), the failures in a row
+    /// and the time the host was last used are kept. The data are loaded from
+    /// and written to the \ref statsFile (below the zypp cache), so a new
+    /// process may prefer the mirrors which performed well before.
+    ///
+    /// Data age: The older an entry, the less it counts. Its weight is halved
+    /// every \ref halfLife seconds, and entries older than \ref maxAge are
+    /// dropped. Without a \ref statsFile the data are kept in memory only.
+    ///
+    /// Concurrent processes: \ref save locks the file, reads it again and just
+    /// replaces the hosts updated by this process. The data other processes
+    /// saved meanwhile are kept and become visible here.
+    ///////////////////////////////////////////////////////////////////
+    class MirrorStats : private zypp::base::NonCopyable
+    {
+      friend std::ostream & operator<<( std::ostream & str, const MirrorStats & obj );
+
+    public:
+      /** The data of one host. */
+      struct Entry
+      {
+        double throughput = 0.0;  //< bytes per second (EWMA, 0 if unknown)
+        double latency    = 0.0;  //< connect time in ms (EWMA, 0 if unknown)
+        double failures   = 0.0;  //< failed transfers in a row (decays with age)
+        std::time_t lastSeen = 0; //< last time the host was used
+
+        /** Weight of the data \a now_r: \c 1.0 if just seen, halved every \ref halfLife. */
+        double weight( std::time_t now_r ) const;
+      };
+
+      /** Seconds after which the weight of an entry is halved. */
+      static constexpr std::time_t halfLife = 7 * 24 * 3600;
+      /** Entries not seen for longer are dropped. */
+      static constexpr std::time_t maxAge = 8 * halfLife;
+      /** Entries seen not longer ago are considered to be fresh (\ref fresh). */
+      static constexpr std::time_t freshAge = 3600;
+
+    public:
+      /** The process wide store (never destroyed). */
+      static MirrorStats & instance();
+
+      /** The key of the host serving \a url_r. */
+      static std::string makeKey( const zypp::Url & url_r );
+
+    public:
+      /** The file the data are loaded from and saved to (empty if not persistent). */
+      const zypp::Pathname & statsFile() const
+      { return _file; }
+
+      /** Use \a file_r to load and save the data. An empty path disables persistence.
+       * Pending changes are saved to the previous file before the data of \a file_r
+       * are loaded. Setting the current file again is a noop.
+       */
+      void setStatsFile( const zypp::Pathname & file_r );
+
+      /** Merge pending changes into the \ref statsFile. Errors are logged, but not reported. */
+      void save();
+
+    public:
+      /** The data stored for \a key_r (aged, i.e. with decayed failure count). */
+      Entry get( const std::string & key_r ) const;
+
+      /** Whether the data of \a key_r were updated within the last \ref freshAge seconds. */
+      bool fresh( const std::string & key_r ) const;
+
+      /** Estimated cost (in ms) of fetching a block from \a key_r, lower is better.
+       * Unknown or outdated values are blended towards defaults according to
+       * their \ref Entry::weight, so stale data neither favor nor ban a host.
+       */
+      double cost( const std::string & key_r ) const;
+
+    public:
+      /** Remember the connect time to \a key_r. */
+      void recordLatency( const std::string & key_r, double ms_r );
+
+      /** Remember \a bytes_r were received from \a key_r within \a seconds_r. */
+      void recordThroughput( const std::string & key_r, double bytes_r, double seconds_r );
+
+      /** Remember a successful transfer from \a key_r (resets the failures). */
+      void recordSuccess( const std::string & key_r );
+
+      /** Remember a failed transfer from \a key_r. */
+      void recordFailure( const std::string & key_r );
+
+    private:
+      MirrorStats() = default;
+
+      /** The entry to update (aged to now). */
+      Entry & touch( const std::string & key_r );
+
+      void load();
+
+      /** Read the entries of \ref statsFile (dropping outdated ones).
+       * \returns \c false if there is no valid file.
+       */
+      bool read( std::unordered_map<std::string, Entry> & entries_r ) const;
+
+    private:
+      zypp::Pathname _file;
+      std::unordered_map<std::string, Entry> _entries;
+      std::unordered_set<std::string> _changed;	//< hosts updated since the last load or save
+    };
+    ///////////////////////////////////////////////////////////////////
+
+    /** \relates MirrorStats Stream output */
+    std::ostream & operator<<( std::ostream & str, const MirrorStats & obj );
+
+  } // namespace media
+} // namespace zypp
+
+#endif // ZYPP_CURL_PRIVATE_MIRRORSTATS_P_H_INCLUDED
@@ -0,0 +1,152 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+----------------------------------------------------------------------/
+*
+* This file contains private API, this might break at any time between releases.
+* You have been warned!
+*
+*/
+#ifndef ZYPP_CURL_PRIVATE_ZCKCHUNKSTORE_P_H_INCLUDED
+#define ZYPP_CURL_PRIVATE_ZCKCHUNKSTORE_P_H_INCLUDED
+
+#include <iosfwd>
+#include <optional>
+#include <string>
+
+#include <zypp-core/ByteCount.h>
+#include <zypp-core/Pathname.h>
+#include <zypp-core/base/NonCopyable.h>
+
+namespace zypp
+{
+  namespace media
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class ZckChunkStore
+    /// \brief Content addressed store of zchunk chunks shared by all repos.
+    ///
+    /// Zchunk metadata files of different repos (modules, backports, mirrors
+    /// of the same product) share many chunks. Chunks of successfully
+    /// downloaded files are stored below the \ref storeDir, keyed by their
+    /// checksum type and digest, so the zck downloader can take them from
+    /// here instead of requesting their ranges again.
+    ///
+    /// Layout: <tt>storeDir/<checksum type>/<2 digits>/<digest></tt>.
+    ///
+    /// The size of the store is bounded by \ref maxSize. Exceeding it, the
+    /// least recently used chunks (by mtime, which is updated on each hit)
+    /// are evicted. Statistics (e.g. bytes saved) are kept in the file
+    /// \c stats in the \ref storeDir and are available via \ref dumpStats.
+    ///
+    /// Without a \ref storeDir the store is disabled.
+    ///////////////////////////////////////////////////////////////////
+    class ZckChunkStore : private zypp::base::NonCopyable
+    {
+      friend std::ostream & operator<<( std::ostream & str, const ZckChunkStore & obj );
+
+    public:
+      /** Counters accumulated across processes. */
+      struct Stats
+      {
+        unsigned long long hits = 0;         //< chunks taken from the store
+        unsigned long long bytesSaved = 0;   //< bytes not downloaded due to hits
+        unsigned long long stored = 0;       //< chunks added to the store
+        unsigned long long storedBytes = 0;  //< bytes added to the store
+        unsigned long long evicted = 0;      //< chunks evicted from the store
+        unsigned long long evictedBytes = 0; //< bytes evicted from the store
+      };
+
+      /** Default for \ref maxSize. */
+      static const zypp::ByteCount defaultMaxSize;
+
+    public:
+      /** The process wide store (never destroyed). */
+      static ZckChunkStore & instance();
+
+    public:
+      /** The directory holding the chunks (empty if disabled). */
+      const zypp::Pathname & storeDir() const
+      { return _dir; }
+
+      /** Use chunks below \a dir_r. An empty path disables the store.
+       * Pending statistics are saved to the previous directory.
+       * Setting the current directory again is a noop.
+       */
+      void setStoreDir( const zypp::Pathname & dir_r );
+
+      /** Whether a \ref storeDir is set. */
+      bool enabled() const
+      { return ! _dir.empty(); }
+
+      /** Upper limit for the size of all stored chunks. */
+      zypp::ByteCount maxSize() const
+      { return _maxSize; }
+
+      /** Set the upper limit for the size of all stored chunks (\c 0 means unlimited). */
+      void setMaxSize( zypp::ByteCount size_r )
+      { _maxSize = size_r; }
+
+    public:
+      /** The data of the chunk with digest \a digest_r (hex string) of checksum type \a type_r.
+       * A \a digest_r shorter than the full digest (e.g. zchunks SHA-512/128) is compared to the
+       * leading digits. The data are verified; a corrupt chunk is removed from the store.
+       */
+      std::optional<std::string> lookup( const std::string & type_r, const std::string & digest_r );
+
+      /** Remember a chunk of \a len_r bytes was taken from the store instead of being downloaded. */
+      void recordHit( zypp::ByteCount::SizeType len_r );
+
+      /** Whether the chunk \a digest_r of checksum type \a type_r is in the store. */
+      bool contains( const std::string & type_r, const std::string & digest_r ) const;
+
+      /** Add the chunk \a digest_r of checksum type \a type_r unless it is already stored.
+       * The caller is responsible for \a data_r matching the digest.
+       */
+      void store( const std::string & type_r, const std::string & digest_r, const char * data_r, size_t len_r );
+
+      /** Evict the least recently used chunks until the store fits into \ref maxSize
+       * and save the statistics. Call this after a file was processed.
+       */
+      void commit();
+
+    public:
+      /** The accumulated statistics. */
+      const Stats & stats() const
+      { return _stats; }
+
+      /** Human readable statistics. */
+      std::ostream & dumpStats( std::ostream & str ) const;
+
+    private:
+      ZckChunkStore() = default;
+
+      zypp::Pathname chunkPath( const std::string & type_r, const std::string & digest_r ) const;
+
+      /** The current size of the store (scanned once, then maintained). */
+      zypp::ByteCount::SizeType currentSize();
+
+      void trim();
+      void loadStats();
+      void saveStats();
+
+    private:
+      zypp::Pathname _dir;
+      zypp::ByteCount _maxSize = defaultMaxSize;
+      Stats _stats;
+      std::optional<zypp::ByteCount::SizeType> _size;
+      bool _dirty = false;
+    };
+    ///////////////////////////////////////////////////////////////////
+
+    /** \relates ZckChunkStore Stream output */
+    std::ostream & operator<<( std::ostream & str, const ZckChunkStore & obj );
+
+  } // namespace media
+} // namespace zypp
+
+#endif // ZYPP_CURL_PRIVATE_ZCKCHUNKSTORE_P_H_INCLUDED
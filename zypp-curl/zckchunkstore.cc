@@ -0,0 +1,318 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+----------------------------------------------------------------------*/
+#include "private/zckchunkstore_p.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <tuple>
+#include <vector>
+
+#include <unistd.h>
+
+#include <zypp-core/Digest.h>
+#include <zypp-core/fs/PathInfo.h>
+#include <zypp-core/base/Logger.h>
+#include <zypp-core/base/String.h>
+
+using std::endl;
+
+namespace zypp
+{
+  namespace media
+  {
+    namespace
+    {
+      const std::string magic { "# zypp zck chunk store stats 1" };
+      const std::string statsName { "stats" };
+
+      /** Digests are used as file names, so accept plain hex strings only. */
+      inline bool validDigest( const std::string & digest_r )
+      {
+        return digest_r.size() > 2
+            && std::all_of( digest_r.begin(), digest_r.end(), []( char ch ) { return std::isxdigit( (unsigned char)ch ); } );
+      }
+
+      /** Call <tt>fnc_r( Pathname, PathInfo )</tt> for each chunk file below \a dir_r. */
+      template <class TFunction>
+      void forEachChunk( const zypp::Pathname & dir_r, TFunction && fnc_r )
+      {
+        using zypp::filesystem::DirEntry;
+        using zypp::filesystem::FT_DIR;
+        zypp::filesystem::dirForEachExt( dir_r, [&]( const zypp::Pathname & dir, const DirEntry & type ) {
+          if ( type.type != FT_DIR )
+            return true;
+          zypp::filesystem::dirForEachExt( dir / type.name, [&]( const zypp::Pathname & dir, const DirEntry & prefix ) {
+            if ( prefix.type != FT_DIR )
+              return true;
+            zypp::filesystem::dirForEach( dir / prefix.name, [&]( const zypp::Pathname & dir, const char *const name ) {
+              zypp::Pathname file { dir / name };
+              zypp::PathInfo pi { file };
+              if ( pi.isFile() )
+                fnc_r( file, pi );
+              return true;
+            } );
+            return true;
+          } );
+          return true;
+        } );
+      }
+    } // namespace
+
+    const zypp::ByteCount ZckChunkStore::defaultMaxSize { 256, zypp::ByteCount::M };
+
+    ZckChunkStore & ZckChunkStore::instance()
+    {
+      static ZckChunkStore * _instance = new ZckChunkStore;
+      return *_instance;
+    }
+
+    void ZckChunkStore::setStoreDir( const zypp::Pathname & dir_r )
+    {
+      if ( dir_r == _dir )
+        return;
+      saveStats();
+      _dir = dir_r;
+      _stats = Stats();
+      _size.reset();
+      loadStats();
+    }
+
+    zypp::Pathname ZckChunkStore::chunkPath( const std::string & type_r, const std::string & digest_r ) const
+    { return _dir / type_r / digest_r.substr( 0, 2 ) / digest_r; }
+
+    std::optional<std::string> ZckChunkStore::lookup( const std::string & type_r, const std::string & digest_r )
+    {
+      if ( ! enabled() || ! validDigest( digest_r ) )
+        return std::nullopt;
+
+      zypp::Pathname file { chunkPath( type_r, digest_r ) };
+      std::ifstream in( file.c_str(), std::ios::binary );
+      if ( ! in )
+        return std::nullopt;
+
+      std::string data { std::istreambuf_iterator<char>( in ), std::istreambuf_iterator<char>() };
+      if ( in.bad() )
+        return std::nullopt;
+
+      std::string sum { zypp::Digest::digest( type_r, data ) };
+      if ( sum.compare( 0, digest_r.size(), digest_r ) != 0 )
+      {
+        WAR << "Remove corrupt chunk " << file << endl;
+        if ( zypp::filesystem::unlink( file ) == 0 && _size )
+          *_size -= std::min<zypp::ByteCount::SizeType>( *_size, data.size() );
+        return std::nullopt;
+      }
+
+      zypp::filesystem::touch( file ); // LRU
+      return data;
+    }
+
+    void ZckChunkStore::recordHit( zypp::ByteCount::SizeType len_r )
+    {
+      _stats.hits += 1;
+      _stats.bytesSaved += len_r;
+      _dirty = true;
+    }
+
+    bool ZckChunkStore::contains( const std::string & type_r, const std::string & digest_r ) const
+    { return enabled() && validDigest( digest_r ) && zypp::PathInfo( chunkPath( type_r, digest_r ) ).isFile(); }
+
+    void ZckChunkStore::store( const std::string & type_r, const std::string & digest_r, const char * data_r, size_t len_r )
+    {
+      if ( ! enabled() || ! validDigest( digest_r ) || contains( type_r, digest_r ) )
+        return;
+
+      zypp::Pathname file { chunkPath( type_r, digest_r ) };
+      if ( zypp::filesystem::assert_dir( file.dirname() ) != 0 )
+      {
+        WAR << "Can't store chunk " << file << endl;
+        return;
+      }
+
+      // concurrent processes may store the same chunk
+      zypp::Pathname tmp { file.extend( zypp::str::Format(".new.%1%") % ::getpid() ) };
+      {
+        std::ofstream out( tmp.c_str(), std::ios::binary );
+        if ( ! out.write( data_r, len_r ).flush() )
+        {
+          WAR << "Error writing chunk " << tmp << endl;
+          zypp::filesystem::unlink( tmp );
+          return;
+        }
+      }
+      if ( zypp::filesystem::rename( tmp, file ) != 0 )
+      {
+        zypp::filesystem::unlink( tmp );
+        return;
+      }
+
+      _stats.stored += 1;
+      _stats.storedBytes += len_r;
+      _dirty = true;
+      if ( _size )
+        *_size += len_r;
+    }
+
+    void ZckChunkStore::commit()
+    {
+      if ( ! enabled() )
+        return;
+      trim();
+      saveStats();
+    }
+
+    zypp::ByteCount::SizeType ZckChunkStore::currentSize()
+    {
+      if ( ! _size )
+      {
+        _size = 0;
+        forEachChunk( _dir, [this]( const zypp::Pathname &, const zypp::PathInfo & pi ) {
+          *_size += pi.size();
+        } );
+      }
+      return *_size;
+    }
+
+    void ZckChunkStore::trim()
+    {
+      if ( ! _maxSize || currentSize() <= _maxSize )
+        return;
+
+      // Trim down to 90%, so not every new file triggers another scan.
+      const zypp::ByteCount::SizeType limit { _maxSize / 10 * 9 };
+
+      std::vector<std::tuple<std::time_t, zypp::ByteCount::SizeType, zypp::Pathname>> chunks;
+      zypp::ByteCount::SizeType size = 0;
+      forEachChunk( _dir, [&]( const zypp::Pathname & file, const zypp::PathInfo & pi ) {
+        chunks.emplace_back( pi.mtime(), pi.size(), file );
+        size += pi.size();
+      } );
+      std::sort( chunks.begin(), chunks.end() );
+
+      for ( const auto & chunk : chunks )
+      {
+        if ( size <= limit )
+          break;
+        if ( zypp::filesystem::unlink( std::get<2>( chunk ) ) != 0 )
+          continue;
+        size -= std::get<1>( chunk );
+        _stats.evicted += 1;
+        _stats.evictedBytes += std::get<1>( chunk );
+        _dirty = true;
+      }
+      _size = size;
+      MIL << "Trimmed " << *this << endl;
+    }
+
+    void ZckChunkStore::loadStats()
+    {
+      if ( _dir.empty() )
+        return;
+
+      zypp::Pathname file { _dir / statsName };
+      std::ifstream in( file.c_str() );
+      if ( ! in )
+        return;
+
+      std::string line;
+      if ( ! std::getline( in, line ) || line != magic )
+      {
+        WAR << "Ignore chunk store stats in " << file << ": unknown format" << endl;
+        return;
+      }
+
+      std::vector<std::string> words;
+      while ( std::getline( in, line ) )
+      {
+        words.clear();
+        if ( zypp::str::split( line, std::back_inserter( words ) ) != 2 )
+          continue;
+        unsigned long long val { zypp::str::strtonum<unsigned long long>( words[1] ) };
+        if ( words[0] == "hits" )
+          _stats.hits = val;
+        else if ( words[0] == "bytesSaved" )
+          _stats.bytesSaved = val;
+        else if ( words[0] == "stored" )
+          _stats.stored = val;
+        else if ( words[0] == "storedBytes" )
+          _stats.storedBytes = val;
+        else if ( words[0] == "evicted" )
+          _stats.evicted = val;
+        else if ( words[0] == "evictedBytes" )
+          _stats.evictedBytes = val;
+      }
+      _dirty = false;
+      MIL << "Loaded " << *this << endl;
+    }
+
+    void ZckChunkStore::saveStats()
+    {
+      if ( _dir.empty() || ! _dirty )
+        return;
+      _dirty = false;
+
+      if ( zypp::filesystem::assert_dir( _dir ) != 0 )
+      {
+        WAR << "Can't save chunk store stats to " << _dir << endl;
+        return;
+      }
+
+      zypp::Pathname file { _dir / statsName };
+      zypp::Pathname tmp { file.extend( ".new" ) };
+      {
+        std::ofstream out( tmp.c_str() );
+        if ( ! out )
+        {
+          WAR << "Can't save chunk store stats to " << tmp << endl;
+          return;
+        }
+        out << magic << endl
+            << "hits "         << _stats.hits << '\n'
+            << "bytesSaved "   << _stats.bytesSaved << '\n'
+            << "stored "       << _stats.stored << '\n'
+            << "storedBytes "  << _stats.storedBytes << '\n'
+            << "evicted "      << _stats.evicted << '\n'
+            << "evictedBytes " << _stats.evictedBytes << '\n';
+        if ( ! out.flush() )
+        {
+          WAR << "Error writing chunk store stats to " << tmp << endl;
+          zypp::filesystem::unlink( tmp );
+          return;
+        }
+      }
+      if ( zypp::filesystem::rename( tmp, file ) != 0 )
+      {
+        zypp::filesystem::unlink( tmp );
+        return;
+      }
+      DBG << "Saved " << *this << endl;
+    }
+
+    std::ostream & ZckChunkStore::dumpStats( std::ostream & str ) const
+    {
+      str << "Zchunk chunk store " << _dir << " {" << endl;
+      str << "  hits:    " << _stats.hits    << " chunks, " << zypp::ByteCount( _stats.bytesSaved )   << " saved" << endl;
+      str << "  stored:  " << _stats.stored  << " chunks, " << zypp::ByteCount( _stats.storedBytes )  << endl;
+      str << "  evicted: " << _stats.evicted << " chunks, " << zypp::ByteCount( _stats.evictedBytes ) << endl;
+      if ( _size )
+        str << "  size:    " << zypp::ByteCount( *_size ) << " (max " << _maxSize << ")" << endl;
+      return str << "}" << endl;
+    }
+
+    std::ostream & operator<<( std::ostream & str, const ZckChunkStore & obj )
+    {
+      return str << "ZckChunkStore(" << obj._dir << ", " << obj._stats.hits << " hits, "
+                 << zypp::ByteCount( obj._stats.bytesSaved ) << " saved)";
+    }
+
+  } // namespace media
+} // namespace zypp
@@ -16,6 +16,10 @@ extern "C"
 
 #include <iostream>
 #include <fstream>
+#include <unordered_map>
+#include <list>
+#include <mutex>
+#include <algorithm>
 
 #include <zypp/base/Easy.h>
 #include <zypp/base/LogTools.h>
@@ -24,6 +28,9 @@ extern "C"
 
 #include <zypp/DiskUsageCounter.h>
 #include <zypp/ExternalProgram.h>
+#include <zypp/Package.h>
+#include <zypp/base/SerialNumber.h>
+#include <zypp/pool/ItemStatusStore.h>
 #include <zypp/sat/Pool.h>
 #include <zypp/sat/detail/PoolImpl.h>
 
@@ -37,6 +44,40 @@ namespace zypp
   namespace
   { /////////////////////////////////////////////////////////////////
 
+    /** Libsolv result vector initialized with the mountpoints (\a mps_r must outlive it). */
+    std::vector< ::DUChanges> initDuChanges( const DiskUsageCounter::MountPointSet & mps_r )
+    {
+      static const ::DUChanges _initdu = { 0, 0, 0, 0 };
+      std::vector< ::DUChanges> duchanges( mps_r.size(), _initdu );
+      unsigned idx = 0;
+      for_( it, mps_r.begin(), mps_r.end() )
+      {
+        duchanges[idx].path = it->dir.c_str();
+        if ( it->growonly )
+          duchanges[idx].flags |= DUCHANGES_ONLYADD;
+        ++idx;
+      }
+      return duchanges;
+    }
+
+    /** Compute the mountpoints \ref MountPoint::pkg_size from the package data size and number of files. */
+    template <class TKbytes, class TFiles>
+    void applyDuChanges( DiskUsageCounter::MountPointSet & result_r, TKbytes && kbytes_r, TFiles && files_r )
+    {
+      unsigned idx = 0;
+      for_( it, result_r.begin(), result_r.end() )
+      {
+        // Limit estimated waste (half block per file) as it does not apply to
+        // btrfs, which reports up to 64K blocksize (bsc#974275,bsc#965322)
+        static const ByteCount blockAdjust( 2, ByteCount::K ); // (files * blocksize) / 2 / 1K; result value in K!
+
+        it->pkg_size = it->used_size          // current usage
+                     + kbytes_r( idx )        // package data size
+                     + ( files_r( idx ) * ( it->fstype == "btrfs" ? 4096 : it->block_size ) / blockAdjust ); // half block per file
+        ++idx;
+      }
+    }
+
     DiskUsageCounter::MountPointSet calcDiskUsage( DiskUsageCounter::MountPointSet result, const Bitmap & installedmap_r )
     {
       if ( result.empty() )
@@ -48,18 +89,7 @@ namespace zypp
       sat::Pool satpool( sat::Pool::instance() );
 
       // init libsolv result vector with mountpoints
-      static const ::DUChanges _initdu = { 0, 0, 0, 0 };
-      std::vector< ::DUChanges> duchanges( result.size(), _initdu );
-      {
-        unsigned idx = 0;
-        for_( it, result.begin(), result.end() )
-        {
-          duchanges[idx].path = it->dir.c_str();
-          if ( it->growonly )
-            duchanges[idx].flags |= DUCHANGES_ONLYADD;
-          ++idx;
-        }
-      }
+      std::vector< ::DUChanges> duchanges( initDuChanges( result ) );
       // now calc...
       ::pool_calc_duchanges( satpool.get(),
                              const_cast<Bitmap &>(installedmap_r),
@@ -67,22 +97,269 @@ namespace zypp
                              duchanges.size() );
 
       // and process the result
+      applyDuChanges( result,
+                      [&]( unsigned idx ) { return duchanges[idx].kbytes; },
+                      [&]( unsigned idx ) { return duchanges[idx].files; } );
+      return result;
+    }
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class DiskUsageTracker
+    /// \brief Running disk usage totals of the transacting solvables.
+    ///
+    /// Relative to the current system (whose usage is included in the
+    /// mountpoints \ref MountPoint::used_size), only transacting solvables
+    /// matter: a package to be installed adds its disk usage, an installed
+    /// one to be deleted subtracts it (unless the mountpoint is growonly).
+    ///
+    /// The per solvable disk usage is computed once and cached. On each
+    /// \ref update the transacting solvables are collected from the dense
+    /// \ref pool::ItemStatusStore and just the solvables which started or
+    /// stopped to transact since the last call are added to or subtracted
+    /// from the totals.
+    ///
+    /// Libsolv assumes an update of a package without disk usage data does
+    /// not change the disk usage at all (the deleted packages data are
+    /// ignored). This is not additive, so as long as such a package is to
+    /// be installed, \ref update asks for a full recompute.
+    ///////////////////////////////////////////////////////////////////
+    struct DiskUsageTracker
+    {
+      using MountPoint = DiskUsageCounter::MountPoint;
+      using MountPointSet = DiskUsageCounter::MountPointSet;
+      using SolvableIdType = sat::detail::SolvableIdType;
+
+      /** Per mountpoint disk usage of a solvable. */
+      struct Usage
+      {
+        std::vector<long long> kbytes;
+        std::vector<long long> files;
+        bool hasdu = false;	//< whether disk usage data are available
+        bool installed = false;
+      };
+
+      DiskUsageTracker( MountPointSet mps_r )
+      : _mps { std::move(mps_r) }
+      , _kbytes( _mps.size(), 0LL )
+      , _files( _mps.size(), 0LL )
+      {
+        for ( const MountPoint & mp : _mps )
+          _growonly.push_back( mp.growonly );
+      }
+
+      /** The mountpoints the tracker was created for. */
+      const MountPointSet & mountPoints() const
+      { return _mps; }
+
+      /** Update the totals to the current pool status.
+       * \returns \c false if a full recompute is needed.
+       */
+      bool update( const ResPool & pool_r );
+
+      /** The disk usage according to the totals. */
+      MountPointSet result() const
+      {
+        MountPointSet ret { _mps };
+        applyDuChanges( ret,
+                        [this]( unsigned idx ) { return _kbytes[idx]; },
+                        [this]( unsigned idx ) { return _files[idx]; } );
+        return ret;
+      }
+
+      /** Forget all totals and cached data. */
+      void reset()
+      {
+        _counted.clear();
+        _usage.clear();
+        std::fill( _kbytes.begin(), _kbytes.end(), 0LL );
+        std::fill( _files.begin(), _files.end(), 0LL );
+        _noDu = 0;
+      }
+
+    private:
+      /** The (cached) disk usage of \a id_r. */
+      const Usage & usage( SolvableIdType id_r );
+
+      /** Add (\a sign_r \c 1) or subtract (\a sign_r \c -1) the transacting \a id_r to or from the totals. */
+      void count( SolvableIdType id_r, int sign_r );
+
+    private:
+      MountPointSet _mps;				//< node based, so the paths passed to libsolv stay valid
+      std::vector<bool> _growonly;
+      std::vector<long long> _kbytes;		//< totals per mountpoint
+      std::vector<long long> _files;		//< totals per mountpoint
+      std::vector<SolvableIdType> _counted;	//< transacting solvables in the totals (in id order)
+      std::unordered_map<SolvableIdType,Usage> _usage;
+      unsigned _noDu = 0;				//< counted packages to install without disk usage data
+      unsigned _changelog = (unsigned)-1;		//< \ref sat::Pool::changedSolvables processed
+      SerialNumberWatcher _watcherIDs;
+      Bitmap _bitmap;
+    };
+
+    const DiskUsageTracker::Usage & DiskUsageTracker::usage( SolvableIdType id_r )
+    {
+      auto it = _usage.find( id_r );
+      if ( it != _usage.end() )
+        return it->second;
+
+      sat::Pool satpool( sat::Pool::instance() );
+      if ( _bitmap.size() < satpool.capacity() )
+        _bitmap.grow( satpool.capacity() );
+
+      // The solvables own disk usage (not relative to @System)
+      std::vector< ::DUChanges> duchanges( initDuChanges( _mps ) );
+      _bitmap.set( id_r );
+      {
+        DtorReset tmp( satpool.get()->installed );
+        satpool.get()->installed = nullptr;
+        ::pool_calc_duchanges( satpool.get(), _bitmap, &duchanges[0], duchanges.size() );
+      }
+      _bitmap.clear( id_r );
+
+      Usage & ret { _usage[id_r] };
+      sat::Solvable solv { id_r };
+      ret.installed = solv.isSystem();
+      for ( const ::DUChanges & du : duchanges )
+      {
+        ret.kbytes.push_back( du.kbytes );
+        ret.files.push_back( du.files );
+        if ( du.kbytes || du.files )
+          ret.hasdu = true;
+      }
+      // Only packages are subject to libsolvs guess.
+      if ( ! ret.hasdu && ! solv.isKind<Package>() )
+        ret.hasdu = true;
+      return ret;
+    }
+
+    void DiskUsageTracker::count( SolvableIdType id_r, int sign_r )
+    {
+      const Usage & du { usage( id_r ) };
+      if ( du.installed )
+      {
+        // to be deleted
+        for ( unsigned idx = 0; idx < _kbytes.size(); ++idx )
+        {
+          if ( _growonly[idx] )
+            continue;
+          _kbytes[idx] -= sign_r * du.kbytes[idx];
+          _files[idx]  -= sign_r * du.files[idx];
+        }
+      }
+      else
       {
-        unsigned idx = 0;
-        for_( it, result.begin(), result.end() )
+        // to be installed
+        for ( unsigned idx = 0; idx < _kbytes.size(); ++idx )
         {
-          // Limit estimated waste (half block per file) as it does not apply to
-          // btrfs, which reports up to 64K blocksize (bsc#974275,bsc#965322)
-          static const ByteCount blockAdjust( 2, ByteCount::K ); // (files * blocksize) / 2 / 1K; result value in K!
-
-          it->pkg_size = it->used_size          // current usage
-                       + duchanges[idx].kbytes  // package data size
-                       + ( duchanges[idx].files * ( it->fstype == "btrfs" ? 4096 : it->block_size ) / blockAdjust ); // half block per file
-          ++idx;
+          _kbytes[idx] += sign_r * du.kbytes[idx];
+          _files[idx]  += sign_r * du.files[idx];
         }
+        if ( ! du.hasdu )
+          _noDu += sign_r;
       }
+    }
 
-      return result;
+    bool DiskUsageTracker::update( const ResPool & pool_r )
+    {
+      sat::Pool satpool( sat::Pool::instance() );
+      std::vector<sat::Pool::SolvableIdRange> changed;
+      bool reusedIDs = _watcherIDs.remember( satpool.serialIDs() );
+      bool known = satpool.changedSolvables( _changelog, changed );
+      if ( reusedIDs || ! known )
+      {
+        reset();
+      }
+      else if ( ! changed.empty() )
+      {
+        // Solvables added, removed or modified: forget their data
+        auto inChanged = [&]( SolvableIdType id ) {
+          for ( const auto & range : changed )
+            if ( range.first <= id && id < range.second )
+              return true;
+          return false;
+        };
+        std::vector<SolvableIdType> counted;
+        for ( SolvableIdType id : _counted )
+        {
+          if ( inChanged( id ) )
+            count( id, -1 );
+          else
+            counted.push_back( id );
+        }
+        _counted.swap( counted );
+        for ( auto it = _usage.begin(); it != _usage.end(); )
+        {
+          if ( inChanged( it->first ) )
+            it = _usage.erase( it );
+          else
+            ++it;
+        }
+      }
+
+      // Collect the transacting items (the store must be up to date).
+      pool_r.begin();
+      std::vector<SolvableIdType> current;
+      pool::ItemStatusStore::instance().forEachStatus( [&]( SolvableIdType id, const ResStatus & status ) {
+        if ( status.transacts() )
+          current.push_back( id );
+      } );
+
+      // Apply the differences (both in id order).
+      auto cit = _counted.begin();
+      for ( SolvableIdType id : current )
+      {
+        for ( ; cit != _counted.end() && *cit < id; ++cit )
+          count( *cit, -1 );
+        if ( cit != _counted.end() && *cit == id )
+          ++cit;
+        else
+          count( id, 1 );
+      }
+      for ( ; cit != _counted.end(); ++cit )
+        count( *cit, -1 );
+      _counted.swap( current );
+
+      return _noDu == 0;
+    }
+
+    /** Whether \a lhs and \a rhs describe the same mountpoints (\ref MountPoint::pkg_size is a result). */
+    bool sameMountPoints( const DiskUsageCounter::MountPointSet & lhs, const DiskUsageCounter::MountPointSet & rhs )
+    {
+      return std::equal( lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                         []( const DiskUsageCounter::MountPoint & l, const DiskUsageCounter::MountPoint & r ) {
+                           return l.dir == r.dir && l.fstype == r.fstype
+                               && l.block_size == r.block_size && l.total_size == r.total_size && l.used_size == r.used_size
+                               && l.readonly == r.readonly && l.growonly == r.growonly;
+                         } );
+    }
+
+    /** The \ref DiskUsageTracker of a DiskUsageCounter.
+     * The trackers are kept aside, keyed by the counters address, in order not to change
+     * the DiskUsageCounter layout. As a counter can't unregister, just the most recently
+     * used trackers are kept. A tracker not matching the counters mountpoints (changed by
+     * \ref DiskUsageCounter::setMountPoints or a new counter at the same address) is replaced.
+     */
+    shared_ptr<DiskUsageTracker> diskUsageTracker( const DiskUsageCounter & counter_r )
+    {
+      static constexpr unsigned maxTrackers = 8;
+      static std::mutex mutex;
+      static std::list<std::pair<const DiskUsageCounter *, shared_ptr<DiskUsageTracker>>> trackers;	// most recently used first
+
+      std::lock_guard<std::mutex> guard( mutex );
+      auto it = std::find_if( trackers.begin(), trackers.end(), [&]( const auto & el ) { return el.first == &counter_r; } );
+      if ( it != trackers.end() )
+        trackers.splice( trackers.begin(), trackers, it );
+      else
+      {
+        trackers.emplace_front( &counter_r, nullptr );
+        if ( trackers.size() > maxTrackers )
+          trackers.pop_back();
+      }
+
+      shared_ptr<DiskUsageTracker> & tracker { trackers.front().second };
+      if ( ! tracker || ! sameMountPoints( tracker->mountPoints(), counter_r.getMountPoints() ) )
+        tracker.reset( new DiskUsageTracker( counter_r.getMountPoints() ) );
+      return tracker;
     }
 
     /////////////////////////////////////////////////////////////////
@@ -91,6 +368,21 @@ namespace zypp
 
   DiskUsageCounter::MountPointSet DiskUsageCounter::disk_usage( const ResPool & pool_r ) const
   {
+    if ( _mps.empty() )
+    {
+      // partitioning is not set
+      return _mps;
+    }
+
+    shared_ptr<DiskUsageTracker> tracker { diskUsageTracker( *this ) };
+
+    // Compare the tracked and a full recompute (debug)
+    static const bool checkDu = getenv( "ZYPP_DISKUSAGE_CHECK" );
+    bool tracked = tracker->update( pool_r );
+    if ( tracked && ! checkDu )
+      return tracker->result();
+
+    // full recompute
     Bitmap bitmap( Bitmap::poolSize );
 
     // build installedmap (installed != transact)
@@ -102,7 +394,23 @@ namespace zypp
         bitmap.set( sat::asSolvable()(*it).id() );
       }
     }
-    return calcDiskUsage( _mps, bitmap );
+    MountPointSet ret { calcDiskUsage( _mps, bitmap ) };
+
+    if ( tracked )
+    {
+      MountPointSet mps { tracker->result() };
+      auto rit = ret.begin();
+      for ( auto tit = mps.begin(); tit != mps.end(); ++tit, ++rit )
+      {
+        if ( tit->pkg_size != rit->pkg_size )
+        {
+          WAR << "Tracked disk usage differs: " << *tit << " != " << *rit << endl;
+          tracker->reset();
+          break;
+        }
+      }
+    }
+    return ret;
   }
 
   DiskUsageCounter::MountPointSet DiskUsageCounter::disk_usage( sat::Solvable solv_r ) const
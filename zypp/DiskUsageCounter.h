@@ -180,7 +180,14 @@ namespace zypp
     static MountPointSet justRootPartition();
 
 
-    /** Compute disk usage if the current transaction woud be commited. */
+    /** Compute disk usage if the current transaction woud be commited.
+     * The disk usage is tracked incrementally: Repeated calls just add or
+     * subtract the (cached) disk usage of the solvables which started or
+     * stopped to transact since the previous call. A full recompute is done
+     * only if libsolv would guess the disk usage of a package lacking the data.
+     * Setting \c ZYPP_DISKUSAGE_CHECK in the environment compares the tracked
+     * values to a full recompute on each call.
+     */
     MountPointSet disk_usage( const ResPool & pool ) const;
 
     /** Compute disk usage of a single Solvable */
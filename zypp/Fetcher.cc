@@ -13,6 +13,7 @@
 #include <fstream>
 #include <list>
 #include <map>
+#include <vector>
 
 #include <zypp/base/Easy.h>
 #include <zypp/base/LogControl.h>
@@ -24,6 +25,7 @@
 #include <zypp/Fetcher.h>
 #include <zypp/ZYppFactory.h>
 #include <zypp/CheckSum.h>
+#include <zypp-core/CheckSumBatch.h>
 #include <zypp-core/base/UserRequestException>
 #include <zypp/parser/susetags/ContentFileReader.h>
 #include <zypp/parser/susetags/RepoIndex.h>
@@ -197,6 +199,12 @@ namespace zypp
        * location of the cached file or an empty \ref Pathname.
        */
       Pathname locateInCache( const OnMediaLocation & resource_r, const Pathname & destDir_r );
+      /**
+       * Concurrently look up the files of all \a jobs_r in the cache
+       * (\see \ref CheckSumBatch). The results are remembered in
+       * \ref _cacheHits and used by \ref provideToDest.
+       */
+      void locateInCache( const std::vector<FetcherJob_Ptr> & jobs_r, const Pathname & destDir_r );
       /**
        * Validates the provided file against its checkers.
        * \throws Exception
@@ -234,6 +242,8 @@ namespace zypp
     std::map<std::string, CheckSum> _checksums;
     // cache of dir contents
     std::map<std::string, filesystem::DirContent> _dircontent;
+    // cache lookups done in advance (empty Pathname: not cached)
+    std::map<FetcherJob_Ptr, Pathname> _cacheHits;
 
     MediaSetAccess * _mediaSetAccess = nullptr;
 
@@ -320,6 +330,7 @@ namespace zypp
     _indexes.clear();
     _checksums.clear();
     _dircontent.clear();
+    _cacheHits.clear();
   }
 
   void Fetcher::Impl::setMediaSetAccess( MediaSetAccess &media )
@@ -380,6 +391,54 @@ namespace zypp
     return ret;
   }
 
+  void Fetcher::Impl::locateInCache( const std::vector<FetcherJob_Ptr> & jobs_r, const Pathname & destDir_r )
+  {
+    _cacheHits.clear();
+
+    // Candidates in the order locateInCache would try them: destination first, then the caches.
+    CheckSumBatch batch;
+    std::vector<std::pair<FetcherJob_Ptr,size_t>> candidates;	// job and number of candidates
+    for ( const FetcherJob_Ptr & jobp : jobs_r )
+    {
+      const OnMediaLocation & resource( jobp->location );
+      if ( resource.checksum().empty() )
+        continue;	// No checksum - no match
+
+      size_t cnt = 0;
+      if ( PathInfo( destDir_r / resource.filename() ).isExist() )
+      {
+        batch.add( destDir_r / resource.filename(), resource.checksum() );
+        ++cnt;
+      }
+      for( const Pathname & cacheDir : _caches )
+      {
+        if ( PathInfo( cacheDir / resource.filename() ).isExist() )
+        {
+          batch.add( cacheDir / resource.filename(), resource.checksum() );
+          ++cnt;
+        }
+      }
+      candidates.push_back( std::make_pair( jobp, cnt ) );
+    }
+    if ( candidates.empty() )
+      return;
+
+    MIL << "Looking up " << candidates.size() << " files in " << _caches.size() << " cache directories (" << batch.size() << " candidates)" << endl;
+    const std::vector<CheckSumBatch::Result> & results( batch.verify() );
+    auto res = results.begin();
+    for ( const auto & [jobp, cnt] : candidates )
+    {
+      Pathname & hit( _cacheHits[jobp] );
+      for ( auto end = res + cnt; res != end; ++res )
+      {
+        if ( hit.empty() && res->ok() )
+          hit = res->file;
+      }
+      if ( ! hit.empty() )
+        DBG << "file " << jobp->location.filename() << " found in cache " << hit << endl;
+    }
+  }
+
   void Fetcher::Impl::validate( const Pathname & localfile_r, const std::list<FileChecker> & checkers_r )
   {
     try
@@ -533,7 +592,11 @@ namespace zypp
       scoped_ptr<MediaSetAccess::ReleaseFileGuard> releaseFileGuard; // will take care provided files get released
 
       // get cached file (by checksum) or provide from media
-      Pathname tmpFile = locateInCache( resource, destDir_r );
+      Pathname tmpFile;
+      if ( auto hit = _cacheHits.find( jobp_r ); hit != _cacheHits.end() )
+        tmpFile = hit->second;	// already looked up by checksum
+      else
+        tmpFile = locateInCache( resource, destDir_r );
       if ( tmpFile.empty() )
       {
         MIL << "Not found in cache, retrieving..." << endl;
@@ -753,6 +816,9 @@ namespace zypp
 
     downloadAndReadIndexList(media, dest_dir);
 
+    // Collect the file jobs and their checkers first, so the
+    // cache can be searched for all of them at once.
+    std::vector<FetcherJob_Ptr> fileJobs;
     for ( const FetcherJob_Ptr & jobp : _resources )
     {
       if ( jobp->flags & FetcherJob::Directory )
@@ -823,13 +889,21 @@ namespace zypp
           jobp->checkers.push_back(digest_check);
       }
 
+      fileJobs.push_back( jobp );
+    } // for each job
+
+    locateInCache( fileJobs, dest_dir );
+
+    for ( const FetcherJob_Ptr & jobp : fileJobs )
+    {
       // Provide and validate the file. If the file was not transferred
       // and no exception was thrown, it was an optional file.
       provideToDest( media, dest_dir, jobp );
 
       if ( ! progress.incr() )
         ZYPP_THROW(AbortRequestException());
-    } // for each job
+    } // for each file job
+    _cacheHits.clear();
   }
 
   /** \relates Fetcher::Impl Stream output */
@@ -156,9 +156,52 @@ namespace zypp
     return k || p;
   }
 
+  void CachedPublicKeyData::Cache::buildIndex()
+  {
+    _index.clear();
+    const auto & indexId = [this]( const std::string & id_r, unsigned len_r, const PublicKeyData & key_r ) {
+      if ( id_r.size() < len_r )
+        return;
+      std::vector<const PublicKeyData *> & keys { _index[str::toLower( id_r.substr( id_r.size() - len_r ) )] };
+      if ( keys.empty() || keys.back() != &key_r )
+        keys.push_back( &key_r );
+    };
+    for ( const PublicKeyData & key : _data ) {
+      indexId( key.fingerprint(), 16, key );
+      indexId( key.id(), 8, key );
+      for ( const PublicSubkeyData & sub : key.subkeys() )
+        indexId( sub.id(), 16, key );
+    }
+  }
+
   const std::list<PublicKeyData> &CachedPublicKeyData::operator()(const filesystem::Pathname &keyring_r) const
   { return getData( keyring_r ); }
 
+  PublicKeyData CachedPublicKeyData::find( const filesystem::Pathname &keyring_r, const std::string &id_r ) const
+  {
+    std::string key;
+    if ( PublicKeyData::isSafeKeyId( id_r ) )
+      key = id_r.substr( id_r.size() - 16 );
+    else if ( id_r.size() == 8 )
+      key = id_r;
+    else
+      return PublicKeyData();
+
+    Cache & cache( _cacheMap[keyring_r] );
+    cache.assertCache( keyring_r );
+    getData( keyring_r, cache );
+
+    auto it = cache._index.find( str::toLower( key ) );
+    if ( it != cache._index.end() ) {
+      // candidates share the id suffix, the final decision is up to providesKey
+      for ( const PublicKeyData * keyData : it->second ) {
+        if ( keyData->providesKey( id_r ) )
+          return *keyData;
+      }
+    }
+    return PublicKeyData();
+  }
+
   void CachedPublicKeyData::setDirty(const filesystem::Pathname &keyring_r)
   { _cacheMap[keyring_r].setDirty(); }
 
@@ -176,6 +219,7 @@ namespace zypp
   {
     if ( cache_r.hasChanged() ) {
       cache_r._data = KeyManagerCtx::createForOpenPGP( keyring_r ).listKeys();
+      cache_r.buildIndex();
       MIL << "Found keys: " << cache_r._data  << std::endl;
     }
     return cache_r._data;
@@ -280,15 +324,7 @@ namespace zypp
       preloadCachedKeys();
     }
 
-    PublicKeyData ret;
-    for ( const PublicKeyData & key : publicKeyData( keyring ) )
-    {
-      if ( key.providesKey( id ) )
-      {
-        ret = key;
-        break;
-      }
-    }
+    PublicKeyData ret { cachedPublicKeyData.find( keyring, id ) };
     DBG << (ret ? "Found" : "No") << " key [" << id << "] in keyring " << keyring << endl;
     return ret;
   }
@@ -12,9 +12,9 @@
 #include <iostream>
 #include <zypp/base/Logger.h>
 #include <utility>
-#include <zypp-core/base/DefaultIntegral>
 
 #include <zypp/PoolItem.h>
+#include <zypp/pool/ItemStatusStore.h>
 #include <zypp/ResPool.h>
 #include <zypp/Package.h>
 #include <zypp/VendorAttr.h>
@@ -30,10 +30,15 @@ namespace zypp
   //	CLASS NAME : PoolItem::Impl
   //
   /** PoolItem implementation.
-   * \c _buddy handling:
+   * While the item is in the pool, its status, saved status and
+   * buddy are kept in the \ref pool::ItemStatusStore slot of \c _id.
+   * An item removed from the pool (or the nullimpl) uses \c _status
+   * and \c _savedStatus instead (\c _id \c == \c 0).
+   *
+   * buddy handling:
    * \li \c ==0 no buddy
-   * \li \c >0 this uses \c _buddy status
-   * \li \c <0 this status used by \c -_buddy
+   * \li \c >0 this uses \c buddy status
+   * \li \c <0 this status used by \c -buddy
    */
   struct PoolItem::Impl
   {
@@ -42,39 +47,61 @@ namespace zypp
 
       Impl( ResObject::constPtr &&res_r,
             ResStatus &&status_r )
-      : _status( std::move(status_r) )
-      , _resolvable( std::move(res_r) )
-      {}
+      : _resolvable( std::move(res_r) )
+      , _id( _resolvable ? _resolvable->satSolvable().id() : 0 )
+      {
+        if ( _id )
+          store().add( _id, status_r );
+        else
+          _status = std::move(status_r);
+      }
+
+      static pool::ItemStatusStore & store()
+      { return pool::ItemStatusStore::instance(); }
 
       ResStatus & status() const
-      { return _buddy > 0 ? PoolItem(buddy()).status() : _status; }
+      { return _id ? store().status( _id ) : _status; }
 
       sat::Solvable buddy() const
       {
-        if ( !_buddy )
+        sat::detail::IdType b = _id ? store().buddy( _id ) : 0;
+        if ( !b )
           return sat::Solvable::noSolvable;
-        if ( _buddy < 0 )
-          return sat::Solvable( -_buddy );
-        return sat::Solvable( _buddy );
+        if ( b < 0 )
+          return sat::Solvable( -b );
+        return sat::Solvable( b );
       }
 
       void setBuddy( const sat::Solvable & solv_r );
 
+      /** The item left the pool: keep the status on its own. */
+      void detach() const
+      {
+        if ( ! _id )
+          return;
+        _status = store().ownStatus( _id );
+        _savedStatus = store().savedStatus( _id );
+        store().remove( _id );
+        _id = 0;
+      }
+
       ResObject::constPtr resolvable() const
       { return _resolvable; }
 
       ResStatus & statusReset() const
       {
-        _status.setLock( false, zypp::ResStatus::USER );
-        _status.resetTransact( zypp::ResStatus::USER );
-        return _status;
+        ResStatus & myStatus( ownStatus() );
+        myStatus.setLock( false, zypp::ResStatus::USER );
+        myStatus.resetTransact( zypp::ResStatus::USER );
+        return myStatus;
       }
 
       ResStatus & statusReinit() const
       {
-        _status.setLock( _status.isUserLockQueryMatch(), zypp::ResStatus::USER );
-        _status.resetTransact( zypp::ResStatus::USER );
-        return _status;
+        ResStatus & myStatus( ownStatus() );
+        myStatus.setLock( myStatus.isUserLockQueryMatch(), zypp::ResStatus::USER );
+        myStatus.resetTransact( zypp::ResStatus::USER );
+        return myStatus;
       }
 
     public:
@@ -109,34 +136,29 @@ namespace zypp
       }
 
     private:
-      mutable ResStatus     _status;
+      /** The own status (not the buddies). */
+      ResStatus & ownStatus() const
+      { return _id ? store().ownStatus( _id ) : _status; }
+
+    private:
       ResObject::constPtr   _resolvable;
-      DefaultIntegral<sat::detail::IdType,sat::detail::noId> _buddy;
+      mutable sat::detail::SolvableIdType _id = 0;
+      mutable ResStatus     _status;
 
     /** \name Poor man's save/restore state.
-       * \todo There may be better save/restore state strategies.
+     * Pool wide in \ref pool::ItemStatusStore.
      */
     //@{
     public:
       void saveState() const
-      { _savedStatus = status(); }
+      { savedStatus() = status(); }
       void restoreState() const
-      { status() = _savedStatus; }
+      { status() = savedStatus(); }
       bool sameState() const
-      {
-        if ( status() == _savedStatus )
-          return true;
-        // some bits changed...
-        if ( status().getTransactValue() != _savedStatus.getTransactValue()
-             && ( ! status().isBySolver() // ignore solver state changes
-                  // removing a user lock also goes to bySolver
-                  || _savedStatus.getTransactValue() == ResStatus::LOCKED ) )
-          return false;
-        if ( status().isLicenceConfirmed() != _savedStatus.isLicenceConfirmed() )
-          return false;
-        return true;
-      }
+      { return pool::ItemStatusStore::sameState( status(), savedStatus() ); }
     private:
+      ResStatus & savedStatus() const
+      { return _id ? store().savedStatus( _id ) : _savedStatus; }
       mutable ResStatus _savedStatus;
     //@}
 
@@ -164,15 +186,14 @@ namespace zypp
   inline void PoolItem::Impl::setBuddy( const sat::Solvable & solv_r )
   {
     PoolItem myBuddy( solv_r );
-    if ( myBuddy )
+    if ( myBuddy && _id && myBuddy._pimpl->_id )
     {
-      if ( myBuddy._pimpl->_buddy )
+      if ( store().buddy( myBuddy._pimpl->_id ) )
       {
         ERR <<  *this << " would be buddy2 in " << myBuddy << endl;
         return;
       }
-      myBuddy._pimpl->_buddy = -resolvable()->satSolvable().id();
-      _buddy = myBuddy.satSolvable().id();
+      store().setBuddy( _id, myBuddy._pimpl->_id );
       DBG << *this << " has buddy " << myBuddy << endl;
     }
   }
@@ -214,6 +235,7 @@ namespace zypp
   ResStatus & PoolItem::statusReinit() const		{ return _pimpl->statusReinit(); }
   sat::Solvable PoolItem::buddy() const			{ return _pimpl->buddy(); }
   void PoolItem::setBuddy( const sat::Solvable & solv_r )	{ _pimpl->setBuddy( solv_r ); }
+  void PoolItem::detachStatus() const			{ _pimpl->detach(); }
   bool PoolItem::isUndetermined() const			{ return _pimpl->isUndetermined(); }
   bool PoolItem::isRelevant() const			{ return _pimpl->isRelevant(); }
   bool PoolItem::isSatisfied() const			{ return _pimpl->isSatisfied(); }
@@ -148,6 +148,8 @@ namespace zypp
       static PoolItem makePoolItem( const sat::Solvable & solvable_r );
       /** Buddies are set by \ref pool::PoolImpl.*/
       void setBuddy( const sat::Solvable & solv_r );
+      /** The item was removed from the \ref pool::PoolImpl; it keeps its status on its own. */
+      void detachStatus() const;
       /** internal ctor */
     public:
       struct Impl;	///< Expose type only
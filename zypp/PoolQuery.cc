@@ -9,8 +9,15 @@
 /** \file	zypp/PoolQuery.cc
  *
 */
+extern "C"
+{
+#include <solv/repo.h>
+}
+#include <atomic>
 #include <iostream>
 #include <sstream>
+#include <thread>
+#include <unordered_map>
 #include <utility>
 
 #include <zypp/base/Gettext.h>
@@ -22,6 +29,7 @@
 
 #include <zypp/sat/Pool.h>
 #include <zypp/sat/Solvable.h>
+#include <zypp/sat/SearchIndex.h>
 #include <zypp/base/StrMatcher.h>
 
 #include <zypp/PoolQuery.h>
@@ -420,6 +428,7 @@ namespace zypp
       : _flags( Match::SUBSTRING | Match::NOCASE | Match::SKIP_KIND )
       , _match_word(false)
       , _status_flags(ALL)
+      , _parallel(1)
     {}
 
     Impl(const Impl &) = default;
@@ -464,6 +473,9 @@ namespace zypp
     mutable std::string _comment;
     //@}
 
+    /** Max. number of worker threads evaluating the query (not part of the query itself). */
+    unsigned _parallel;
+
   public:
 
     bool operator<( const PoolQuery::Impl & rhs ) const
@@ -524,6 +536,11 @@ namespace zypp
     /** StrMatcher per attribtue. */
     mutable AttrMatchList _attrMatchList;
 
+    /** The trigrams a match must contain, one set per search string.
+     * \returns \c false if the query can not be shortlisted by a \ref sat::SearchIndex.
+     */
+    bool searchIndexAlternatives( std::vector<sat::SearchIndex::Trigrams> & alternatives_r ) const;
+
   private:
     /** Join patterns in \a container_r according to \a flags_r into a single \ref StrMatcher.
      * The \ref StrMatcher returned will be a REGEX if more than one pattern was passed.
@@ -736,6 +753,134 @@ namespace zypp
 
       return str::rxEscapeStr( std::move(str_r) );
     }
+
+    /** The literal substrings any value matching \a str_r must contain.
+     * Literals are the plain string itself or the runs of plain chars in
+     * a glob or regex. A regex containing an alternative has no literals,
+     * just as sub-expressions or anything followed by an optional quantifier.
+     */
+    std::vector<std::string> requiredLiterals( const std::string & str_r, const Match & flags_r )
+    {
+      std::vector<std::string> ret;
+      if ( ! ( flags_r.isModeGlob() || flags_r.isModeRegex() ) )
+      {
+        ret.push_back( str_r );
+        return ret;
+      }
+
+      std::string run;
+      auto endRun = [&]() {
+        if ( ! run.empty() )
+        {
+          ret.push_back( run );
+          run.clear();
+        }
+      };
+      auto skipBracket = [&str_r]( std::string::size_type pos_r ) {	// pos_r at '[', returns pos of ']'
+        ++pos_r;
+        if ( pos_r < str_r.size() && str_r[pos_r] == '^' )
+          ++pos_r;
+        if ( pos_r < str_r.size() && str_r[pos_r] == ']' )
+          ++pos_r;
+        pos_r = str_r.find( ']', pos_r );
+        return( pos_r == std::string::npos ? str_r.size() : pos_r );
+      };
+
+      if ( flags_r.isModeGlob() )
+      {
+        for ( std::string::size_type pos = 0; pos < str_r.size(); ++pos )
+        {
+          char ch = str_r[pos];
+          if ( ch == '*' || ch == '?' )
+            endRun();
+          else if ( ch == '[' )
+          {
+            endRun();
+            pos = skipBracket( pos );
+          }
+          else if ( ch == '\\' && pos+1 < str_r.size() )
+            run += str_r[++pos];
+          else
+            run += ch;
+        }
+        endRun();
+        return ret;
+      }
+
+      // regex:
+      for ( std::string::size_type pos = 0; pos < str_r.size(); ++pos )
+      {
+        char ch = str_r[pos];
+        switch ( ch )
+        {
+          case '|':
+            return std::vector<std::string>();
+
+          case '*':
+          case '?':
+          case '{':
+            if ( ! run.empty() )
+              run.pop_back();	// the preceding char is optional
+            endRun();
+            if ( ch == '{' )
+            {
+              pos = str_r.find( '}', pos );
+              if ( pos == std::string::npos )
+                pos = str_r.size();
+            }
+            break;
+
+          case '[':
+            endRun();
+            pos = skipBracket( pos );
+            break;
+
+          case '(':
+          {
+            endRun();
+            unsigned depth = 0;
+            for ( ; pos < str_r.size(); ++pos )
+            {
+              if ( str_r[pos] == '\\' )
+                ++pos;
+              else if ( str_r[pos] == '[' )
+                pos = skipBracket( pos );
+              else if ( str_r[pos] == '|' )
+                return std::vector<std::string>();
+              else if ( str_r[pos] == '(' )
+                ++depth;
+              else if ( str_r[pos] == ')' && --depth == 0 )
+                break;
+            }
+          }
+          break;
+
+          case '\\':
+            if ( pos+1 < str_r.size() && ! ::isalnum( (unsigned char)str_r[pos+1] ) )
+              run += str_r[++pos];	// escaped special char
+            else
+            {
+              endRun();	// \b, \w, ... or a back reference
+              ++pos;
+            }
+            break;
+
+          case '+':	// the preceding char is required at least once
+          case '.':
+          case '^':
+          case '$':
+          case ')':
+            endRun();
+            break;
+
+          default:
+            run += ch;
+            break;
+        }
+      }
+      endRun();
+      return ret;
+    }
   } // namespace
   ///////////////////////////////////////////////////////////////////
 
@@ -777,6 +922,44 @@ namespace zypp
     return StrMatcher( ret, retflags );
   }
 
+  bool PoolQuery::Impl::searchIndexAlternatives( std::vector<sat::SearchIndex::Trigrams> & alternatives_r ) const
+  {
+    alternatives_r.clear();
+    if ( _attrs.empty() || ! _uncompiledPredicated.empty() )
+      return false;
+
+    StrContainer strings;
+    invokeOnEach( _strings.begin(), _strings.end(), EmptyFilter(), MyInserter(strings) );
+    bool globalStrings = ! strings.empty();
+    for ( const auto & attr : _attrs )
+    {
+      if ( ! sat::SearchIndex::indexes( attr.first ) )
+        return false;
+      bool attrStrings = false;
+      for ( const std::string & str : attr.second )
+      {
+        if ( ! str.empty() )
+        {
+          strings.insert( str );
+          attrStrings = true;
+        }
+      }
+      if ( ! ( globalStrings || attrStrings ) )
+        return false;	// empty searchstring matches always
+    }
+
+    for ( const std::string & str : strings )
+    {
+      sat::SearchIndex::Trigrams trigrams;
+      for ( const std::string & literal : requiredLiterals( str, _flags ) )
+        sat::SearchIndex::addTrigrams( trigrams, literal );
+      if ( trigrams.empty() )
+        return false;
+      alternatives_r.push_back( std::move(trigrams) );
+    }
+    return true;
+  }
+
   std::string PoolQuery::Impl::asString() const
   {
     std::ostringstream o;
@@ -1037,6 +1220,11 @@ namespace zypp
   PoolQuery::StatusFilter PoolQuery::statusFilterFlags() const
   { return _pimpl->_status_flags; }
 
+  void PoolQuery::setParallel( unsigned threads_r )
+  { _pimpl->_parallel = threads_r; }
+  unsigned PoolQuery::parallel() const
+  { return _pimpl->_parallel; }
+
   bool PoolQuery::empty() const
   {
     try { return begin() == end(); }
@@ -1531,6 +1719,10 @@ namespace zypp
      *
      * \note The original implementation treated an empty search string as
      * <it>"match always"</it>. We stay compatible.
+     *
+     * If \ref PoolQuery::setParallel is enabled, or a \ref sat::SearchIndex
+     * is able to shortlist the candidates, the ctor evaluates the whole
+     * query and \ref advance just steps through the result.
      */
     class PoolQueryMatcher
     {
@@ -1546,6 +1738,9 @@ namespace zypp
 
         bool advance( base_iterator & base_r ) const
         {
+          if ( _evaluated )
+            return advanceInResult( base_r );
+
           if ( base_r == end() )
             base_r = startNewQyery(); // first candidate
           else
@@ -1652,14 +1847,22 @@ namespace zypp
           _status_flags = query_r->_status_flags;
           // StrMatcher
           _attrMatchList = query_r->_attrMatchList;
+
+          // Evaluate in advance if enabled, or if a repos SearchIndex can shortlist the candidates:
+          unsigned threads = ( query_r->_parallel != 1 && parallelizable() ? query_r->_parallel : 1 );
+          std::vector<sat::SearchIndex::Trigrams> alternatives;
+          if ( ! ( query_r->searchIndexAlternatives( alternatives ) && anySearchIndex() ) )
+            alternatives.clear();
+          if ( threads != 1 || ! alternatives.empty() )
+            evaluateInAdvance( threads, alternatives );
         }
 
         ~PoolQueryMatcher()
         {}
 
       private:
-        /** Initialize a new base query. */
-        base_iterator startNewQyery() const
+        /** Initialize a new base query (optionally just for \a repo_r or \a solv_r). */
+        base_iterator startNewQyery( Repository repo_r = Repository::noRepository, sat::Solvable solv_r = sat::Solvable::noSolvable ) const
         {
           sat::LookupAttr q;
 
@@ -1667,7 +1870,11 @@ namespace zypp
             return q.end();
 
           // Repo restriction:
-          if ( _repos.size() == 1 )
+          if ( solv_r )
+            q.setSolvable( solv_r );
+          else if ( repo_r )
+            q.setRepo( repo_r );
+          else if ( _repos.size() == 1 )
             q.setRepo( *_repos.begin() );
           // else: handled in isAMatch.
 
@@ -1741,7 +1948,7 @@ namespace zypp
 
             if ( matchData.kindPredicate )
             {
-              if ( matchData.kindPredicate != inSolvable.kind() )
+              if ( ! inSolvable.isKind( matchData.kindPredicate ) )	// kind() would create IdStrings for unknown kinds
               {
                 base_r.nextSkipSolvable();	// this matchData will never match in this solvable
                 return false;
@@ -1763,7 +1970,7 @@ namespace zypp
 
             if ( matchData.kindPredicate )
             {
-              if ( matchData.kindPredicate != inSolvable.kind() )
+              if ( ! inSolvable.isKind( matchData.kindPredicate ) )
                 continue;			// this matchData does not apply
             }
             else if ( !globalKindOk )
@@ -1793,6 +2000,181 @@ namespace zypp
           return false;
         }
 
+      private:
+        /** Whether the query can be evaluated by concurrent worker threads.
+         * Predicates may construct non thread safe data (e.g. \ref Arch).
+         * Checksums and filelists matched by full path are stringified
+         * in libsolvs (shared) tmp space.
+         */
+        bool parallelizable() const
+        {
+          for ( const AttrMatchData & matchData : _attrMatchList )
+          {
+            if ( matchData.predicate )
+              return false;
+            if ( ! matchData.strMatcher )
+              continue; // nothing is stringified
+            if ( matchData.attr == sat::SolvAttr::allAttr || matchData.attr == sat::SolvAttr::checksum )
+              return false;
+            if ( matchData.attr == sat::SolvAttr::filelist && matchData.strMatcher.flags().test( Match::FILES ) )
+              return false;
+          }
+          return true;
+        }
+
+        /** The repos to search, in pool order. */
+        std::vector<Repository> reposToSearch() const
+        {
+          std::vector<Repository> ret;
+          if ( _neverMatchRepo )
+            return ret;
+          for ( const Repository & repo : sat::Pool::instance().repos() )
+          {
+            if ( _status_flags
+               && ( (_status_flags == PoolQuery::INSTALLED_ONLY) != repo.isSystemRepo() ) )
+              continue;
+            if ( ! _repos.empty() && _repos.find( repo ) == _repos.end() )
+              continue;
+            ret.push_back( repo );
+          }
+          return ret;
+        }
+
+        /** Whether any repo to search has a \ref sat::SearchIndex. */
+        bool anySearchIndex() const
+        {
+          for ( const Repository & repo : reposToSearch() )
+          {
+            if ( sat::SearchIndex::get( repo ) )
+              return true;
+          }
+          return false;
+        }
+
+        /** A worker threads job: a whole repo or some solvables of it. */
+        struct Partition
+        {
+          Repository _repo;
+          bool _wholeRepo;
+          std::vector<sat::Solvable> _solvables;	///< unless \ref _wholeRepo
+        };
+
+        /** Evaluate the whole query using up to \a threads_r worker threads (\c 0 meaning one per CPU).
+         * A single attribute is matched by libsolvs dataiterator, which can't be started
+         * within a repo, so we partition by repo. Otherwise \ref isAMatch looks at each
+         * solvable anyway, so large repos are split into ranges of solvables.
+         *
+         * If a repo has a \ref sat::SearchIndex, just the solvables it returns
+         * for \a alternatives_r are looked at.
+         */
+        void evaluateInAdvance( unsigned threads_r, const std::vector<sat::SearchIndex::Trigrams> & alternatives_r )
+        {
+          static const size_t partitionSize = 1024;
+
+          std::vector<Partition> partitions;
+          size_t shortlisted = 0;
+          for ( const Repository & repo : reposToSearch() )
+          {
+            // Page in all data now, as the workers must not do it concurrently.
+            if ( threads_r != 1 )
+              ::repo_disable_paging( repo.get() );
+
+            std::vector<sat::Solvable> solvables;
+            sat::SearchIndex::Ptr index( alternatives_r.empty() ? nullptr : sat::SearchIndex::get( repo ) );
+            if ( index && index->candidates( alternatives_r, solvables ) )
+              shortlisted += solvables.size();
+            else if ( _attrMatchList.size() == 1 )
+            {
+              partitions.push_back( Partition { repo, true, {} } );
+              continue;
+            }
+            else
+              solvables.assign( repo.solvablesBegin(), repo.solvablesEnd() );
+
+            for ( size_t idx = 0; idx < solvables.size(); idx += partitionSize )
+            {
+              auto first = solvables.begin() + idx;
+              partitions.push_back( Partition { repo, false, std::vector<sat::Solvable>( first, first + std::min( partitionSize, solvables.size() - idx ) ) } );
+            }
+          }
+
+          if ( threads_r == 0 )
+            threads_r = std::max( std::thread::hardware_concurrency(), 1U );
+          threads_r = std::min<size_t>( threads_r, partitions.size() );
+
+          std::vector<std::vector<base_iterator>> found( partitions.size() );
+          std::atomic<size_t> next { 0 };
+          auto worker = [&]() {
+            for ( size_t idx = next++; idx < partitions.size(); idx = next++ )
+              found[idx] = evaluate( partitions[idx] );
+          };
+
+          std::vector<std::thread> threads;
+          for ( unsigned i = 1; i < threads_r; ++i )
+            threads.emplace_back( worker );
+          worker();	// this thread takes part as well
+          for ( std::thread & t : threads )
+            t.join();
+
+          // Merge in pool order:
+          for ( const std::vector<base_iterator> & matches : found )
+          {
+            for ( const base_iterator & match : matches )
+            {
+              _resultIndex[match.inSolvable().id()] = _result.size();
+              _result.push_back( match );
+            }
+          }
+          _evaluated = true;
+          DBG << "Evaluated " << partitions.size() << " partitions using " << threads_r << " threads ("
+              << shortlisted << " solvables shortlisted by search index): " << _result.size() << " matches" << endl;
+        }
+
+        /** Collect the matches within \a partition_r. Called by the worker threads. */
+        std::vector<base_iterator> evaluate( const Partition & partition_r ) const
+        {
+          std::vector<base_iterator> ret;
+          if ( partition_r._wholeRepo )
+          {
+            for ( base_iterator base( startNewQyery( partition_r._repo ) ); base != end(); ++base )
+            {
+              if ( isAMatch( base ) )
+              {
+                ret.push_back( base );
+                base.nextSkipSolvable(); // assert we don't visit this Solvable again
+              }
+            }
+          }
+          else
+          {
+            for ( const sat::Solvable & solv : partition_r._solvables )
+            {
+              for ( base_iterator base( startNewQyery( partition_r._repo, solv ) ); base != end(); ++base )
+              {
+                if ( isAMatch( base ) )
+                {
+                  ret.push_back( base );
+                  break;
+                }
+              }
+            }
+          }
+          return ret;
+        }
+
+        /** \ref advance if the result was evaluated in advance. */
+        bool advanceInResult( base_iterator & base_r ) const
+        {
+          size_t idx = ( base_r == end() ? 0 : _resultIndex.at( base_r.inSolvable().id() ) + 1 );
+          if ( idx < _result.size() )
+          {
+            base_r = _result[idx];
+            return true;
+          }
+          base_r = end();
+          return false;
+        }
+
       private:
         /** Repositories include in the search. */
         std::set<Repository> _repos;
@@ -1806,6 +2188,10 @@ namespace zypp
         int _status_flags;
         /** StrMatcher per attribtue. */
         AttrMatchList _attrMatchList;
+        /** Result in pool order, if evaluated in advance. */
+        DefaultIntegral<bool,false> _evaluated;
+        std::vector<base_iterator> _result;
+        std::unordered_map<sat::detail::SolvableIdType,size_t> _resultIndex;
     };
     ///////////////////////////////////////////////////////////////////
 
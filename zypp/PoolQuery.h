@@ -83,6 +83,10 @@ namespace zypp
    * on kinds, multiple repos, and multiple attributes are filtered inside
    * the PoolQuery, so these tend to be slower.
    *
+   * Queries for strings in summaries, descriptions or filelists first ask the
+   * repos \ref sat::SearchIndex (if built, see \ref ZConfig::repo_searchIndex)
+   * for the solvables which may contain the strings, and match just these.
+   *
    * \see detail::PoolQueryIterator on how to inspect matches in detail.
    * \see tests/zypp/PoolQuery_test.cc for more examples
    * \see sat::SolvIterMixin
@@ -384,6 +388,28 @@ namespace zypp
     //void setLocale(const Locale & locale);
     //@}
 
+    /**
+     * Evaluate the query using up to \a threads_r worker threads
+     * (\c 0 meaning one per CPU). The default \c 1 evaluates the query
+     * single threaded in the calling thread.
+     *
+     * If enabled, \ref begin evaluates the whole query at once. The pool is
+     * partitioned into repositories (or ranges of solvables if multiple
+     * attributes are queried) which are searched concurrently. The result
+     * is merged and iterated in pool order, so it is the same as without
+     * parallelism.
+     *
+     * Queries using a predicate (\ref addDependency), full path filelist
+     * matching (\ref setFilesMatchFullPath) or a search string for all
+     * attributes are always evaluated single threaded, as they may use
+     * data which are not safe to be accessed concurrently.
+     *
+     * \note The data of all repositories searched are completely loaded
+     * into memory before the worker threads start.
+     * \note The pool must not be modified while \ref begin is running.
+     */
+    void setParallel( unsigned threads_r );
+
     /** \name getters */
     //@{
 
@@ -429,6 +455,11 @@ namespace zypp
     { return flags().mode(); }
 
     StatusFilter statusFilterFlags() const;
+
+    /** Max. number of worker threads used to evaluate the query (\c 0 meaning one per CPU).
+     * \see \ref setParallel
+     */
+    unsigned parallel() const;
     //@}
 
     /**
@@ -17,6 +17,8 @@
 #include <map>
 #include <algorithm>
 #include <chrono>
+#include <future>
+#include <thread>
 
 #include <zypp-core/base/InputStream>
 #include <zypp-core/Digest.h>
@@ -33,6 +35,7 @@
 #include <zypp/RepoManager.h>
 #include <zypp/zypp_detail/repomanagerbase_p.h>
 #include <zypp/zypp_detail/urlcredentialextractor_p.h>
+#include <zypp/zypp_detail/repo2solv_p.h>
 
 #include <zypp/media/MediaManager.h>
 #include <zypp-media/auth/CredentialManager>
@@ -53,12 +56,15 @@
 #include <zypp/ZYppCallbacks.h>
 
 #include "sat/Pool.h"
+#include "sat/SearchIndex.h"
 #include "zypp-media/ng/providespec.h"
 #include <zypp/base/Algorithm.h>
 
 
 // zyppng related includes
 #include <zypp-core/zyppng/pipelines/Lift>
+#include <zypp-core/zyppng/ui/ProgressObserver>
+#include <zypp/ng/Context>
 #include <zypp/ng/workflows/contextfacade.h>
 #include <zypp/ng/repo/refresh.h>
 #include <zypp/ng/repo/workflows/repomanagerwf.h>
@@ -127,6 +133,32 @@ namespace zypp
       private:
         media::MediaAccessId _mid;
     };
+
+    /** Forward the progress of a \ref zyppng::ProgressObserver to a \ref ProgressReport of its own. */
+    class ProgressObserverReport
+    {
+      public:
+        ProgressObserverReport( zyppng::ProgressObserver & observer_r )
+        : _progress( 100 )
+        {
+          _progress.sendTo( ProgressReportAdaptor( _report ) );
+          _progress.name( observer_r.label() );
+          _progress.toMin();
+          observer_r.connectFunc( &zyppng::ProgressObserver::sigProgressChanged, [this]( zyppng::ProgressObserver &, double value_r ) {
+            _progress.set( value_r );
+          });
+          observer_r.connectFunc( &zyppng::ProgressObserver::sigFinished, [this]( zyppng::ProgressObserver & ) {
+            _progress.toMax();
+          });
+        }
+
+        ProgressObserverReport(const ProgressObserverReport &) = delete;
+        ProgressObserverReport &operator=(const ProgressObserverReport &) = delete;
+
+      private:
+        callback::SendReport<ProgressReport> _report;
+        ProgressData _progress;
+    };
     ///////////////////////////////////////////////////////////////////
   } // namespace
   ///////////////////////////////////////////////////////////////////
@@ -214,6 +246,8 @@ namespace zypp
 
     void buildCache( const RepoInfo & info, CacheBuildPolicy policy, OPT_PROGRESS );
 
+    RefreshReposResult refreshRepos( const std::vector<RepoInfo> & repos, RawMetadataRefreshPolicy policy, CacheBuildPolicy cachePolicy, unsigned maxWorkers, OPT_PROGRESS );
+
     repo::RepoType probe( const Url & url, const Pathname & path = Pathname() ) const;
 
     void loadFromCache( const RepoInfo & info, OPT_PROGRESS );
@@ -235,6 +269,17 @@ namespace zypp
 
     void refreshGeoIPData ( const RepoInfo::url_set &urls );
 
+  private:
+    struct CacheBuild;
+
+    /** Prepare the cache build and start repo2solv in the background.
+     * \returns \c nullptr if the cache is up to date.
+     */
+    shared_ptr<CacheBuild> startBuildCache( const RepoInfo & info, CacheBuildPolicy policy, const ProgressData::ReceiverFnc & progressrcv );
+
+    /** Wait for repo2solv to finish and commit the cache. */
+    void finishBuildCache( CacheBuild & build_r );
+
   private:
     zypp_private::repo::PluginRepoverification _pluginRepoverification;
 
@@ -347,7 +392,47 @@ namespace zypp
 
   }
 
+  /** A repo2solv run building the solv file of a repo (see \ref RepoManager::Impl::buildCache). */
+  struct RepoManager::Impl::CacheBuild
+  {
+    CacheBuild( const RepoInfo & info_r, const ProgressData::ReceiverFnc & progressrcv_r )
+    : _info( info_r )
+    , _progress( 100 )
+    {
+      _progress.sendTo( ProgressReportAdaptor( progressrcv_r, _report ) );
+      _progress.name( str::form(_("Building repository '%s' cache"), _info.label().c_str()) );
+    }
+
+    CacheBuild( const CacheBuild & ) = delete;
+    CacheBuild & operator=( const CacheBuild & ) = delete;
+
+    RepoInfo                             _info;
+    RepoStatus                           _rawMetadataStatus;
+    ManagedFile                          _solvfile;	///< unlinked unless the build succeeds
+    scoped_ptr<MediaMounter>             _forPlainDirs;
+    ExternalProgram::Arguments           _cmd;	///< repo2solv commandline
+    std::future<void>                    _builder;	///< in-process repo2solv
+    scoped_ptr<ExternalProgram>          _prog;	///< external repo2solv
+    callback::SendReport<ProgressReport> _report;
+    ProgressData                         _progress;
+
+    /** Whether the solv file is still being built. */
+    bool running()
+    {
+      if ( _builder.valid() )
+        return _builder.wait_for( std::chrono::seconds(0) ) != std::future_status::ready;
+      return _prog && _prog->running();
+    }
+  };
+
   void RepoManager::Impl::buildCache( const RepoInfo & info, CacheBuildPolicy policy, const ProgressData::ReceiverFnc & progressrcv )
+  {
+    shared_ptr<CacheBuild> build( startBuildCache( info, policy, progressrcv ) );
+    if ( build )
+      finishBuildCache( *build );
+  }
+
+  shared_ptr<RepoManager::Impl::CacheBuild> RepoManager::Impl::startBuildCache( const RepoInfo & info, CacheBuildPolicy policy, const ProgressData::ReceiverFnc & progressrcv )
   {
     assert_alias(info);
     Pathname mediarootpath = rawcache_path_for_repoinfo( _options, info );
@@ -383,8 +468,10 @@ namespace zypp
           const Pathname & base = solv_path_for_repoinfo( _options, info);
           if ( ! PathInfo(base/"solv.idx").isExist() )
             sat::updateSolvFileIndex( base/"solv" );
+          if ( ZConfig::instance().repo_searchIndex() && ! PathInfo( sat::SearchIndex::indexFile( base/"solv" ) ).isExist() )
+            sat::SearchIndex::build( base/"solv" );
 
-          return;
+          return nullptr;
         }
         else {
           MIL << info.alias() << " cache rebuild is forced" << endl;
@@ -394,11 +481,9 @@ namespace zypp
       needs_cleaning = true;
     }
 
-    ProgressData progress(100);
-    callback::SendReport<ProgressReport> report;
-    progress.sendTo( ProgressReportAdaptor( progressrcv, report ) );
-    progress.name(str::form(_("Building repository '%s' cache"), info.label().c_str()));
-    progress.toMin();
+    shared_ptr<CacheBuild> build( new CacheBuild( info, progressrcv ) );
+    build->_rawMetadataStatus = raw_metadata_status;
+    build->_progress.toMin();
 
     if (needs_cleaning)
     {
@@ -445,10 +530,9 @@ namespace zypp
       case RepoType::RPMPLAINDIR_e :
       {
         // Take care we unlink the solvfile on exception
-        ManagedFile guard( solvfile, filesystem::unlink );
-        scoped_ptr<MediaMounter> forPlainDirs;
+        build->_solvfile = ManagedFile( solvfile, filesystem::unlink );
 
-        ExternalProgram::Arguments cmd;
+        ExternalProgram::Arguments & cmd( build->_cmd );
         cmd.push_back( PathInfo( "/usr/bin/repo2solv" ).isFile() ? "repo2solv" : "repo2solv.sh" );
         // repo2solv expects -o as 1st arg!
         cmd.push_back( "-o" );
@@ -458,44 +542,184 @@ namespace zypp
 
         if ( repokind == RepoType::RPMPLAINDIR )
         {
-          forPlainDirs.reset( new MediaMounter( info.url() ) );
+          build->_forPlainDirs.reset( new MediaMounter( info.url() ) );
           // recusive for plaindir as 2nd arg!
           cmd.push_back( "-R" );
           // FIXME this does only work form dir: URLs
-          cmd.push_back( forPlainDirs->getPathName( info.path() ).c_str() );
+          cmd.push_back( build->_forPlainDirs->getPathName( info.path() ).c_str() );
         }
         else
           cmd.push_back( productdatapath.asString() );
 
-        ExternalProgram prog( cmd, ExternalProgram::Stderr_To_Stdout );
-        std::string errdetail;
-
-        for ( std::string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
-          WAR << "  " << output;
-          errdetail += output;
-        }
-
-        int ret = prog.close();
-        if ( ret != 0 )
+        if ( repokind == RepoType::RPMMD && ! env::ZYPP_REPO2SOLV_EXTERNAL() )
         {
-          RepoException ex(info, str::form( _("Failed to cache repo (%d)."), ret ));
-          ex.addHistory( str::Str() << prog.command() << endl << errdetail << prog.execError() ); // errdetail lines are NL-terminaled!
-          ZYPP_THROW(ex);
+          // rpm-md is parsed in-process in a separate thread, repo2solv remains the fallback
+          build->_builder = std::async( std::launch::async, [productdatapath,solvfile]() {
+            repo2solvRpmmd( productdatapath, solvfile );
+          });
         }
-
-        // We keep it.
-        guard.resetDispose();
-        sat::updateSolvFileIndex( solvfile );	// content digest for zypper bash completion
+        else
+          build->_prog.reset( new ExternalProgram( cmd, ExternalProgram::Stderr_To_Stdout ) );
       }
       break;
       default:
         ZYPP_THROW(RepoUnknownTypeException( info, _("Unhandled repository type") ));
       break;
     }
+    return build;
+  }
+
+  void RepoManager::Impl::finishBuildCache( CacheBuild & build_r )
+  {
+    if ( build_r._builder.valid() )
+    {
+      try {
+        build_r._builder.get();
+      }
+      catch ( const Exception & excpt ) {
+        ZYPP_CAUGHT( excpt );
+        WAR << build_r._info.alias() << ": in-process cache build failed. Fallback to " << build_r._cmd[0] << endl;
+        build_r._prog.reset( new ExternalProgram( build_r._cmd, ExternalProgram::Stderr_To_Stdout ) );
+      }
+    }
+
+    if ( build_r._prog )
+    {
+      ExternalProgram & prog( *build_r._prog );
+      std::string errdetail;
+
+      for ( std::string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
+        WAR << "  " << output;
+        errdetail += output;
+      }
+
+      int ret = prog.close();
+      if ( ret != 0 )
+      {
+        RepoException ex(build_r._info, str::form( _("Failed to cache repo (%d)."), ret ));
+        ex.addHistory( str::Str() << prog.command() << endl << errdetail << prog.execError() ); // errdetail lines are NL-terminaled!
+        ZYPP_THROW(ex);
+      }
+    }
+    build_r._forPlainDirs.reset();
+
+    // We keep it.
+    build_r._solvfile.resetDispose();
+    sat::updateSolvFileIndex( build_r._solvfile.value() );	// content digest for zypper bash completion
+    if ( ZConfig::instance().repo_searchIndex() )
+      sat::SearchIndex::build( build_r._solvfile.value() );
+
     // update timestamp and checksum
-    setCacheStatus(info, raw_metadata_status);
+    setCacheStatus(build_r._info, build_r._rawMetadataStatus);
     MIL << "Commit cache.." << endl;
+    build_r._progress.toMax();
+  }
+
+  RepoManager::RefreshReposResult RepoManager::Impl::refreshRepos( const std::vector<RepoInfo> & repos, RawMetadataRefreshPolicy policy, CacheBuildPolicy cachePolicy, unsigned maxWorkers, const ProgressData::ReceiverFnc & progressrcv )
+  {
+    if ( ! maxWorkers )
+      maxWorkers = std::max( std::thread::hardware_concurrency(), 1U );
+    MIL << "Refresh " << repos.size() << " repos (" << maxWorkers << " in parallel)" << endl;
+
+    RefreshReposResult result;
+    ProgressData progress( repos.size() );
+    progress.sendTo( progressrcv );
+    progress.toMin();
+
+    // make sure geoIP data is up 2 date
+    for ( const RepoInfo & info : repos )
+      refreshGeoIPData( info.baseUrls() );
+
+    // Refresh the metadata and build the caches of all repos concurrently. The async
+    // workflows can't ask the legacy callbacks (e.g. to accept a new key), so the repos
+    // failing here get a second chance below, the usual way.
+    std::vector<RepoInfo> retry;
+    {
+      std::list<ProgressObserverReport> reports;	// each repo its own ProgressReport
+      auto ctx = zyppng::Context::create();
+      auto observer = zyppng::ProgressObserver::create();
+      observer->connectFunc( &zyppng::ProgressObserver::sigNewSubprogress, [&reports]( zyppng::ProgressObserver &, zyppng::ProgressObserverRef child ) {
+        reports.emplace_back( *child );
+      });
+
+      auto op = zyppng::RepoManagerWorkflow::refreshRepos( ctx, repos, _options,
+                                                           static_cast<zyppng::repo::RawMetadataRefreshPolicy>( policy ),
+                                                           static_cast<zyppng::repo::CacheBuildPolicy>( cachePolicy ),
+                                                           maxWorkers, observer );
+      ctx->execute( op );
+
+      const auto & results { op->get() };
+      for ( std::size_t i = 0; i < repos.size(); ++i )
+      {
+        if ( results[i] )
+        {
+          result[repos[i].alias()] = nullptr;
+          if ( ! isTmpRepo( repos[i] ) )
+            reposManip();	// remember to trigger appdata refresh
+          progress.incr();
+        }
+        else
+        {
+          MIL << "Retry to refresh repo " << repos[i].alias() << endl;
+          retry.push_back( repos[i] );
+        }
+      }
+    }
+
+    std::list<shared_ptr<CacheBuild>> running;	// in order of start
+
+    const auto & finishBuild = [&]( std::list<shared_ptr<CacheBuild>>::iterator it ) {
+      shared_ptr<CacheBuild> build( *it );
+      running.erase( it );
+      try {
+        finishBuildCache( *build );
+      }
+      catch ( const Exception & e ) {
+        ZYPP_CAUGHT( e );
+        ERR << "Failed to build cache for repo " << build->_info.alias() << endl;
+        result[build->_info.alias()] = std::current_exception();
+      }
+      progress.incr();
+    };
+
+    const auto & reapFinishedBuilds = [&]( unsigned keep_r ) {
+      // first collect the ones already done, then wait for the oldest
+      for ( auto it = running.begin(); it != running.end(); ) {
+        if ( (*it)->running() )
+          ++it;
+        else
+          finishBuild( it++ );
+      }
+      while ( running.size() > keep_r )
+        finishBuild( running.begin() );
+    };
+
+    for ( const RepoInfo & info : retry )
+    {
+      result[info.alias()] = nullptr;
+      try {
+        refreshMetadata( info, policy, ProgressData::ReceiverFnc() );
+
+        reapFinishedBuilds( maxWorkers-1 );
+        // the overall progress goes to progressrcv, each build sends its own ProgressReport
+        shared_ptr<CacheBuild> build( startBuildCache( info, cachePolicy, ProgressData::ReceiverFnc() ) );
+        if ( build )
+          running.push_back( std::move(build) );
+        else
+          progress.incr();
+      }
+      catch ( const Exception & e ) {
+        ZYPP_CAUGHT( e );
+        ERR << "Failed to refresh repo " << info.alias() << endl;
+        result[info.alias()] = std::current_exception();
+        progress.incr();
+      }
+    }
+    reapFinishedBuilds( 0 );
     progress.toMax();
+
+    MIL << "Refreshed repos: " << result.size() << " (failed: " << std::count_if( result.begin(), result.end(), []( const auto & el ) { return bool(el.second); } ) << ")" << endl;
+    return result;
   }
 
   ////////////////////////////////////////////////////////////////////////////
@@ -1276,6 +1500,9 @@ namespace zypp
   void RepoManager::buildCache( const RepoInfo &info, CacheBuildPolicy policy, const ProgressData::ReceiverFnc & progressrcv )
   { return _pimpl->buildCache( info, policy, progressrcv ); }
 
+  RepoManager::RefreshReposResult RepoManager::refreshRepos( const std::vector<RepoInfo> & repos, RawMetadataRefreshPolicy policy, CacheBuildPolicy cachePolicy, unsigned maxWorkers, const ProgressData::ReceiverFnc & progressrcv )
+  { return _pimpl->refreshRepos( repos, policy, cachePolicy, maxWorkers, progressrcv ); }
+
   void RepoManager::cleanCache( const RepoInfo &info, const ProgressData::ReceiverFnc & progressrcv )
   { return _pimpl->cleanCache( info, progressrcv ); }
 
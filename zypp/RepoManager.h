@@ -14,6 +14,9 @@
 
 #include <iosfwd>
 #include <list>
+#include <map>
+#include <vector>
+#include <exception>
 
 #include <zypp/base/PtrTypes.h>
 #include <zypp/base/Iterator.h>
@@ -302,6 +305,32 @@ namespace zypp
                     CacheBuildPolicy policy = BuildIfNeeded,
                     const ProgressData::ReceiverFnc & progressrcv = ProgressData::ReceiverFnc() );
 
+   /** Per repo alias the exception which made \ref refreshRepos fail for this repo.
+    * Repos refreshed successfully are mapped to \c nullptr.
+    */
+   using RefreshReposResult = std::map<std::string, std::exception_ptr>;
+
+   /**
+    * \short Refresh the metadata and build the caches of many repos at once
+    *
+    * Same as calling \ref refreshMetadata and \ref buildCache for each repo in
+    * \a repos, but up to \a maxWorkers repos are downloaded and built at the
+    * same time (\c 0 uses the number of available CPUs).
+    *
+    * Each repo gets its own \ref ProgressReport, \a progressrcv receives the
+    * overall progress. A failing repo does not stop the others, its exception
+    * is remembered in the returned result instead.
+    *
+    * \note User interaction (e.g. to trust a new gpg key) is not possible while
+    * the repos are processed concurrently. Repos failing there are refreshed
+    * once more one after the other, with all the usual callbacks.
+    */
+   RefreshReposResult refreshRepos( const std::vector<RepoInfo> & repos,
+                                    RawMetadataRefreshPolicy policy = RefreshIfNeeded,
+                                    CacheBuildPolicy cachePolicy = BuildIfNeeded,
+                                    unsigned maxWorkers = 0,
+                                    const ProgressData::ReceiverFnc & progressrcv = ProgressData::ReceiverFnc() );
+
    /**
     * \short clean local cache
     *
@@ -18,6 +18,7 @@
 #include <zypp/base/Functional.h>
 
 #include <zypp/ResPoolProxy.h>
+#include <zypp/pool/ItemStatusStore.h>
 #include <zypp/pool/PoolImpl.h>
 #include <zypp/ui/SelectableImpl.h>
 
@@ -32,8 +33,8 @@ namespace zypp
   {
     void saveState( const ResPool& pool_r )
     {
-      std::for_each( pool_r.begin(), pool_r.end(),
-                     std::mem_fn(&PoolItem::saveState) );
+      pool_r.begin();	// assert the pools items are up to date
+      pool::ItemStatusStore::instance().saveState();
     }
 
     void saveState( const ResPool& pool_r, const ResKind & kind_r )
@@ -44,8 +45,8 @@ namespace zypp
 
     void restoreState( const ResPool& pool_r )
     {
-      std::for_each( pool_r.begin(), pool_r.end(),
-                     std::mem_fn(&PoolItem::restoreState) );
+      pool_r.begin();	// assert the pools items are up to date
+      pool::ItemStatusStore::instance().restoreState();
     }
 
     void restoreState( const ResPool& pool_r, const ResKind & kind_r )
@@ -56,9 +57,8 @@ namespace zypp
 
     bool diffState( const ResPool& pool_r ) const
     {
-      // return whether some PoolItem::sameState reported \c false.
-      return( invokeOnEach( pool_r.begin(), pool_r.end(),
-                            std::mem_fn(&PoolItem::sameState) ) < 0 );
+      pool_r.begin();	// assert the pools items are up to date
+      return ! pool::ItemStatusStore::instance().sameState();
     }
 
     bool diffState( const ResPool& pool_r, const ResKind & kind_r ) const
@@ -130,6 +130,37 @@ namespace zypp
       }
     }
 
+    void update( const pool::PoolImpl & poolImpl_r, const std::unordered_set<sat::detail::IdType> & idents_r )
+    {
+      const pool::PoolImpl::Id2ItemT & id2item( poolImpl_r.id2item() );
+      for ( sat::detail::IdType ident : idents_r )
+      {
+        SelectableIndex::iterator it( _selIndex.find( ident ) );
+        if ( it != _selIndex.end() )
+        {
+          auto range = _selPool.equal_range( it->second->kind() );
+          for ( auto pit = range.first; pit != range.second; ++pit )
+          {
+            if ( pit->second == it->second )
+            {
+              _selPool.erase( pit );
+              break;
+            }
+          }
+          _selIndex.erase( it );
+        }
+
+        auto range = id2item.equal_range( ident );
+        if ( range.first != range.second )
+        {
+          ui::Selectable::Ptr p( makeSelectablePtr( range.first, range.second ) );
+          _selPool.insert( SelectablePool::value_type( p->kind(), p ) );
+          _selIndex[ident] = p;
+        }
+      }
+      DBG << "Updated " << idents_r.size() << " Selectables: " << *this << endl;
+    }
+
   public:
     ui::Selectable::Ptr lookup( const pool::ByIdent & ident_r ) const
     {
@@ -259,6 +290,9 @@ namespace zypp
   : _pimpl( new Impl( std::move(pool_r), poolImpl_r ) )
   {}
 
+  void ResPoolProxy::update( const pool::PoolImpl & poolImpl_r, const std::unordered_set<sat::detail::IdType> & idents_r )
+  { _pimpl->update( poolImpl_r, idents_r ); }
+
   ///////////////////////////////////////////////////////////////////
   //
   //	METHOD NAME : ResPoolProxy::~ResPoolProxy
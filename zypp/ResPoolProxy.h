@@ -13,6 +13,7 @@
 #define ZYPP_RESPOOLPROXY_H
 
 #include <iosfwd>
+#include <unordered_set>
 #include <utility>
 
 #include <zypp/base/PtrTypes.h>
@@ -248,6 +249,10 @@ namespace zypp
     friend class pool::PoolImpl;
     /** Ctor */
     ResPoolProxy( ResPool pool_r, const pool::PoolImpl & poolImpl_r );
+    /** Rebuild the Selectables of the changed \a idents_r (\ref pool::PoolImpl::id2item keys).
+     * All other Selectables are kept. Shared by all copies of this proxy.
+     */
+    void update( const pool::PoolImpl & poolImpl_r, const std::unordered_set<sat::detail::IdType> & idents_r );
     /** Pointer to implementation */
     RW_pointer<Impl> _pimpl;
   };
@@ -494,12 +494,15 @@ namespace zypp
         , updateMessagesNotify		( "" )
         , repo_add_probe          	( false )
         , repo_refresh_delay      	( 10 )
+        , repo_searchIndex      	( false )
         , repoLabelIsAlias              ( false )
         , download_use_deltarpm   	( true )
         , download_use_deltarpm_always  ( false )
         , download_media_prefer_download( true )
         , download_mediaMountdir	( "/var/adm/mount" )
         , commit_downloadMode		( DownloadDefault )
+        , commit_downloadParallel	( 5 )
+        , commit_downloadHeapSize	( 100 )
         , gpgCheck			( true )
         , repoGpgCheck			( indeterminate )
         , pkgGpgCheck			( indeterminate )
@@ -583,6 +586,10 @@ namespace zypp
                 {
                   str::strtonum(value, repo_refresh_delay);
                 }
+                else if ( entry == "repo.searchindex" )
+                {
+                  repo_searchIndex = str::strToBool( value, repo_searchIndex );
+                }
                 else if ( entry == "repo.refresh.locales" )
                 {
                   std::vector<std::string> tmp;
@@ -617,6 +624,17 @@ namespace zypp
                 {
                   commit_downloadMode.set( deserializeDownloadMode( value ) );
                 }
+                else if ( entry == "commit.downloadParallel" )
+                {
+                  unsigned tmp = str::strtonum<unsigned>( value );
+                  commit_downloadParallel.set( tmp ? tmp : 1 );
+                }
+                else if ( entry == "commit.downloadHeapSize" )
+                {
+                  unsigned tmp = str::strtonum<unsigned>( value );
+                  if ( tmp )
+                    commit_downloadHeapSize.set( tmp );
+                }
                 else if ( entry == "gpgcheck" )
                 {
                   gpgCheck.restoreToDefault( str::strToBool( value, gpgCheck ) );
@@ -780,6 +798,7 @@ namespace zypp
 
     bool	repo_add_probe;
     unsigned	repo_refresh_delay;
+    bool	repo_searchIndex;
     LocaleSet	repoRefreshLocales;
     bool	repoLabelIsAlias;
 
@@ -789,6 +808,8 @@ namespace zypp
     DefaultOption<Pathname> download_mediaMountdir;
 
     Option<DownloadMode> commit_downloadMode;
+    Option<unsigned>     commit_downloadParallel;
+    Option<unsigned>     commit_downloadHeapSize;
 
     DefaultOption<bool>		gpgCheck;
     DefaultOption<TriBool>	repoGpgCheck;
@@ -1164,6 +1185,9 @@ namespace zypp
   unsigned ZConfig::repo_refresh_delay() const
   { return _pimpl->repo_refresh_delay; }
 
+  bool ZConfig::repo_searchIndex() const
+  { return _pimpl->repo_searchIndex; }
+
   LocaleSet ZConfig::repoRefreshLocales() const
   { return _pimpl->repoRefreshLocales.empty() ? Target::requestedLocales("") :_pimpl->repoRefreshLocales; }
 
@@ -1210,6 +1234,12 @@ namespace zypp
   DownloadMode ZConfig::commit_downloadMode() const
   { return _pimpl->commit_downloadMode; }
 
+  unsigned ZConfig::commit_downloadParallel() const
+  { return _pimpl->commit_downloadParallel; }
+
+  unsigned ZConfig::commit_downloadHeapSize() const
+  { return _pimpl->commit_downloadHeapSize; }
+
 
   bool ZConfig::gpgCheck() const			{ return _pimpl->gpgCheck; }
   TriBool ZConfig::repoGpgCheck() const			{ return _pimpl->repoGpgCheck; }
@@ -264,6 +264,13 @@ namespace zypp
        */
       unsigned repo_refresh_delay() const;
 
+      /**
+       * Whether to build a \ref sat::SearchIndex along with the repos solv file.
+       * It speeds up searching summaries, descriptions and filelists.
+       * Config option <tt>repo.searchindex (false)</tt>
+       */
+      bool repo_searchIndex() const;
+
       /**
        * List of locales for which translated package descriptions should be downloaded.
        */
@@ -355,6 +362,18 @@ namespace zypp
        */
       DownloadMode commit_downloadMode() const;
 
+      /**
+       * Maximum number of packages downloaded in parallel when preloading
+       * the package cache in \ref DownloadInAdvance or \ref DownloadInHeaps
+       * mode. A value of \c 1 restores the traditional serial download.
+       */
+      unsigned commit_downloadParallel() const;
+
+      /**
+       * Number of packages per heap in \ref DownloadInHeaps mode.
+       */
+      unsigned commit_downloadHeapSize() const;
+
       /** \name Signature checking (repodata and packages)
        * If \ref gpgcheck is \c on (the default), we will either check the signature
        * of repo metadata (packages are secured via checksum in the metadata), or the
@@ -79,6 +79,8 @@ namespace zypp
       Impl()
       : _restrictToMedia	( 0 )
       , _downloadMode		( ZConfig::instance().commit_downloadMode() )
+      , _downloadParallel	( ZConfig::instance().commit_downloadParallel() )
+      , _downloadHeapSize	( ZConfig::instance().commit_downloadHeapSize() )
       , _rpmInstFlags		( ZConfig::instance().rpmInstallFlags() )
       , _syncPoolAfterCommit	( true )
       , _singleTransMode        ( singleTransInEnv() )
@@ -87,6 +89,8 @@ namespace zypp
     public:
       unsigned			_restrictToMedia;
       DownloadMode		_downloadMode;
+      unsigned			_downloadParallel;
+      unsigned			_downloadHeapSize;
       target::rpm::RpmInstFlags	_rpmInstFlags;
       bool			_syncPoolAfterCommit;
       bool                      _singleTransMode; //< run everything in one big rpm transaction
@@ -139,6 +143,18 @@ namespace zypp
     return _pimpl->_downloadMode;
   }
 
+  ZYppCommitPolicy & ZYppCommitPolicy::downloadParallel( unsigned val_r )
+  { _pimpl->_downloadParallel = val_r ? val_r : 1; return *this; }
+
+  unsigned ZYppCommitPolicy::downloadParallel() const
+  { return _pimpl->_downloadParallel; }
+
+  ZYppCommitPolicy & ZYppCommitPolicy::downloadHeapSize( unsigned val_r )
+  { _pimpl->_downloadHeapSize = val_r ? val_r : 1; return *this; }
+
+  unsigned ZYppCommitPolicy::downloadHeapSize() const
+  { return _pimpl->_downloadHeapSize; }
+
   ZYppCommitPolicy &  ZYppCommitPolicy::rpmInstFlags( target::rpm::RpmInstFlags newFlags_r )
   { _pimpl->_rpmInstFlags = newFlags_r; return *this; }
 
@@ -186,6 +202,8 @@ namespace zypp
     if ( obj.dryRun() )
       str << " dryRun";
     str << " " << obj.downloadMode();
+    if ( obj.downloadParallel() > 1 )
+      str << " downloadParallel:" << obj.downloadParallel();
     if ( obj.syncPoolAfterCommit() )
       str << " syncPoolAfterCommit";
     if ( obj.rpmInstFlags() )
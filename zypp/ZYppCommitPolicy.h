@@ -69,6 +69,23 @@ namespace zypp
       DownloadMode downloadMode() const;
 
 
+      /** Maximum number of packages downloaded in parallel when preloading
+       * the package cache. (default: zypp.conf \c commit.downloadParallel)
+       * \note A value of \c 0 or \c 1 restores the serial download.
+       */
+      ZYppCommitPolicy & downloadParallel( unsigned val_r );
+
+      unsigned downloadParallel() const;
+
+
+      /** Number of packages per heap in \ref DownloadInHeaps mode.
+       * (default: zypp.conf \c commit.downloadHeapSize)
+       */
+      ZYppCommitPolicy & downloadHeapSize( unsigned val_r );
+
+      unsigned downloadHeapSize() const;
+
+
       /** The default \ref target::rpm::RpmInstFlags. (default: none)*/
       ZYppCommitPolicy &  rpmInstFlags( target::rpm::RpmInstFlags newFlags_r );
 
@@ -429,6 +429,8 @@ void MediaCurl::setupEasy()
 
   SET_OPTION(CURLOPT_FAILONERROR, 1L);
   SET_OPTION(CURLOPT_NOSIGNAL, 1L);
+  // share DNS cache, TLS sessions and connections with all other handles
+  SET_OPTION(CURLOPT_SHARE, ::internal::curlShareHandle());
 
   // create non persistant settings
   // so that we don't add headers twice
@@ -33,6 +33,7 @@
 #include <zypp-curl/parser/MetaLinkParser>
 #include <zypp-curl/parser/zsyncparser.h>
 #include <zypp-curl/private/curlhelper_p.h>
+#include <zypp-curl/private/mirrorstats_p.h>
 #include <zypp-curl/auth/CurlAuthData>
 #include <zypp-curl/parser/metadatahelper.h>
 #include <zypp-curl/ng/network/curlmultiparthandler.h>
@@ -1024,6 +1025,7 @@ multifetchrequest::multifetchrequest(const MediaMultiCurl *context, Pathname fil
 multifetchrequest::~multifetchrequest()
 {
   _workers.clear();
+  MirrorStats::instance().save();
 }
 
 void
@@ -1187,11 +1189,21 @@ multifetchrequest::run(std::vector<Url> &urllist)
           if (curl_easy_getinfo(easy, CURLINFO_PRIVATE, &worker) != CURLE_OK)
             ZYPP_THROW(MediaCurlException(_baseurl, "curl_easy_getinfo", "unknown error"));
 
+          const std::string statsKey { MirrorStats::makeKey( worker->_url ) };
           if (worker->_datareceived && now > worker->_starttime) {
             if (worker->_avgspeed)
               worker->_avgspeed = (worker->_avgspeed + worker->_datareceived / (now - worker->_starttime)) / 2;
             else
               worker->_avgspeed = worker->_datareceived / (now - worker->_starttime);
+            MirrorStats::instance().recordThroughput( statsKey, worker->_datareceived, now - worker->_starttime );
+          }
+          {
+            // connect time is 0 if a connection was reused
+            double connectTime = 0, lookupTime = 0;
+            if ( curl_easy_getinfo( easy, CURLINFO_CONNECT_TIME, &connectTime ) == CURLE_OK
+                 && curl_easy_getinfo( easy, CURLINFO_NAMELOOKUP_TIME, &lookupTime ) == CURLE_OK
+                 && connectTime > lookupTime )
+              MirrorStats::instance().recordLatency( statsKey, ( connectTime - lookupTime ) * 1000 );
           }
 
           XXX << "#" << worker->_workerno << " done code " << cc << " speed " << worker->_avgspeed << endl;
@@ -1199,6 +1211,7 @@ multifetchrequest::run(std::vector<Url> &urllist)
 
           const auto &setWorkerBroken = [&]( const std::string &str = {} ){
             worker->_state = WORKER_BROKEN;
+            MirrorStats::instance().recordFailure( statsKey );
             if ( !str.empty () )
               strncpy(worker->_curlError, str.c_str(), CURL_ERROR_SIZE);
             _activeworkers--;
@@ -1247,6 +1260,7 @@ multifetchrequest::run(std::vector<Url> &urllist)
               setWorkerBroken();
               continue;
             }
+            MirrorStats::instance().recordSuccess( statsKey );
 
             // from here on we know THIS worker only got data that verified
             // now lets see if the stripe was finished too
@@ -1773,6 +1787,23 @@ void MediaMultiCurl::multifetch(const Pathname & filename, FILE *fp, std::vector
     }
   if (!myurllist.size())
     myurllist.push_back(baseurl);
+  else
+    {
+      // Workers are started in list order, so start with the mirrors which
+      // performed best in the past.
+      MirrorStats & stats { MirrorStats::instance() };
+      if ( stats.statsFile().empty() )
+        stats.setStatsFile( ZConfig::instance().repoCachePath() / "mirrorstats" );
+      std::vector<std::pair<double,Url>> rated;
+      rated.reserve( myurllist.size() );
+      for ( Url & url : myurllist )
+        rated.emplace_back( stats.cost( MirrorStats::makeKey( url ) ), std::move(url) );
+      std::stable_sort( rated.begin(), rated.end(), []( const auto & lhs, const auto & rhs ) { return lhs.first < rhs.first; } );
+      myurllist.clear();
+      for ( auto & el : rated )
+        myurllist.push_back( std::move(el.second) );
+      XXX << "Mirrors by past performance: " << myurllist.front() << " ... " << myurllist.back() << endl;
+    }
   req.run(myurllist);
   checkFileDigest(baseurl, fp, req.blockList() );
 }
@@ -27,6 +27,8 @@
 #include <zypp-curl/ng/network/Downloader>
 #include <zypp-curl/ng/network/NetworkRequestDispatcher>
 #include <zypp-curl/ng/network/DownloadSpec>
+#include <zypp-curl/private/zckchunkstore_p.h>
+#include <zypp-curl/private/mirrorstats_p.h>
 
 #include <zypp-media/MediaConfig>
 #include <zypp/media/MediaNetwork.h>
@@ -152,6 +154,10 @@ namespace internal {
         _dispatcher = zyppng::ThreadData::current().ensureDispatcher();
         _downloader = std::make_shared<zyppng::Downloader>();
         _downloader->requestDispatcher()->setMaximumConcurrentConnections( zypp::MediaConfig::instance().download_max_concurrent_connections() );
+        // zchunk chunks are shared by all repos
+        zypp::media::ZckChunkStore::instance().setStoreDir( zypp::ZConfig::instance().repoCachePath() / "zck-chunks" );
+        // the downloaders MirrorControl remembers the mirror performance across processes
+        zypp::media::MirrorStats::instance().setStatsFile( zypp::ZConfig::instance().repoCachePath() / "mirrorstats" );
       }
   };
 
@@ -34,6 +34,12 @@ namespace zyppng::repo {
     RefreshIfNeededIgnoreDelay
   };
 
+  enum CacheBuildPolicy
+  {
+    BuildIfNeeded,
+    BuildForced
+  };
+
   /**
    * Possibly return state of checkIfRefreshMEtadata function
    */
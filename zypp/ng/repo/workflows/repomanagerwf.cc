@@ -10,11 +10,23 @@
 
 #include <zypp-core/ManagedFile.h>
 #include <utility>
+#include <future>
+#include <zypp-core/zyppng/base/EventDispatcher>
+#include <zypp-core/zyppng/base/SocketNotifier>
+#include <zypp-core/zyppng/io/Process>
+#include <zypp-core/zyppng/thread/Wakeup>
 #include <zypp-core/zyppng/pipelines/MTry>
+#include <zypp-core/zyppng/ui/ProgressObserver>
 #include <zypp-media/MediaException>
 #include <zypp-media/ng/Provide>
 #include <zypp-media/ng/ProvideSpec>
 
+#include <zypp/ExternalProgram.h>
+#include <zypp/ZConfig.h>
+#include <zypp/sat/Pool.h>
+#include <zypp/sat/SearchIndex.h>
+#include <zypp/zypp_detail/repo2solv_p.h>
+
 #include <zypp/ng/Context>
 #include <zypp/ng/workflows/logichelpers.h>
 #include <zypp/ng/workflows/contextfacade.h>
@@ -538,4 +550,451 @@ namespace zyppng {
       return SimpleExecutor<RefreshMetadataLogic, SyncOp<expected<repo::SyncRefreshContextRef>>>::run( std::move(refCtx), std::move(medium), std::move(progressObserver));
     }
   }
+
+  namespace {
+
+    /*!
+     * A repo2solv run building the solv file of a repo.
+     */
+    struct Repo2SolvJob
+    {
+      zypp::RepoInfo           _info;
+      zypp::repo::RepoType     _repokind;
+      zypp::Pathname           _productdatapath;
+      zypp::ManagedFile        _solvfile;	///< unlinked unless the build succeeds
+      std::vector<std::string> _cmd;	///< repo2solv commandline
+
+      /** Whether the rpm-md metadata are parsed in-process first (see \ref zypp::repo2solvRpmmd). */
+      bool inProcess() const
+      { return _repokind == zypp::repo::RepoType::RPMMD && ! zypp::env::ZYPP_REPO2SOLV_EXTERNAL(); }
+
+      /** The exception to report if repo2solv returned \a ret_r. */
+      std::exception_ptr error( int ret_r, const std::string & errdetail_r, const std::string & execError_r ) const
+      {
+        zypp::repo::RepoException ex( _info, zypp::str::form( _("Failed to cache repo (%d)."), ret_r ) );
+        ex.addHistory( zypp::str::Str() << zypp::str::join( _cmd, " " ) << std::endl << errdetail_r << execError_r ); // errdetail lines are NL-terminaled!
+        return ZYPP_EXCPT_PTR( ex );
+      }
+    };
+
+    /*!
+     * Runs a \ref Repo2SolvJob without blocking the event loop. The in-process build runs in
+     * a separate thread, the external repo2solv as a \ref Process.
+     */
+    struct AsyncRepo2SolvOp : public AsyncOp<expected<void>>
+    {
+      AsyncRepo2SolvOp( Repo2SolvJob & job_r )
+        : _job( job_r )
+      {}
+
+      void execute() {
+        if ( !_job.inProcess() ) {
+          startProcess();
+          return;
+        }
+
+        _notifier = _wakeup.makeNotifier();
+        _notifier->connectFunc( &SocketNotifier::sigActivated, [this]( const SocketNotifier &, int ) {
+          _wakeup.ack();
+          // we are called from the notifier, keep it alive until we return
+          EventDispatcher::unrefLater( std::move(_notifier) );
+          try {
+            _builder.get();
+            setReady( expected<void>::success() );
+            return;
+          }
+          catch ( const zypp::Exception & excpt ) {
+            ZYPP_CAUGHT( excpt );
+            WAR << _job._info.alias() << ": in-process cache build failed. Fallback to " << _job._cmd[0] << std::endl;
+          }
+          startProcess();
+        });
+
+        _builder = std::async( std::launch::async, [this]() {
+          try {
+            zypp::repo2solvRpmmd( _job._productdatapath, _job._solvfile.value() );
+          }
+          catch ( ... ) {
+            _wakeup.notify();
+            throw;
+          }
+          _wakeup.notify();
+        });
+      }
+
+    private:
+      void startProcess() {
+        std::vector<const char *> argv;
+        argv.reserve( _job._cmd.size() + 1 );
+        for ( const std::string & arg : _job._cmd )
+          argv.push_back( arg.c_str() );
+        argv.push_back( nullptr );
+
+        _proc = Process::create();
+        _proc->setOutputChannelMode( Process::Merged );
+        _proc->connectFunc( &IODevice::sigChannelReadyRead, [this]( uint ) { readOutput(); } );
+        _proc->connectFunc( &Process::sigFinished, [this]( int ret ) {
+          readOutput();
+          // we are called from the process, keep it alive until we return
+          EventDispatcher::unrefLater( _proc );
+          if ( ret != 0 )
+            setReady( expected<void>::error( _job.error( ret, _errdetail, _proc->execError() ) ) );
+          else
+            setReady( expected<void>::success() );
+        });
+
+        if ( !_proc->start( argv.data() ) )
+          setReady( expected<void>::error( _job.error( _proc->exitStatus(), _errdetail, _proc->execError() ) ) );
+      }
+
+      void readOutput() {
+        while ( _proc->canReadLine( Process::StdOut ) ) {
+          const std::string & output { _proc->channelReadLine( Process::StdOut ).asString() };
+          WAR << "  " << output;
+          _errdetail += output;
+        }
+      }
+
+      Repo2SolvJob &      _job;
+      Wakeup              _wakeup;
+      SocketNotifier::Ptr _notifier;
+      std::future<void>   _builder;	///< in-process repo2solv, must be destroyed before \ref _wakeup
+      Process::Ptr        _proc;	///< external repo2solv
+      std::string         _errdetail;
+    };
+
+    template<typename Executor, class OpType>
+    struct BuildCacheLogic : public LogicBase<Executor, OpType>{
+
+      ZYPP_ENABLE_LOGIC_BASE(Executor, OpType);
+
+    public:
+
+      using RefreshContextRefType = std::conditional_t<zyppng::detail::is_async_op_v<OpType>, repo::AsyncRefreshContextRef, repo::SyncRefreshContextRef>;
+      using ZyppContextRefType = typename RefreshContextRefType::element_type::ContextRefType;
+      using ZyppContextType    = typename RefreshContextRefType::element_type::ContextType;
+      using ProvideType        = typename ZyppContextType::ProvideType;
+      using MediaHandle        = typename ProvideType::MediaHandle;
+
+      BuildCacheLogic( RefreshContextRefType &&refCtx, repo::CacheBuildPolicy policy, ProgressObserverRef &&progressObserver )
+        : _refreshContext(std::move(refCtx))
+        , _policy( policy )
+        , _progress ( std::move( progressObserver ) )
+      {}
+
+      MaybeAsyncRef<expected<RefreshContextRefType>> execute() {
+
+        return mtry( &BuildCacheLogic::prepare, this )
+        | and_then( [this]() {
+          if ( !_job || _job->_repokind != zypp::repo::RepoType::RPMPLAINDIR )
+            return makeReadyResult( expected<void>::success() );
+
+          // plaindir repos are read in place
+          return _refreshContext->zyppContext()->provider()->attachMedia( _job->_info.url(), ProvideMediaSpec() )
+          | and_then( [this]( MediaHandle &&medium ) {
+            if ( !medium.localPath().has_value() )
+              return expected<void>::error( ZYPP_EXCPT_PTR( zypp::Exception("Medium does not support plaindir") ) );
+            // recusive for plaindir as 2nd arg!
+            _job->_cmd.push_back( "-R" );
+            _job->_cmd.push_back( ( medium.localPath().value() / _job->_info.path() ).asString() );
+            _forPlainDirs = std::move(medium);
+            return expected<void>::success();
+          });
+        })
+        | and_then( [this]() {
+          if ( !_job )
+            return makeReadyResult( expected<void>::success() );
+          return executor()->runRepo2Solv( *_job );
+        })
+        | and_then( [this]() {
+          return mtry( &BuildCacheLogic::commit, this );
+        })
+        | and_then( [this]() {
+          if ( _progress ) _progress->setFinished();
+          return expected<RefreshContextRefType>::success( std::move(_refreshContext) );
+        });
+      }
+
+    private:
+      /** Check the cache status and set up the \ref Repo2SolvJob if a build is needed. */
+      void prepare() {
+        const zypp::RepoInfo & info = _refreshContext->repoInfo();
+        const zypp::RepoManagerOptions & options = _refreshContext->repoManagerOptions();
+        zypp::assert_alias(info);
+
+        if( zypp::filesystem::assert_dir(options.repoCachePath) )
+          ZYPP_THROW( zypp::Exception(zypp::str::form( _("Can't create %s"), options.repoCachePath.c_str()) ) );
+
+        _rawMetadataStatus = zypp::RepoManagerBaseImpl::metadataStatus( info, options );
+        if ( _rawMetadataStatus.empty() )
+          ZYPP_THROW( zypp::repo::RepoMetadataException( info ) );
+
+        const zypp::Pathname & base = zypp::solv_path_for_repoinfo( options, info );
+        if ( zypp::PathInfo( base/"solv" ).isExist() )
+        {
+          MIL << info.alias() << " is already cached." << std::endl;
+          if ( zypp::RepoManagerBaseImpl::cacheStatus( info, options ) == _rawMetadataStatus )
+          {
+            MIL << info.alias() << " cache is up to date with metadata." << std::endl;
+            if ( _policy == repo::BuildIfNeeded )
+            {
+              // On the fly add missing solv.idx files for bash completion.
+              if ( ! zypp::PathInfo(base/"solv.idx").isExist() )
+                zypp::sat::updateSolvFileIndex( base/"solv" );
+              if ( _refreshContext->zyppContext()->config().repo_searchIndex() && ! zypp::PathInfo( zypp::sat::SearchIndex::indexFile( base/"solv" ) ).isExist() )
+                zypp::sat::SearchIndex::build( base/"solv" );
+              return;
+            }
+            else {
+              MIL << info.alias() << " cache rebuild is forced" << std::endl;
+            }
+          }
+          MIL << "Removing raw metadata cache for " << info.alias() << std::endl;
+          zypp::filesystem::recursive_rmdir( base );
+        }
+
+        if ( _progress ) {
+          auto sub = ProgressObserver::create( zypp::str::form(_("Building repository '%s' cache"), info.label().c_str()) );
+          _progress->registerSubTask( sub );
+          _progress = std::move(sub);
+        }
+
+        MIL << info.alias() << " building cache..." << info.type() << std::endl;
+
+        if( zypp::filesystem::assert_dir(base) )
+          ZYPP_THROW( zypp::Exception(zypp::str::form( _("Can't create %s"), base.c_str()) ) );
+
+        if( ! zypp::PathInfo(base).userMayW() )
+          ZYPP_THROW( zypp::Exception(zypp::str::form( _("Can't create cache at %s - no writing permissions."), base.c_str()) ) );
+
+        Repo2SolvJob job;
+        job._info = info;
+        job._productdatapath = zypp::rawproductdata_path_for_repoinfo( options, info );
+
+        // if the type is unknown, try probing.
+        job._repokind = info.type();
+        if ( job._repokind.toEnum() == zypp::repo::RepoType::NONE_e )
+          job._repokind = zypp::RepoManagerBaseImpl::probeCache( job._productdatapath );
+        MIL << "repo type is " << job._repokind << std::endl;
+
+        switch ( job._repokind.toEnum() )
+        {
+          case zypp::repo::RepoType::RPMMD_e :
+          case zypp::repo::RepoType::YAST2_e :
+          case zypp::repo::RepoType::RPMPLAINDIR_e :
+            break;
+          default:
+            ZYPP_THROW( zypp::repo::RepoUnknownTypeException( info, _("Unhandled repository type") ) );
+        }
+
+        // Take care we unlink the solvfile on exception
+        job._solvfile = zypp::ManagedFile( base / "solv", zypp::filesystem::unlink );
+
+        job._cmd.push_back( zypp::PathInfo( "/usr/bin/repo2solv" ).isFile() ? "repo2solv" : "repo2solv.sh" );
+        // repo2solv expects -o as 1st arg!
+        job._cmd.push_back( "-o" );
+        job._cmd.push_back( job._solvfile.value().asString() );
+        job._cmd.push_back( "-X" );	// autogenerate pattern from pattern-package
+        if ( job._repokind != zypp::repo::RepoType::RPMPLAINDIR )
+          job._cmd.push_back( job._productdatapath.asString() );
+
+        _job = std::move(job);
+      }
+
+      /** Keep the solv file and update the cache status. */
+      void commit() {
+        if ( !_job )
+          return;
+        _forPlainDirs.reset();
+
+        // We keep it.
+        _job->_solvfile.resetDispose();
+        zypp::sat::updateSolvFileIndex( _job->_solvfile.value() );	// content digest for zypper bash completion
+        if ( _refreshContext->zyppContext()->config().repo_searchIndex() )
+          zypp::sat::SearchIndex::build( _job->_solvfile.value() );
+
+        // update timestamp and checksum
+        const zypp::Pathname & base = zypp::solv_path_for_repoinfo( _refreshContext->repoManagerOptions(), _job->_info );
+        zypp::filesystem::assert_dir( base );
+        _rawMetadataStatus.saveToCookieFile( base / "cookie" );
+        MIL << "Commit cache.." << std::endl;
+      }
+
+    protected:
+      RefreshContextRefType _refreshContext;
+      repo::CacheBuildPolicy _policy;
+      ProgressObserverRef _progress;
+      zypp::RepoStatus _rawMetadataStatus;
+      std::optional<Repo2SolvJob> _job;
+      std::optional<MediaHandle> _forPlainDirs;
+    };
+
+    struct AsyncBuildCacheExecutor : public BuildCacheLogic<AsyncBuildCacheExecutor, AsyncOp<expected<repo::AsyncRefreshContextRef>>>
+    {
+      using BuildCacheLogic::BuildCacheLogic;
+
+      AsyncOpRef<expected<void>> runRepo2Solv( Repo2SolvJob & job_r ) {
+        auto op = std::make_shared<AsyncRepo2SolvOp>( job_r );
+        op->execute();
+        return op;
+      }
+    };
+
+    struct SyncBuildCacheExecutor : public BuildCacheLogic<SyncBuildCacheExecutor, SyncOp<expected<repo::SyncRefreshContextRef>>>
+    {
+      using BuildCacheLogic::BuildCacheLogic;
+
+      expected<void> runRepo2Solv( Repo2SolvJob & job_r ) {
+        if ( job_r.inProcess() ) {
+          try {
+            zypp::repo2solvRpmmd( job_r._productdatapath, job_r._solvfile.value() );
+            return expected<void>::success();
+          }
+          catch ( const zypp::Exception & excpt ) {
+            ZYPP_CAUGHT( excpt );
+            WAR << job_r._info.alias() << ": in-process cache build failed. Fallback to " << job_r._cmd[0] << std::endl;
+          }
+        }
+
+        zypp::ExternalProgram prog( job_r._cmd, zypp::ExternalProgram::Stderr_To_Stdout );
+        std::string errdetail;
+        for ( std::string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
+          WAR << "  " << output;
+          errdetail += output;
+        }
+
+        int ret = prog.close();
+        if ( ret != 0 )
+          return expected<void>::error( job_r.error( ret, errdetail, prog.execError() ) );
+        return expected<void>::success();
+      }
+    };
+  }
+
+  namespace RepoManagerWorkflow {
+    AsyncOpRef<expected<repo::AsyncRefreshContextRef> > buildCache( repo::AsyncRefreshContextRef refCtx, repo::CacheBuildPolicy policy, ProgressObserverRef progressObserver )
+    {
+      return AsyncBuildCacheExecutor::run( std::move(refCtx), policy, std::move(progressObserver) );
+    }
+
+    expected<repo::SyncRefreshContextRef> buildCache( repo::SyncRefreshContextRef refCtx, repo::CacheBuildPolicy policy, ProgressObserverRef progressObserver )
+    {
+      return SyncBuildCacheExecutor::run( std::move(refCtx), policy, std::move(progressObserver) );
+    }
+  }
+
+  namespace {
+
+    /*!
+     * Runs the refresh and cache build pipelines of many repos, at most \a maxWorkers at the
+     * same time. The results are collected in the order of the passed repos.
+     */
+    struct RefreshReposLogic : public AsyncOp<std::vector<expected<repo::AsyncRefreshContextRef>>>
+    {
+      using RefreshRes = expected<repo::AsyncRefreshContextRef>;
+
+      RefreshReposLogic( ContextRef &&ctx, std::vector<zypp::RepoInfo> &&infos, zypp::RepoManagerOptions &&options, repo::RawMetadataRefreshPolicy policy, repo::CacheBuildPolicy cachePolicy, unsigned maxWorkers, ProgressObserverRef &&progressObserver )
+        : _ctx( std::move(ctx) )
+        , _infos( std::move(infos) )
+        , _options( std::move(options) )
+        , _policy( policy )
+        , _cachePolicy( cachePolicy )
+        , _maxWorkers( maxWorkers ? maxWorkers : 1 )
+        , _progress( std::move(progressObserver) )
+        , _ops( _infos.size() )
+        , _results( _infos.size() )
+      {}
+
+      void execute() {
+        MIL << "Refreshing " << _infos.size() << " repos, " << _maxWorkers << " at a time" << std::endl;
+        startNext();
+      }
+
+    private:
+      void startNext() {
+        // results may be ready right away, don't recurse in that case
+        if ( _scheduling )
+          return;
+        _scheduling = true;
+
+        while ( _running < _maxWorkers && _next < _infos.size() ) {
+          const auto idx = _next++;
+          ++_running;
+
+          ProgressObserverRef subProgress;
+          if ( _progress ) {
+            subProgress = ProgressObserver::create( _infos[idx].label() );
+            _progress->registerSubTask( subProgress );
+          }
+
+          _ops[idx] = repo::AsyncRefreshContext::create( _ctx, _infos[idx], _options )
+            | and_then( [ this, subProgress ]( repo::AsyncRefreshContextRef &&refCtx ) {
+              refCtx->setPolicy( _policy );
+              const auto &urls = refCtx->repoInfo().baseUrls();
+              return _ctx->provider()->attachMedia( std::vector<zypp::Url>( urls.begin(), urls.end() ), ProvideMediaSpec() )
+                | and_then( [ refCtx, subProgress ]( ProvideMediaHandle medium ) mutable {
+                  return RepoManagerWorkflow::refreshMetadata( std::move(refCtx), std::move(medium), subProgress );
+                });
+            })
+            | and_then( [ this, subProgress ]( repo::AsyncRefreshContextRef &&refCtx ) {
+              return RepoManagerWorkflow::buildCache( std::move(refCtx), _cachePolicy, subProgress );
+            });
+
+          _ops[idx]->onReady( [ this, idx, subProgress ]( RefreshRes &&res ) {
+            if ( subProgress )
+              subProgress->setFinished();
+            if ( !res ) {
+              try {
+                std::rethrow_exception( res.error() );
+              } catch ( const zypp::Exception &e ) {
+                ZYPP_CAUGHT( e );
+              } catch ( ... ) {}
+              ERR << "Failed to refresh repo " << _infos[idx].alias() << std::endl;
+            }
+            _results[idx] = std::move(res);
+            --_running;
+            ++_done;
+            startNext();
+          });
+        }
+
+        _scheduling = false;
+        if ( _done == _infos.size() ) {
+          // We are called from the ready callback of the last op. Destroying
+          // it here would free the callback that is still running, so keep
+          // the ops alive until we return.
+          auto finishedOps = std::move(_ops);
+          std::vector<RefreshRes> results;
+          results.reserve( _results.size() );
+          for ( auto &res : _results )
+            results.push_back( std::move(*res) );
+          setReady( std::move(results) );
+        }
+      }
+
+      ContextRef _ctx;
+      std::vector<zypp::RepoInfo> _infos;
+      zypp::RepoManagerOptions _options;
+      repo::RawMetadataRefreshPolicy _policy;
+      repo::CacheBuildPolicy _cachePolicy;
+      unsigned _maxWorkers;
+      ProgressObserverRef _progress;
+
+      std::vector<AsyncOpRef<RefreshRes>> _ops;
+      std::vector<std::optional<RefreshRes>> _results;  ///< expected is not default constructible
+      std::size_t _next    = 0;
+      std::size_t _running = 0;
+      std::size_t _done    = 0;
+      bool _scheduling     = false;
+    };
+  }
+
+  namespace RepoManagerWorkflow {
+    AsyncOpRef<std::vector<expected<repo::AsyncRefreshContextRef>>> refreshRepos( ContextRef ctx, std::vector<zypp::RepoInfo> infos, zypp::RepoManagerOptions options, repo::RawMetadataRefreshPolicy policy, repo::CacheBuildPolicy cachePolicy, unsigned maxWorkers, ProgressObserverRef progressObserver )
+    {
+      auto op = std::make_shared<RefreshReposLogic>( std::move(ctx), std::move(infos), std::move(options), policy, cachePolicy, maxWorkers, std::move(progressObserver) );
+      op->execute();
+      return op;
+    }
+  }
 }
@@ -42,8 +42,21 @@ namespace zyppng {
     AsyncOpRef<expected<repo::AsyncRefreshContextRef> > refreshMetadata( repo::AsyncRefreshContextRef refCtx, ProvideMediaHandle medium, ProgressObserverRef progressObserver = nullptr );
     expected<repo::SyncRefreshContextRef> refreshMetadata( repo::SyncRefreshContextRef refCtx, SyncMediaHandle medium, ProgressObserverRef progressObserver = nullptr );
 
-    AsyncOpRef<expected<repo::AsyncRefreshContextRef> > buildCache( repo::AsyncRefreshContextRef refCtx, ProgressObserverRef progressObserver = nullptr );
-    expected<repo::SyncRefreshContextRef> buildCache( repo::SyncRefreshContextRef refCtx, ProgressObserverRef progressObserver = nullptr );
+    /*!
+     * Builds the solv file of the repo from its raw metadata cache, unless it is up to date
+     * and \a policy is \ref repo::BuildIfNeeded. The solv.idx and the search index are updated
+     * along with it.
+     */
+    AsyncOpRef<expected<repo::AsyncRefreshContextRef> > buildCache( repo::AsyncRefreshContextRef refCtx, repo::CacheBuildPolicy policy, ProgressObserverRef progressObserver = nullptr );
+    expected<repo::SyncRefreshContextRef> buildCache( repo::SyncRefreshContextRef refCtx, repo::CacheBuildPolicy policy, ProgressObserverRef progressObserver = nullptr );
+
+    /*!
+     * Refreshes the metadata and builds the solv caches of all repos in \a infos concurrently,
+     * running at most \a maxWorkers repos at the same time. Each repo is registered as its own
+     * subtask of \a progressObserver and gets its own result, the results are returned in the
+     * order of \a infos. A failing repo does not stop the others.
+     */
+    AsyncOpRef<std::vector<expected<repo::AsyncRefreshContextRef>>> refreshRepos( ContextRef ctx, std::vector<zypp::RepoInfo> infos, zypp::RepoManagerOptions options, repo::RawMetadataRefreshPolicy policy = repo::RefreshIfNeeded, repo::CacheBuildPolicy cachePolicy = repo::BuildIfNeeded, unsigned maxWorkers = 5, ProgressObserverRef progressObserver = nullptr );
 
   }
 }
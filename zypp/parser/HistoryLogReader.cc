@@ -10,10 +10,23 @@
 /** \file HistoryLogReader.cc
  *
  */
+extern "C"
+{
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+}
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <iterator>
+#include <string_view>
 
 #include <utility>
 #include <zypp-core/base/InputStream>
+#include <zypp-core/AutoDispose.h>
 #include <zypp/base/IOStream.h>
 #include <zypp/base/Logger.h>
 #include <zypp-core/parser/ParseException>
@@ -28,6 +41,104 @@ namespace zypp
   ///////////////////////////////////////////////////////////////////
   namespace parser
   {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      ///////////////////////////////////////////////////////////////////
+      /// \class HistoryFile
+      /// \brief The history file content, \c mmap'ed if possible.
+      ///
+      /// Compressed files (or files we can't map) are read into memory
+      /// via \ref InputStream.
+      ///////////////////////////////////////////////////////////////////
+      class HistoryFile : private base::NonCopyable
+      {
+      public:
+        HistoryFile( const Pathname & file_r )
+        {
+          if ( ! map( file_r ) )
+          {
+            InputStream is( file_r );
+            _buffer.assign( std::istreambuf_iterator<char>( is.stream() ), std::istreambuf_iterator<char>() );
+            _data = _buffer;
+          }
+        }
+
+        ~HistoryFile()
+        {
+          if ( _addr )
+            ::munmap( _addr, _data.size() );
+        }
+
+        std::string_view data() const
+        { return _data; }
+
+        /** Start of the line containing \a pos_r. */
+        std::string_view::size_type lineBegin( std::string_view::size_type pos_r ) const
+        {
+          while ( pos_r && _data[pos_r-1] != '\n' )
+            --pos_r;
+          return pos_r;
+        }
+
+        /** Start of the line behind the line containing \a pos_r (or \c size). */
+        std::string_view::size_type nextLine( std::string_view::size_type pos_r ) const
+        {
+          pos_r = _data.find( '\n', pos_r );
+          return pos_r == std::string_view::npos ? _data.size() : pos_r + 1;
+        }
+
+        /** The line starting at \a pos_r (without newline). */
+        std::string_view line( std::string_view::size_type pos_r ) const
+        {
+          std::string_view::size_type end = _data.find( '\n', pos_r );
+          return _data.substr( pos_r, end == std::string_view::npos ? end : end - pos_r );
+        }
+
+        /** The line number of \a pos_r (counted on demand, for messages). */
+        unsigned lineNo( std::string_view::size_type pos_r ) const
+        { return 1 + std::count( _data.begin(), _data.begin() + pos_r, '\n' ); }
+
+      private:
+        bool map( const Pathname & file_r )
+        {
+          AutoFD fd { ::open( file_r.c_str(), O_RDONLY | O_CLOEXEC ) };
+          if ( fd == -1 )
+            return false;
+          struct stat st;
+          if ( ::fstat( fd, &st ) != 0 || ! S_ISREG(st.st_mode) || st.st_size == 0 )
+            return false;
+
+          // let InputStream handle compressed files
+          char magic[4] = { 0, 0, 0, 0 };
+          if ( ::pread( fd, magic, sizeof(magic), 0 ) >= 2
+               && ( ( magic[0] == '\x1f' && magic[1] == '\x8b' )				// gzip
+                    || ::memcmp( magic, "\x28\xb5\x2f\xfd", sizeof(magic) ) == 0 ) )	// zstd
+            return false;
+
+          void * addr = ::mmap( nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+          if ( addr == MAP_FAILED )
+            return false;
+          _addr = addr;
+          _data = std::string_view( static_cast<const char *>( addr ), st.st_size );
+          return true;
+        }
+
+      private:
+        void * _addr = nullptr;
+        std::string _buffer;
+        std::string_view _data;
+      };
+
+      /** The date field of a history line, empty if the line does not start with a date. */
+      inline std::string_view dateField( std::string_view line_r )
+      {
+        if ( line_r.empty() || line_r[0] < '1' || '9' < line_r[0] )
+          return std::string_view();
+        return line_r.substr( 0, line_r.find( '|' ) );
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
 
   /////////////////////////////////////////////////////////////////////
   //
@@ -36,18 +147,27 @@ namespace zypp
   /////////////////////////////////////////////////////////////////////
   struct HistoryLogReader::Impl
   {
+    using size_type = std::string_view::size_type;
+
     Impl( Pathname &&historyFile_r, Options &&options_r, ProcessData &&callback_r )
     :  _filename( std::move(historyFile_r) )
     , _options( std::move(options_r) )
     , _callback( std::move(callback_r) )
     {}
 
-    bool parseLine( const std::string & line_r, unsigned int lineNr_r );
+    bool parseLine( const HistoryFile & file_r, size_type pos_r );
 
     void readAll( const ProgressData::ReceiverFnc & progress_r );
+    void readAllReverse( const ProgressData::ReceiverFnc & progress_r );
     void readFrom( const Date & date_r, const ProgressData::ReceiverFnc & progress_r );
     void readFromTo( const Date & fromDate_r, const Date & toDate_r, const ProgressData::ReceiverFnc & progress_r );
 
+    /** Start of the first dated line with a date not before \a key_r (or behind it if \a behind_r). */
+    size_type seek( const HistoryFile & file_r, const std::string & key_r, bool behind_r ) const;
+
+    /** Parse the lines in <tt>[pos_r,end_r)</tt>. */
+    void readRange( const HistoryFile & file_r, size_type pos_r, size_type end_r, const ProgressData::ReceiverFnc & progress_r );
+
     void addActionFilter( const HistoryActionID & action_r )
     {
       if ( action_r == HistoryActionID::NONE )
@@ -59,17 +179,53 @@ namespace zypp
     Pathname _filename;
     Options  _options;
     ProcessData _callback;
-    std::set<std::string> _actionfilter;
+    std::set<std::string,std::less<>> _actionfilter;
   };
 
-  bool HistoryLogReader::Impl::parseLine( const std::string & line_r, unsigned lineNr_r )
+  bool HistoryLogReader::Impl::parseLine( const HistoryFile & file_r, size_type pos_r )
   {
-    // parse into fields
+    std::string_view view { file_r.line( pos_r ) };
+
+    // ignore comments
+    if ( ! view.empty() && view[0] == '#' )
+      return true;
+
+    // check the action filter before splitting the whole line
+    if ( ! _actionfilter.empty() )
+    {
+      size_type sep1 = view.find( '|' );
+      size_type sep2 = sep1 == std::string_view::npos ? sep1 : view.find( '|', sep1+1 );
+      std::string_view action { view.substr( sep1 == std::string_view::npos ? view.size() : sep1+1,
+                                             sep2 == std::string_view::npos ? std::string_view::npos : sep2-sep1-1 ) };
+      if ( action.find_first_of( "\\'\"" ) == std::string_view::npos )	// no quoting
+      {
+        while ( ! action.empty() && ::isspace( action.back() ) )
+          action.remove_suffix( 1 );
+        while ( ! action.empty() && ::isspace( action.front() ) )
+          action.remove_prefix( 1 );
+        if ( sep1 != std::string_view::npos && sep2 != std::string_view::npos && ! _actionfilter.count( action ) )
+          return true;
+      }
+    }
+
+    // parse into fields (just lines using quotes or escapes need splitEscaped)
     HistoryLogData::FieldVector fields;
-    str::splitEscaped( line_r, std::back_inserter(fields), "|", true );
+    if ( view.find_first_of( "\\'\"" ) == std::string_view::npos )
+    {
+      for ( size_type pos = 0; ; )
+      {
+        size_type sep = view.find( '|', pos );
+        fields.emplace_back( view.substr( pos, sep == std::string_view::npos ? sep : sep-pos ) );
+        if ( sep == std::string_view::npos )
+          break;
+        pos = sep+1;
+      }
+    }
+    else
+      str::splitEscaped( std::string( view ), std::back_inserter(fields), "|", true );
 
     if ( fields.size() < 2 ) {
-      WAR << "Ignore invalid history log entry on line #" << lineNr_r << " '"<< line_r << "'" << endl;
+      WAR << "Ignore invalid history log entry on line #" << file_r.lineNo( pos_r ) << " '"<< view << "'" << endl;
       return true;	// At least an action field[1] is needed!
     }
     fields[1] = str::trim( std::move(fields[1]) );	// for whatever reason writer is padding the action field
@@ -88,12 +244,13 @@ namespace zypp
       ZYPP_CAUGHT( excpt );
       if ( _options.testFlag( IGNORE_INVALID_ITEMS ) )
       {
-        WAR << "Ignore invalid history log entry on line #" << lineNr_r << " '"<< line_r << "'" << endl;
+        WAR << "Ignore invalid history log entry on line #" << file_r.lineNo( pos_r ) << " '"<< view << "'" << endl;
         return true;
       }
       else
       {
-        ERR << "Invalid history log entry on line #" << lineNr_r << " '"<< line_r << "'" << endl;
+        unsigned lineNr_r = file_r.lineNo( pos_r );
+        ERR << "Invalid history log entry on line #" << lineNr_r << " '"<< view << "'" << endl;
         ParseException newexcpt( str::Str() << "Error in history log on line #" << lineNr_r );
         newexcpt.remember( excpt );
         ZYPP_THROW( newexcpt );
@@ -103,108 +260,107 @@ namespace zypp
     // consume data
     if ( _callback && !_callback( data ) )
     {
-      WAR << "Stop parsing requested by consumer callback on line #" << lineNr_r << endl;
+      WAR << "Stop parsing requested by consumer callback on line #" << file_r.lineNo( pos_r ) << endl;
       return false;
     }
     return true;
   }
 
-  void HistoryLogReader::Impl::readAll( const ProgressData::ReceiverFnc & progress_r )
+  HistoryLogReader::Impl::size_type HistoryLogReader::Impl::seek( const HistoryFile & file_r, const std::string & key_r, bool behind_r ) const
   {
-    InputStream is( _filename );
-    iostr::EachLine line( is );
+    // The log is written in chronological order and the date format sorts
+    // like a string. Find the smallest position whose next dated line
+    // is not before (behind) key_r.
+    const std::string_view data { file_r.data() };
+    auto nextDated = [&]( size_type pos ) -> std::pair<size_type,std::string_view> {
+      if ( pos && data[pos-1] != '\n' )
+        pos = file_r.nextLine( pos );
+      for ( ; pos < data.size(); pos = file_r.nextLine( pos ) )
+      {
+        std::string_view date { dateField( file_r.line( pos ) ) };
+        if ( ! date.empty() )
+          return { pos, date };
+      }
+      return { data.size(), std::string_view() };
+    };
+    auto found = [&]( std::string_view date ) {
+      return date.empty() || ( behind_r ? date > key_r : date >= key_r );
+    };
+
+    size_type lo = 0;
+    size_type hi = data.size();
+    while ( lo < hi )
+    {
+      size_type mid = lo + ( hi - lo ) / 2;
+      if ( found( nextDated( mid ).second ) )
+        hi = mid;
+      else
+        lo = mid + 1;
+    }
+    return nextDated( lo ).first;
+  }
 
+  void HistoryLogReader::Impl::readRange( const HistoryFile & file_r, size_type pos_r, size_type end_r, const ProgressData::ReceiverFnc & progress_r )
+  {
     ProgressData pd;
     pd.sendTo( progress_r );
     pd.toMin();
 
-    for ( ; line; line.next(), pd.tick() )
+    for ( ; pos_r < end_r; pos_r = file_r.nextLine( pos_r ), pd.tick() )
     {
-      // ignore comments
-      if ( (*line)[0] == '#' )
-        continue;
-
-      if ( ! parseLine( *line, line.lineNo() ) )
+      if ( ! parseLine( file_r, pos_r ) )
         break;	// requested by consumer callback
     }
 
     pd.toMax();
   }
 
-  void HistoryLogReader::Impl::readFrom( const Date & date_r, const ProgressData::ReceiverFnc & progress_r )
+  void HistoryLogReader::Impl::readAll( const ProgressData::ReceiverFnc & progress_r )
   {
-    InputStream is( _filename );
-    iostr::EachLine line( is );
+    HistoryFile file( _filename );
+    readRange( file, 0, file.data().size(), progress_r );
+  }
+
+  void HistoryLogReader::Impl::readAllReverse( const ProgressData::ReceiverFnc & progress_r )
+  {
+    HistoryFile file( _filename );
+    std::string_view data { file.data() };
 
     ProgressData pd;
     pd.sendTo( progress_r );
     pd.toMin();
 
-    bool pastDate = false;
-    for ( ; line; line.next(), pd.tick() )
+    if ( ! data.empty() )
     {
-      const std::string & s = *line;
-
-      // ignore comments
-      if ( s[0] == '#' )
-        continue;
-
-      if ( pastDate )
+      size_type end = data.size();
+      if ( data[end-1] == '\n' )
+        --end;	// the last lines newline
+      for ( ;; pd.tick() )
       {
-        if ( ! parseLine( s, line.lineNo() ) )
+        size_type pos = file.lineBegin( end );
+        if ( ! parseLine( file, pos ) )
           break;	// requested by consumer callback
-      }
-      else
-      {
-        Date logDate( s.substr( 0, s.find('|') ), HISTORY_LOG_DATE_FORMAT );
-        if ( logDate > date_r )
-        {
-          pastDate = true;
-          if ( ! parseLine( s, line.lineNo() ) )
-            break;	// requested by consumer callback
-        }
+        if ( ! pos )
+          break;
+        end = pos - 1;
       }
     }
 
     pd.toMax();
   }
 
-  void HistoryLogReader::Impl::readFromTo( const Date & fromDate_r, const Date & toDate_r, const ProgressData::ReceiverFnc & progress_r )
+  void HistoryLogReader::Impl::readFrom( const Date & date_r, const ProgressData::ReceiverFnc & progress_r )
   {
-    InputStream is( _filename );
-    iostr::EachLine line( is );
-
-    ProgressData pd;
-    pd.sendTo( progress_r );
-    pd.toMin();
-
-    bool pastFromDate = false;
-    for ( ; line; line.next(), pd.tick() )
-    {
-      const std::string & s = *line;
-
-      // ignore comments
-      if ( s[0] == '#' )
-        continue;
-
-      Date logDate( s.substr( 0, s.find('|') ), HISTORY_LOG_DATE_FORMAT );
-
-      // past toDate - stop reading
-      if ( logDate >= toDate_r )
-        break;
-
-      // past fromDate - start reading
-      if ( !pastFromDate && logDate > fromDate_r )
-        pastFromDate = true;
-
-      if ( pastFromDate )
-      {
-        if ( ! parseLine( s, line.lineNo() ) )
-          break;	// requested by consumer callback
-      }
-    }
+    HistoryFile file( _filename );
+    readRange( file, seek( file, date_r.form( HISTORY_LOG_DATE_FORMAT ), true ), file.data().size(), progress_r );
+  }
 
-    pd.toMax();
+  void HistoryLogReader::Impl::readFromTo( const Date & fromDate_r, const Date & toDate_r, const ProgressData::ReceiverFnc & progress_r )
+  {
+    HistoryFile file( _filename );
+    size_type begin = seek( file, fromDate_r.form( HISTORY_LOG_DATE_FORMAT ), true );
+    size_type end = seek( file, toDate_r.form( HISTORY_LOG_DATE_FORMAT ), false );
+    readRange( file, begin, std::max( begin, end ), progress_r );
   }
 
   /////////////////////////////////////////////////////////////////////
@@ -229,6 +385,9 @@ namespace zypp
   void HistoryLogReader::readAll( const ProgressData::ReceiverFnc & progress_r )
   { _pimpl->readAll( progress_r ); }
 
+  void HistoryLogReader::readAllReverse( const ProgressData::ReceiverFnc & progress_r )
+  { _pimpl->readAllReverse( progress_r ); }
+
   void HistoryLogReader::readFrom( const Date & date_r, const ProgressData::ReceiverFnc & progress_r )
   { _pimpl->readFrom( date_r, progress_r ); }
 
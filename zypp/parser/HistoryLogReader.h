@@ -62,6 +62,10 @@ namespace zypp
   /// \endcode
   /// \see \ref HistoryLogData for how to access the individual data fields.
   ///
+  /// The file is \c mmap'ed if possible. As zypp appends to the log in
+  /// chronological order, \ref readFrom and \ref readFromTo use a binary
+  /// search to locate the first entry rather than parsing all lines before.
+  ///
   ///////////////////////////////////////////////////////////////////
   class HistoryLogReader
   {
@@ -94,6 +98,16 @@ namespace zypp
      */
     void readAll( const ProgressData::ReceiverFnc & progress = ProgressData::ReceiverFnc() );
 
+    /**
+     * Read the whole log file, newest entries first.
+     *
+     * Useful to retrieve e.g. the last N transactions: Let the
+     * \ref ProcessData callback return \c false once you have enough.
+     *
+     * \param progress An optional progress data receiver function.
+     */
+    void readAllReverse( const ProgressData::ReceiverFnc & progress = ProgressData::ReceiverFnc() );
+
     /**
      * Read log from specified \a date.
      *
@@ -0,0 +1,210 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/pool/HardLockMatcher.cc
+ *
+*/
+#include <iostream>
+#include <unordered_set>
+
+#include <zypp/base/LogTools.h>
+#include <zypp/Repository.h>
+#include <zypp/pool/HardLockMatcher.h>
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace pool
+  {
+    namespace
+    {
+      /** The solvables name as libsolv matches it with \ref Match::SKIP_KIND. */
+      inline const char * nameSkipKind( const char * ident_r )
+      {
+        const char * p = ident_r;
+        while ( *p >= 'a' && *p <= 'z' )
+          ++p;
+        return ( *p == ':' && p != ident_r ) ? p+1 : ident_r;
+      }
+
+      /** Whether a glob has no special chars, so it matches exactly itself. */
+      inline bool isPlainGlob( const std::string & glob_r )
+      { return glob_r.find_first_of( "*?[\\" ) == std::string::npos; }
+    } // namespace
+
+    bool HardLockMatcher::Restriction::operator()( const sat::Solvable & solv_r ) const
+    {
+      if ( ! kinds.empty() && ! solv_r.isKind( kinds.begin(), kinds.end() ) )
+        return false;
+      if ( ! repos.empty() && repos.find( solv_r.repository().alias() ) == repos.end() )
+        return false;
+      return true;
+    }
+
+    HardLockMatcher::HardLockMatcher( const PoolTraits::HardLockQueries & queries_r )
+    {
+      for ( const PoolQuery & query : queries_r )
+      {
+        if ( ! compile( query ) )
+          _queries.push_back( query );
+      }
+      DBG << *this << endl;
+    }
+
+    bool HardLockMatcher::compile( const PoolQuery & query_r )
+    {
+      // A name lock: just strings for the name attribute and maybe kinds and repos.
+      const Match & flags( query_r.flags() );
+      if ( ! query_r.strings().empty()
+        || query_r.attributes().size() != 1
+        || query_r.attributes().begin()->first != sat::SolvAttr::name
+        || query_r.matchWord()
+        || query_r.edition() != Edition::noedition
+        || query_r.editionRel() != Rel::ANY
+        || query_r.statusFilterFlags() != PoolQuery::ALL
+        || ! flags.test( Match::SKIP_KIND )
+        || flags.mode() == Match::OTHER )
+        return false;
+
+      const PoolQuery::StrContainer & names( query_r.attributes().begin()->second );
+      for ( const std::string & name : names )
+      {
+        if ( name.empty() )
+          return false;
+      }
+
+      // Assert there's nothing else (e.g. predicated dependencies) not visible in the getters.
+      PoolQuery rebuilt;
+      rebuilt.setFlags( flags );
+      for ( const std::string & name : names )
+        rebuilt.addAttribute( sat::SolvAttr::name, name );
+      for ( const ResKind & kind : query_r.kinds() )
+        rebuilt.addKind( kind );
+      for ( const std::string & repo : query_r.repos() )
+        rebuilt.addRepo( repo );
+      if ( rebuilt != query_r )
+        return false;
+
+      Restriction restriction { query_r.kinds(), query_r.repos() };
+      bool exact = ! flags.test( Match::NOCASE ) && ( flags.isModeString() || flags.isModeGlob() );
+      if ( exact && flags.isModeGlob() )
+      {
+        for ( const std::string & name : names )
+        {
+          if ( ! isPlainGlob( name ) )
+          {
+            exact = false;
+            break;
+          }
+        }
+      }
+
+      if ( exact )
+      {
+        for ( const std::string & name : names )
+          _exact.insert( std::make_pair( IdString( name ), restriction ) );
+      }
+      else
+      {
+        Match mflags( flags.mode() );
+        if ( flags.test( Match::NOCASE ) )
+          mflags = mflags | Match::NOCASE;
+        try
+        {
+          for ( const std::string & name : names )
+          {
+            StrMatcher matcher( name, mflags );
+            matcher.compile();
+            _patterns.push_back( std::make_pair( std::move(matcher), restriction ) );
+          }
+        }
+        catch ( const Exception & excpt )
+        {
+          ZYPP_CAUGHT( excpt );
+          return false;	// let the PoolQuery complain
+        }
+      }
+      return true;
+    }
+
+    sat::SolvableSet HardLockMatcher::locked( const std::vector<sat::Solvable> & solvables_r ) const
+    {
+      sat::SolvableSet ret;
+      if ( solvables_r.empty() || empty() )
+        return ret;
+
+      // Name locks: look at each distinct name just once.
+      if ( ! ( _exact.empty() && _patterns.empty() ) )
+      {
+        std::unordered_map<IdString, std::vector<sat::Solvable>> byName;
+        for ( const sat::Solvable & solv : solvables_r )
+        {
+          IdString ident( solv.ident() );
+          const char * name = nameSkipKind( ident.c_str() );
+          byName[name == ident.c_str() ? ident : IdString( name )].push_back( solv );
+        }
+
+        for ( const auto & [name, solvables] : byName )
+        {
+          auto range = _exact.equal_range( name );
+          for ( auto it = range.first; it != range.second; ++it )
+          {
+            for ( const sat::Solvable & solv : solvables )
+              if ( it->second( solv ) )
+                ret.insert( solv );
+          }
+
+          for ( const auto & [matcher, restriction] : _patterns )
+          {
+            if ( ! matcher( name ) )
+              continue;
+            for ( const sat::Solvable & solv : solvables )
+              if ( restriction( solv ) )
+                ret.insert( solv );
+          }
+        }
+      }
+
+      // Other locks: query the repos of the solvables.
+      if ( ! _queries.empty() )
+      {
+        std::unordered_set<sat::Solvable> wanted( solvables_r.begin(), solvables_r.end() );
+        std::set<std::string> repos;
+        for ( const sat::Solvable & solv : solvables_r )
+          repos.insert( solv.repository().alias() );
+
+        for ( PoolQuery query : _queries )
+        {
+          if ( query.repos().empty() )
+          {
+            for ( const std::string & repo : repos )
+              query.addRepo( repo );
+          }
+          for ( const sat::Solvable & solv : query )
+          {
+            if ( wanted.count( solv ) )
+              ret.insert( solv );
+          }
+        }
+      }
+      return ret;
+    }
+
+    std::ostream & operator<<( std::ostream & str, const HardLockMatcher & obj )
+    {
+      return str << "HardLockMatcher(" << obj._exact.size() << " exact names, "
+                 << obj._patterns.size() << " name patterns, " << obj._queries.size() << " queries)";
+    }
+
+  } // namespace pool
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
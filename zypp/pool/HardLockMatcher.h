@@ -0,0 +1,96 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/pool/HardLockMatcher.h
+ *
+*/
+#ifndef ZYPP_POOL_HARDLOCKMATCHER_H
+#define ZYPP_POOL_HARDLOCKMATCHER_H
+
+#include <iosfwd>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <zypp/base/StrMatcher.h>
+#include <zypp/pool/PoolTraits.h>
+#include <zypp/sat/SolvableSet.h>
+#include <zypp/PoolQuery.h>
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace pool
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class HardLockMatcher
+    /// \brief The \ref PoolTraits::HardLockQueries compiled for matching a set of solvables.
+    ///
+    /// Most locks just look for a solvable name, maybe restricted to some
+    /// kinds and repos. Those are not run as \ref PoolQuery:
+    /// Locks on an exact name are kept in a hash table; name patterns (glob,
+    /// regex, ...) are matched once per distinct name of the solvables asked for.
+    ///
+    /// All other locks are run as \ref PoolQuery, restricted to the repos
+    /// of the solvables asked for (unless the lock names its own repos).
+    ///
+    /// So matching the solvables of a newly added repo does not need to
+    /// look at the rest of the pool.
+    ///////////////////////////////////////////////////////////////////
+    class HardLockMatcher
+    {
+      friend std::ostream & operator<<( std::ostream & str, const HardLockMatcher & obj );
+
+    public:
+      /** Default ctor: matching nothing. */
+      HardLockMatcher()
+      {}
+
+      /** Ctor compiling \a queries_r. */
+      explicit HardLockMatcher( const PoolTraits::HardLockQueries & queries_r );
+
+    public:
+      /** Whether there are no locks. */
+      bool empty() const
+      { return _exact.empty() && _patterns.empty() && _queries.empty(); }
+
+      /** The subset of \a solvables_r matched by any lock. */
+      sat::SolvableSet locked( const std::vector<sat::Solvable> & solvables_r ) const;
+
+    private:
+      /** Kinds and repos a name lock is restricted to (empty: any). */
+      struct Restriction
+      {
+        PoolQuery::Kinds kinds;
+        PoolQuery::StrContainer repos;
+
+        bool operator()( const sat::Solvable & solv_r ) const;
+      };
+
+      /** Compile a name lock into \ref _exact or \ref _patterns.
+       * \returns \c false if \a query_r needs to be run as \ref PoolQuery.
+       */
+      bool compile( const PoolQuery & query_r );
+
+    private:
+      std::unordered_multimap<IdString, Restriction> _exact;
+      std::vector<std::pair<StrMatcher, Restriction>> _patterns;
+      std::vector<PoolQuery> _queries;
+    };
+    ///////////////////////////////////////////////////////////////////
+
+    /** \relates HardLockMatcher Stream output */
+    std::ostream & operator<<( std::ostream & str, const HardLockMatcher & obj );
+
+  } // namespace pool
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_POOL_HARDLOCKMATCHER_H
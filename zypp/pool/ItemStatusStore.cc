@@ -0,0 +1,134 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/pool/ItemStatusStore.cc
+ *
+*/
+#include <iostream>
+#include <algorithm>
+
+#include <zypp/base/Logger.h>
+#include <zypp/pool/ItemStatusStore.h>
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace pool
+  {
+    ItemStatusStore & ItemStatusStore::instance()
+    {
+      static ItemStatusStore * _instance = new ItemStatusStore;
+      return *_instance;
+    }
+
+    void ItemStatusStore::resize( SolvableIdType size_r )
+    {
+      while ( size() < size_r )
+        _blocks.push_back( std::unique_ptr<Block>( new Block ) );
+    }
+
+    void ItemStatusStore::add( SolvableIdType id_r, const ResStatus & status_r )
+    {
+      resize( id_r + 1 );
+      unlinkBuddy( id_r );
+      Block & blk( block( id_r ) );
+      unsigned off = offset( id_r );
+      blk.status[off] = status_r;
+      blk.saved[off] = ResStatus();
+      blk.valid[off] = true;
+    }
+
+    void ItemStatusStore::remove( SolvableIdType id_r )
+    {
+      if ( id_r >= size() )
+        return;
+      unlinkBuddy( id_r );
+      Block & blk( block( id_r ) );
+      unsigned off = offset( id_r );
+      blk.status[off] = ResStatus();
+      blk.saved[off] = ResStatus();
+      blk.valid[off] = false;
+    }
+
+    void ItemStatusStore::unlinkBuddy( SolvableIdType id_r )
+    {
+      IdType b = buddy( id_r );
+      if ( ! b )
+        return;
+      SolvableIdType product = b > 0 ? id_r : -b;
+      SolvableIdType release = b > 0 ? b : id_r;
+      block( product ).buddy[offset( product )] = 0;
+      block( release ).buddy[offset( release )] = 0;
+      _buddied.erase( std::remove( _buddied.begin(), _buddied.end(), product ), _buddied.end() );
+    }
+
+    void ItemStatusStore::setBuddy( SolvableIdType id_r, SolvableIdType buddy_r )
+    {
+      block( id_r ).buddy[offset( id_r )] = buddy_r;
+      block( buddy_r ).buddy[offset( buddy_r )] = -IdType(id_r);
+      _buddied.insert( std::upper_bound( _buddied.begin(), _buddied.end(), id_r ), id_r );
+    }
+
+    void ItemStatusStore::saveState()
+    {
+      for ( const std::unique_ptr<Block> & blk : _blocks )
+        std::copy( blk->status, blk->status + Block::size, blk->saved );
+      for ( SolvableIdType id : _buddied )
+        savedStatus( id ) = status( id );
+    }
+
+    void ItemStatusStore::restoreState()
+    {
+      for ( const std::unique_ptr<Block> & blk : _blocks )
+        std::copy( blk->saved, blk->saved + Block::size, blk->status );
+      // Restoring item by item in id order, the one restored last would win.
+      for ( SolvableIdType id : _buddied )
+      {
+        SolvableIdType b = buddy( id );
+        if ( id > b )
+          ownStatus( b ) = savedStatus( id );
+      }
+    }
+
+    bool ItemStatusStore::sameState() const
+    {
+      bool ret = true;
+      forEachStatus( [&]( SolvableIdType id, const ResStatus & status ) {
+        if ( ret && ! sameState( status, savedStatus( id ) ) )
+          ret = false;
+      } );
+      return ret;
+    }
+
+    bool ItemStatusStore::sameState( const ResStatus & status_r, const ResStatus & saved_r )
+    {
+      if ( status_r == saved_r )
+        return true;
+      // some bits changed...
+      if ( status_r.getTransactValue() != saved_r.getTransactValue()
+           && ( ! status_r.isBySolver() // ignore solver state changes
+                // removing a user lock also goes to bySolver
+                || saved_r.getTransactValue() == ResStatus::LOCKED ) )
+        return false;
+      if ( status_r.isLicenceConfirmed() != saved_r.isLicenceConfirmed() )
+        return false;
+      return true;
+    }
+
+    std::ostream & operator<<( std::ostream & str, const ItemStatusStore & obj )
+    {
+      return str << "ItemStatusStore(" << obj.size() << " slots, " << obj._buddied.size() << " buddies)";
+    }
+
+  } // namespace pool
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,164 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/pool/ItemStatusStore.h
+ *
+*/
+#ifndef ZYPP_POOL_ITEMSTATUSSTORE_H
+#define ZYPP_POOL_ITEMSTATUSSTORE_H
+
+#include <iosfwd>
+#include <memory>
+#include <vector>
+
+#include <zypp/base/NonCopyable.h>
+#include <zypp/sat/detail/PoolMember.h>
+#include <zypp/ResStatus.h>
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace pool
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class ItemStatusStore
+    /// \brief The \ref ResStatus of all \ref PoolItem, indexed by solvable id.
+    ///
+    /// A \ref PoolItem in the pool is just a view on its slot here. The
+    /// status words, saved states and buddies are kept in dense arrays, so
+    /// pool wide status sweeps (save/restore state, collecting or resetting
+    /// transactions) are linear passes, not chasing one pointer per item.
+    ///
+    /// Slots are allocated in fixed size blocks and never move, so references
+    /// handed out by \ref PoolItem::status stay valid while the pool grows.
+    ///
+    /// A \ref PoolItem removed from the pool takes a copy of its status
+    /// (\ref PoolItem::Impl) and the slot is cleared.
+    ///
+    /// A product's status may be taken from its buddy (the release package,
+    /// \ref PoolItem::buddy). This is what \ref status returns, while
+    /// \ref ownStatus is the slots own value.
+    ///////////////////////////////////////////////////////////////////
+    class ItemStatusStore : private base::NonCopyable
+    {
+      friend std::ostream & operator<<( std::ostream & str, const ItemStatusStore & obj );
+
+    public:
+      using SolvableIdType = sat::detail::SolvableIdType;
+      using IdType = sat::detail::IdType;
+
+      /** The store (never destroyed, as \ref PoolItem may outlive static objects). */
+      static ItemStatusStore & instance();
+
+    public:
+      /** Slots for solvable ids below \a size_r are available (never shrinks). */
+      void resize( SolvableIdType size_r );
+
+      /** Number of slots. */
+      SolvableIdType size() const
+      { return _blocks.size() * Block::size; }
+
+      /** Init the slot of a \ref PoolItem added to the pool. */
+      void add( SolvableIdType id_r, const ResStatus & status_r );
+
+      /** Clear the slot of a \ref PoolItem removed from the pool. */
+      void remove( SolvableIdType id_r );
+
+    public:
+      /** Whether the slot is in use. */
+      bool valid( SolvableIdType id_r ) const
+      { return id_r < size() && block( id_r ).valid[offset( id_r )]; }
+
+      /** The slots own status. */
+      ResStatus & ownStatus( SolvableIdType id_r ) const
+      { return block( id_r ).status[offset( id_r )]; }
+
+      /** The items status (maybe the buddies). */
+      ResStatus & status( SolvableIdType id_r ) const
+      {
+        IdType b = buddy( id_r );
+        return ownStatus( b > 0 ? b : id_r );
+      }
+
+      /** The saved state (\ref saveState). */
+      ResStatus & savedStatus( SolvableIdType id_r ) const
+      { return block( id_r ).saved[offset( id_r )]; }
+
+      /** The items buddy: \c >0 using the buddies status, \c <0 status used by \c -buddy. */
+      IdType buddy( SolvableIdType id_r ) const
+      { return block( id_r ).buddy[offset( id_r )]; }
+
+      /** Make \a buddy_r provide the status for \a id_r. */
+      void setBuddy( SolvableIdType id_r, SolvableIdType buddy_r );
+
+    public:
+      /** Remember the current status of all items. */
+      void saveState();
+
+      /** Restore the status of all items saved by \ref saveState. */
+      void restoreState();
+
+      /** Whether the status of all items is the same as saved (\ref sameState). */
+      bool sameState() const;
+
+      /** Whether the status of an item is (basically) the same as \a saved_r. */
+      static bool sameState( const ResStatus & status_r, const ResStatus & saved_r );
+
+      /** Call <tt>fnc_r( SolvableIdType, ResStatus & )</tt> for each item in the pool (in id order).
+       * The status passed is \ref status (maybe the buddies).
+       */
+      template <class TFunction>
+      void forEachStatus( TFunction && fnc_r ) const
+      {
+        SolvableIdType id = 0;
+        for ( const std::unique_ptr<Block> & blk : _blocks )
+        {
+          for ( unsigned i = 0; i < Block::size; ++i, ++id )
+          {
+            if ( blk->valid[i] )
+              fnc_r( id, blk->buddy[i] > 0 ? ownStatus( blk->buddy[i] ) : blk->status[i] );
+          }
+        }
+      }
+
+    private:
+      /** Fixed size chunk of slots; one array per field. */
+      struct Block
+      {
+        static constexpr unsigned size = 4096;
+        ResStatus status[size];
+        ResStatus saved[size];
+        IdType    buddy[size] = {};
+        bool      valid[size] = {};
+      };
+
+      Block & block( SolvableIdType id_r ) const
+      { return *_blocks[id_r / Block::size]; }
+
+      static unsigned offset( SolvableIdType id_r )
+      { return id_r % Block::size; }
+
+      /** Break the buddy relation \a id_r is part of. */
+      void unlinkBuddy( SolvableIdType id_r );
+
+    private:
+      std::vector<std::unique_ptr<Block>> _blocks;
+      /** Items using their buddies status (in id order). */
+      std::vector<SolvableIdType> _buddied;
+    };
+    ///////////////////////////////////////////////////////////////////
+
+    /** \relates ItemStatusStore Stream output */
+    std::ostream & operator<<( std::ostream & str, const ItemStatusStore & obj );
+
+  } // namespace pool
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_POOL_ITEMSTATUSSTORE_H
@@ -13,6 +13,7 @@
 #define ZYPP_POOL_POOLIMPL_H
 
 #include <iosfwd>
+#include <unordered_set>
 #include <utility>
 
 #include <zypp/base/Easy.h>
@@ -21,6 +22,7 @@
 #include <zypp/APIConfig.h>
 
 #include <zypp/pool/PoolTraits.h>
+#include <zypp/pool/HardLockMatcher.h>
 #include <zypp/ResPoolProxy.h>
 #include <zypp/PoolQueryResult.h>
 
@@ -244,7 +246,7 @@ namespace zypp
       public:
         ResPoolProxy proxy( ResPool self ) const
         {
-          checkSerial();
+          id2item();	// updates an existing proxy
           if ( !_poolProxy )
           {
             _poolProxy.reset( new ResPoolProxy( std::move(self), *this ) );
@@ -284,22 +286,21 @@ namespace zypp
         const HardLockQueries & hardLockQueries() const
         { return _hardLockQueries; }
 
-        void reapplyHardLocks() const
+        void reapplyHardLocks( const std::vector<sat::Solvable> & addedSolvables_r ) const
         {
           // It is assumed that reapplyHardLocks is called after new
           // items were added to the pool, but the _hardLockQueries
           // did not change since. Action is to be performed only on
           // those items that gained the bit in the UserLockQueryField.
-          MIL << "Re-apply " << _hardLockQueries.size() << " HardLockQueries" << endl;
-          PoolQueryResult locked;
-          for_( it, _hardLockQueries.begin(), _hardLockQueries.end() )
-          {
-            locked += *it;
-          }
+          // As the queries did not change, just the new items may gain it.
+          if ( _hardLockQueries.empty() )
+            return;
+          MIL << "Re-apply " << _hardLockQueries.size() << " HardLockQueries to " << addedSolvables_r.size() << " new Solvables" << endl;
+          sat::SolvableSet locked( _hardLockMatcher.locked( addedSolvables_r ) );
           MIL << "HardLockQueries match " << locked.size() << " Solvables." << endl;
-          for_( it, begin(), end() )
+          for ( const sat::Solvable & solv : addedSolvables_r )
           {
-            resstatus::UserLockQueryManip::reapplyLock( it->status(), locked.contains( *it ) );
+            resstatus::UserLockQueryManip::reapplyLock( _store[solv.id()].status(), locked.contains( solv ) );
           }
         }
 
@@ -307,12 +308,15 @@ namespace zypp
         {
           MIL << "Apply " << newLocks_r.size() << " HardLockQueries" << endl;
           _hardLockQueries = newLocks_r;
+          _hardLockMatcher = HardLockMatcher( _hardLockQueries );
           // now adjust the pool status
-          PoolQueryResult locked;
-          for_( it, _hardLockQueries.begin(), _hardLockQueries.end() )
+          std::vector<sat::Solvable> all;
+          all.reserve( size() );
+          for_( it, begin(), end() )
           {
-            locked += *it;
+            all.push_back( it->satSolvable() );
           }
+          sat::SolvableSet locked( _hardLockMatcher.locked( all ) );
           MIL << "HardLockQueries match " << locked.size() << " Solvables." << endl;
           for_( it, begin(), end() )
           {
@@ -367,32 +371,69 @@ namespace zypp
           if ( _storeDirty )
           {
             sat::Pool pool( satpool() );
-            bool addedItems = false;
+            std::vector<sat::Solvable> addedSolvables;
             bool reusedIDs = _watcherIDs.remember( pool.serialIDs() );
             std::list<PoolItem> addedProducts;
 
+            // Just look at the solvables changed since the last update, unless we can't tell.
+            std::vector<sat::Pool::SolvableIdRange> changed;
+            bool known = pool.changedSolvables( _changelog, changed );
+            if ( _id2item.empty() && ! _poolProxy )
+              _changesAll = true;	// nothing to update yet, so don't remember the changes
+            if ( ! known || reusedIDs )
+            {
+              changed.clear();
+              changed.push_back( sat::Pool::SolvableIdRange( 1, pool.capacity() ) );
+              _changesAll = true;
+            }
+            if ( _changesAll )
+            {
+              _changesItems.clear();
+              _changesModified.clear();
+            }
+
+            for ( size_type i = pool.capacity(); i < _store.size(); ++i )
+            {
+              if ( _store[i] )
+                _store[i].detachStatus();	// reused IDs shrink the pool
+            }
             _store.resize( pool.capacity() );
+            _storeIdents.resize( pool.capacity() );
 
-            if ( pool.capacity() )
+            for ( const sat::Pool::SolvableIdRange & range : changed )
             {
-              for ( sat::detail::SolvableIdType i = pool.capacity()-1; i != 0; --i )
+              SolvableIdType rend = std::min( range.second, SolvableIdType(pool.capacity()) );
+              for ( SolvableIdType i = range.first; i < rend; ++i )
               {
                 sat::Solvable s( i );
                 PoolItem & pi( _store[i] );
                 if ( ! s &&  pi )
                 {
                   // the PoolItem got invalidated (e.g unloaded repo)
+                  if ( ! _changesAll )
+                    _changesItems.push_back( std::make_pair( Id2ItemT::value_type( _storeIdents[i], pi ), false ) );
+                  pi.detachStatus();
                   pi = PoolItem();
+                  _storeIdents[i] = 0;
                 }
                 else if ( reusedIDs || (s && ! pi) )
                 {
                   // new PoolItem to add
+                  if ( pi )
+                    pi.detachStatus();	// reused ID
                   pi = PoolItem::makePoolItem( s ); // the only way to create a new one!
+                  _storeIdents[i] = id2itemKey( s );
+                  if ( ! _changesAll )
+                    _changesItems.push_back( std::make_pair( Id2ItemT::value_type( _storeIdents[i], pi ), true ) );
                   // remember products for buddy processing (requires clean store)
                   if ( s.isKind( ResKind::product ) )
                     addedProducts.push_back( pi );
-                  if ( !addedItems )
-                    addedItems = true;
+                  addedSolvables.push_back( s );
+                }
+                else if ( pi && ! _changesAll )
+                {
+                  // unchanged PoolItem, but its Selectable may need an update (e.g. repo priority)
+                  _changesModified.insert( _storeIdents[i] );
                 }
               }
             }
@@ -410,9 +451,9 @@ namespace zypp
             }
 
             // .... we must reapply those query based hard locks.
-            if ( addedItems )
+            if ( ! addedSolvables.empty() )
             {
-              reapplyHardLocks();
+              reapplyHardLocks( addedSolvables );
             }
 
             // Compute the initial status of Patches etc.
@@ -428,17 +469,49 @@ namespace zypp
           if ( _id2itemDirty )
           {
             store();
-            _id2item = Id2ItemT( size() );
-            for_( it, begin(), end() )
+            if ( _changesAll )
+            {
+              _id2item = Id2ItemT( size() );
+              for_( it, begin(), end() )
+              {
+                _id2item.insert( std::make_pair( _storeIdents[it->id()], *it ) );
+              }
+            }
+            else
             {
-              const sat::Solvable &s = (*it)->satSolvable();
-              sat::detail::IdType id = s.ident().id();
-              if ( s.isKind( ResKind::srcpackage ) )
-                id = -id;
-              _id2item.insert( std::make_pair( id, *it ) );
+              // Just the delta since the last update (in order, an item may come and go).
+              for ( const auto & [item, added] : _changesItems )
+              {
+                if ( added )
+                {
+                  _id2item.insert( item );
+                  continue;
+                }
+                auto range = _id2item.equal_range( item.first );
+                for ( auto it = range.first; it != range.second; ++it )
+                {
+                  if ( it->second == item.second )
+                  {
+                    _id2item.erase( it );
+                    break;
+                  }
+                }
+              }
             }
             //INT << _id2item << endl;
             _id2itemDirty = false;
+
+            // Proceed to update the ResPoolProxy if it exists, as id2item is now up to date.
+            if ( _poolProxy )
+            {
+              if ( _changesAll )
+                _poolProxy.reset();
+              else
+                updateProxy();
+            }
+            _changesAll = false;
+            _changesItems.clear();
+            _changesModified.clear();
           }
           return _id2item;
         }
@@ -458,11 +531,28 @@ namespace zypp
         {
           _storeDirty = true;
           _id2itemDirty = true;
-          _id2item.clear();
-          _poolProxy.reset();
           _establishedStates.reset();
         }
 
+        /** The \ref id2item key of \a solv_r (the ident, negated for srcpackages). */
+        static sat::detail::IdType id2itemKey( const sat::Solvable & solv_r )
+        {
+          sat::detail::IdType id = solv_r.ident().id();
+          if ( solv_r.isKind( ResKind::srcpackage ) )
+            id = -id;
+          return id;
+        }
+
+        /** Rebuild the \ref ResPoolProxy Selectables of the changed idents. */
+        void updateProxy() const
+        {
+          std::unordered_set<sat::detail::IdType> idents( _changesModified );
+          for ( const auto & change : _changesItems )
+            idents.insert( change.first.first );
+          if ( ! idents.empty() )
+            _poolProxy->update( *this, idents );
+        }
+
       private:
         /** Watch sat pools serial number. */
         SerialNumberWatcher                   _watcher;
@@ -473,6 +563,15 @@ namespace zypp
         mutable Id2ItemT		      _id2item;
         mutable DefaultIntegral<bool,true>    _id2itemDirty;
 
+        /** \ref sat::Pool::changedSolvables processed by the \ref store. */
+        mutable unsigned                      _changelog = (unsigned)-1;
+        /** The \ref id2item key per \ref store entry (the solvable is gone if the item is removed). */
+        mutable std::vector<sat::detail::IdType> _storeIdents;
+        /** The \ref store changes not yet applied to \ref id2item and the \ref ResPoolProxy. */
+        mutable DefaultIntegral<bool,true>    _changesAll;
+        mutable std::vector<std::pair<Id2ItemT::value_type,bool>> _changesItems;	// added or removed
+        mutable std::unordered_set<sat::detail::IdType> _changesModified;
+
       private:
         mutable shared_ptr<ResPoolProxy>      _poolProxy;
         mutable shared_ptr<EstablishedStatesImpl> _establishedStates;
@@ -480,6 +579,8 @@ namespace zypp
       private:
         /** Set of queries that define hardlocks. */
         HardLockQueries                       _hardLockQueries;
+        /** The _hardLockQueries compiled for matching. */
+        HardLockMatcher                       _hardLockMatcher;
     };
     ///////////////////////////////////////////////////////////////////
 
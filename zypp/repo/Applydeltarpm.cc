@@ -10,10 +10,10 @@
  *
 */
 #include <iostream>
+#include <cctype>
 
 #include <zypp/base/Logger.h>
 #include <zypp/base/String.h>
-#include <zypp/base/Regex.h>
 #include <zypp/repo/Applydeltarpm.h>
 #include <zypp/ExternalProgram.h>
 #include <zypp/AutoDispose.h>
@@ -33,7 +33,6 @@ namespace zypp
     { /////////////////////////////////////////////////////////////////
 
       const Pathname   applydeltarpm_prog( "/usr/bin/applydeltarpm" );
-      const str::regex applydeltarpm_tick ( "([0-9]+) percent finished" );
 
       /******************************************************************
        **
@@ -44,12 +43,12 @@ namespace zypp
                           const Progress & report_r  = Progress() )
       {
         ExternalProgram prog( argv_r, ExternalProgram::Stderr_To_Stdout );
-        str::smatch what;
+        unsigned percent = 0;
         for ( std::string line = prog.receiveLine(); ! line.empty(); line = prog.receiveLine() )
           {
-            if ( report_r && str::regex_match( line, what, applydeltarpm_tick ) )
+            if ( report_r && parseProgress( line, percent ) )
               {
-                report_r( str::strtonum<unsigned>( what[1] ) );
+                report_r( percent );
               }
             else
               DBG << "Applydeltarpm : " << line;
@@ -57,6 +56,18 @@ namespace zypp
         return( prog.close() == 0 );
       }
 
+      /** Run the command \a cmd_r. */
+      bool applydeltarpm( const std::vector<std::string> & cmd_r,
+                          const Progress & report_r  = Progress() )
+      {
+        std::vector<const char *> argv;
+        argv.reserve( cmd_r.size() + 1 );
+        for ( const std::string & arg : cmd_r )
+          argv.push_back( arg.c_str() );
+        argv.push_back( NULL );
+        return( applydeltarpm( argv.data(), report_r ) );
+      }
+
       /////////////////////////////////////////////////////////////////
     } // namespace
     ///////////////////////////////////////////////////////////////////
@@ -95,14 +106,21 @@ namespace zypp
       if ( ! haveApplydeltarpm() )
         return false;
 
-      const char *const argv[] = {
-        "/usr/bin/applydeltarpm",
+      return( applydeltarpm( checkCommand( sequenceinfo_r, quick_r ) ) );
+    }
+
+    /******************************************************************
+     **
+     **	FUNCTION NAME : checkCommand
+     **	FUNCTION TYPE : std::vector<std::string>
+    */
+    std::vector<std::string> checkCommand( const std::string & sequenceinfo_r, bool quick_r )
+    {
+      return {
+        applydeltarpm_prog.asString(),
         ( quick_r ? "-C" : "-c" ),
-        "-s", sequenceinfo_r.c_str(),
-        NULL
+        "-s", sequenceinfo_r
       };
-
-      return( applydeltarpm( argv ) );
     }
 
     /******************************************************************
@@ -139,16 +157,8 @@ namespace zypp
       if ( ! haveApplydeltarpm() )
         return false;
 
-      const char *const argv[] = {
-        "/usr/bin/applydeltarpm",
-        "-p", "-p", // twice to get percent output one per line
-        delta_r.asString().c_str(),
-        new_r.asString().c_str(),
-        NULL
-      };
-
       filesystem::assert_dir( new_r.dirname() );  // bsc#1219442: in case .rpm and .drpm are not in the same directory
-      if ( ! applydeltarpm( argv, report_r ) )
+      if ( ! applydeltarpm( provideCommand( delta_r, new_r ), report_r ) )
         return false;
 
       guard.resetDispose(); // no cleanup on success
@@ -187,6 +197,41 @@ namespace zypp
       return true;
     }
 
+    /******************************************************************
+     **
+     **	FUNCTION NAME : provideCommand
+     **	FUNCTION TYPE : std::vector<std::string>
+    */
+    std::vector<std::string> provideCommand( const Pathname & delta_r, const Pathname & new_r )
+    {
+      return {
+        applydeltarpm_prog.asString(),
+        "-p", "-p", // twice to get percent output one per line
+        delta_r.asString(),
+        new_r.asString()
+      };
+    }
+
+    /******************************************************************
+     **
+     **	FUNCTION NAME : parseProgress
+     **	FUNCTION TYPE : bool
+    */
+    bool parseProgress( const std::string & line_r, unsigned & percent_r )
+    {
+      // "([0-9]+) percent finished"
+      std::string::size_type end = line_r.find( " percent finished" );
+      if ( end == std::string::npos )
+        return false;
+      std::string::size_type begin = end;
+      while ( begin && ::isdigit( (unsigned char)line_r[begin-1] ) )
+        --begin;
+      if ( begin == end )
+        return false;
+      percent_r = str::strtonum<unsigned>( line_r.substr( begin, end - begin ) );
+      return true;
+    }
+
     /////////////////////////////////////////////////////////////////
   } // namespace applydeltarpm
   ///////////////////////////////////////////////////////////////////
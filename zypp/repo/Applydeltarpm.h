@@ -14,6 +14,7 @@
 
 #include <iosfwd>
 #include <string>
+#include <vector>
 
 #include <zypp/base/Function.h>
 #include <zypp/Pathname.h>
@@ -44,6 +45,12 @@ namespace zypp
     */
     bool check( const Pathname & delta_r, bool quick_r = false );
 
+    /** The command checking via sequence info.
+     * Meant to be run in the background, like \ref check would do it.
+     * \see <tt>applydeltarpm [-c|-C] -s sequence</tt>
+    */
+    std::vector<std::string> checkCommand( const std::string & sequenceinfo_r, bool quick_r = false );
+
     /** Quick via check sequence info.*/
     inline bool quickcheck( const std::string & sequenceinfo_r )
     { return check( sequenceinfo_r, true ); }
@@ -72,6 +79,18 @@ namespace zypp
     bool provide( const Pathname & old_r, const Pathname & delta_r,
                   const Pathname & new_r,
                   const Progress & report_r = Progress() );
+
+    /** The command re-creating a new rpm from binary delta and on-disk data.
+     * Meant to be run in the background, like \ref provide would do it.
+     * The output lines may be passed to \ref parseProgress.
+     * \see <tt>applydeltarpm -p -p deltarpm newrpm</tt>
+    */
+    std::vector<std::string> provideCommand( const Pathname & delta_r, const Pathname & new_r );
+
+    /** Parse a progress line (<tt>"NN percent finished"</tt>) of applydeltarpm.
+     * \returns \c false if \a line_r is not a progress line.
+    */
+    bool parseProgress( const std::string & line_r, unsigned & percent_r );
     //@}
 
     /////////////////////////////////////////////////////////////////
@@ -13,7 +13,10 @@ extern "C"
 
 #include <iostream>
 #include <utility>
+#include <unordered_map>
+#include <vector>
 #include <zypp/base/Logger.h>
+#include <zypp/base/SerialNumber.h>
 #include <zypp/Repository.h>
 #include <zypp/repo/DeltaCandidates.h>
 #include <zypp/sat/Pool.h>
@@ -29,6 +32,76 @@ namespace zypp
   namespace repo
   { /////////////////////////////////////////////////////////////////
 
+    namespace
+    {
+      ///////////////////////////////////////////////////////////////////
+      /// \class DeltaIndex
+      /// \brief The deltarpms of one repository, indexed by target package name and arch.
+      ///
+      /// The edition is compared when looking up the candidates, so the
+      /// \ref Edition rules (e.g. an omitted epoch) apply as before.
+      ///////////////////////////////////////////////////////////////////
+      struct DeltaIndex
+      {
+        DeltaIndex( const Repository & repo_r )
+        {
+          sat::LookupRepoAttr q( sat::SolvAttr::repositoryDeltaInfo, repo_r );
+          for_( it, q.begin(), q.end() )
+          {
+            _deltas.push_back( DeltaRpm( it ) );
+            const DeltaRpm & delta( _deltas.back() );
+            _byIdent[key( IdString( delta.name() ), delta.arch() )].push_back( _deltas.size()-1 );
+          }
+          DBG << repo_r << ": indexed " << _deltas.size() << " deltas for " << _byIdent.size() << " packages" << endl;
+        }
+
+        /** All deltas in repository order. */
+        const std::vector<DeltaRpm> & deltas() const
+        { return _deltas; }
+
+        /** Append the deltas building \a package_r to \a result_r. */
+        void find( const Package::constPtr & package_r, std::list<DeltaRpm> & result_r ) const
+        {
+          auto it = _byIdent.find( key( package_r->ident(), package_r->arch() ) );
+          if ( it == _byIdent.end() )
+            return;
+          for ( unsigned idx : it->second )
+          {
+            const DeltaRpm & delta( _deltas[idx] );
+            if ( package_r->edition() == delta.edition() )
+            {
+              DBG << "got delta candidate: " << delta << endl;
+              result_r.push_back( delta );
+            }
+          }
+        }
+
+      private:
+        static uint64_t key( IdString name_r, const Arch & arch_r )
+        { return ( uint64_t(name_r.id()) << 32 ) | arch_r.id(); }
+
+        std::vector<DeltaRpm> _deltas;
+        std::unordered_map<uint64_t, std::vector<unsigned>> _byIdent;
+      };
+
+      /** The \ref DeltaIndex of \a repo_r.
+       * Built on demand and kept until the pool content changes.
+       */
+      const DeltaIndex & deltaIndex( const Repository & repo_r )
+      {
+        static std::unordered_map<Repository::IdType, DeltaIndex> _indexes;
+        static SerialNumberWatcher _watcher;
+        if ( _watcher.remember( sat::Pool::instance().serial() ) )
+          _indexes.clear();
+
+        auto it = _indexes.find( repo_r.id() );
+        if ( it == _indexes.end() )
+          it = _indexes.emplace( repo_r.id(), DeltaIndex( repo_r ) ).first;
+        return it->second;
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
     /** DeltaCandidates implementation. */
     struct DeltaCandidates::Impl
     {
@@ -81,20 +154,21 @@ namespace zypp
       std::list<DeltaRpm> candidates;
 
       DBG << "package: " << package << endl;
-      for_( rit, _pimpl->repos.begin(), _pimpl->repos.end() )
+      if ( package )
       {
-        sat::LookupRepoAttr q( sat::SolvAttr::repositoryDeltaInfo, *rit );
-        for_( it, q.begin(), q.end() )
+        if ( _pimpl->pkgname.empty() || package->name() == _pimpl->pkgname )
         {
-          if ( _pimpl->pkgname.empty()
-               || it.subFind( sat::SolvAttr(DELTA_PACKAGE_NAME) ).asString() == _pimpl->pkgname )
+          for ( const Repository & repo : _pimpl->repos )
+            deltaIndex( repo ).find( package, candidates );
+        }
+      }
+      else
+      {
+        for ( const Repository & repo : _pimpl->repos )
+        {
+          for ( const DeltaRpm & delta : deltaIndex( repo ).deltas() )
           {
-            DeltaRpm delta( it );
-            //DBG << "checking delta: " << delta << endl;
-            if ( ! package
-                   || (    package->name()    == delta.name()
-                        && package->edition() == delta.edition()
-                        && package->arch()    == delta.arch() ) )
+            if ( _pimpl->pkgname.empty() || delta.name() == _pimpl->pkgname )
             {
               DBG << "got delta candidate: " << delta << endl;
               candidates.push_back( delta );
@@ -105,6 +179,15 @@ namespace zypp
       return candidates;
     }
 
+    std::vector<std::list<DeltaRpm>> DeltaCandidates::deltaRpms( const std::vector<Package::constPtr> & packages_r ) const
+    {
+      std::vector<std::list<DeltaRpm>> ret;
+      ret.reserve( packages_r.size() );
+      for ( const Package::constPtr & package : packages_r )
+        ret.push_back( package ? deltaRpms( package ) : std::list<DeltaRpm>() );
+      return ret;
+    }
+
     std::ostream & operator<<( std::ostream & str, const DeltaCandidates & obj )
     {
       return str << *obj._pimpl;
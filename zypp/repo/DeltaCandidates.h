@@ -12,6 +12,7 @@
 
 #include <iosfwd>
 #include <list>
+#include <vector>
 
 #include <zypp/base/PtrTypes.h>
 #include <zypp/base/Function.h>
@@ -56,8 +57,18 @@ namespace zypp
       /** Dtor */
       ~DeltaCandidates();
 
+      /** The deltarpms building \a package.
+       * If \a package is \c nullptr, all deltarpms (for \c pkgname, if set) are returned.
+       * The deltas of each repository are indexed on first use, so this is a
+       * hash lookup until the pool content changes.
+       */
       std::list<packagedelta::DeltaRpm> deltaRpms(const Package::constPtr & package) const;
 
+      /** The deltarpms building each of \a packages_r, e.g. all packages of a transaction.
+       * \returns One list per package, in the same order.
+       */
+      std::vector<std::list<packagedelta::DeltaRpm>> deltaRpms( const std::vector<Package::constPtr> & packages_r ) const;
+
     private:
       /** Pointer to implementation */
       RWCOW_pointer<Impl> _pimpl;
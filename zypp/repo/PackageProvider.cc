@@ -616,11 +616,8 @@ namespace zypp
       report()->finishDeltaDownload();
 
       report()->startDeltaApply( delta );
-      if ( ! applydeltarpm::check( delta_r.baseversion().sequenceinfo() ) )
-        {
-          report()->problemDeltaApply( _("applydeltarpm check failed.") );
-          return ManagedFile();
-        }
+      // No separate full check (reading all installed files once more):
+      // applydeltarpm verifies the md5 of the rebuilt rpm itself and fails.
 
       // Build the package
       Pathname cachedest( _package->repoInfo().packagesPath() / _package->repoInfo().path() / _package->location().filename() );
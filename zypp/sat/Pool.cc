@@ -33,6 +33,7 @@ extern "C"
 #include <zypp/sat/detail/PoolImpl.h>
 #include <zypp/sat/Pool.h>
 #include <zypp/sat/LookupAttr.h>
+#include <zypp/sat/SearchIndex.h>
 
 using std::endl;
 
@@ -58,6 +59,9 @@ namespace zypp
     const SerialNumber & Pool::serialIDs() const
     { return myPool().serialIDs(); }
 
+    bool Pool::changedSolvables( unsigned & changelog_r, std::vector<SolvableIdRange> & ranges_r ) const
+    { return myPool().changedSolvables( changelog_r, ranges_r ); }
+
     void Pool::prepare() const
     { return myPool().prepare(); }
 
@@ -188,6 +192,7 @@ namespace zypp
       AutoDispose<Repository> tmprepo( (Repository::EraseFromPool()) );
       *tmprepo = reposInsert( alias_r );
       tmprepo->addSolv( file_r );
+      SearchIndex::attach( *tmprepo, file_r );
 
       // no exceptions so we keep it:
       tmprepo.resetDispose();
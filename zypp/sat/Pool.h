@@ -13,6 +13,8 @@
 #define ZYPP_SAT_POOL_H
 
 #include <iosfwd>
+#include <utility>
+#include <vector>
 
 #include <zypp/Pathname.h>
 
@@ -69,6 +71,18 @@ namespace zypp
         /** Serial number changing whenever resusePoolIDs==true was used. ResPool must also invalidate its PoolItems! */
         const SerialNumber & serialIDs() const;
 
+        /** A range <tt>[first,second)</tt> of solvable ids. */
+        using SolvableIdRange = std::pair<detail::SolvableIdType,detail::SolvableIdType>;
+
+        /** The solvable id ranges added, removed or modified since \a changelog_r.
+         * Meant for incrementally updating data derived from the pools solvables
+         * (like the \ref ResPool store). \a changelog_r is updated to the latest
+         * change. Initially use <tt>(unsigned)-1</tt>.
+         * \returns \c false if the changes are not known (e.g. IDs were reused or
+         * \a changelog_r is too old), so all solvables must be considered changed.
+         */
+        bool changedSolvables( unsigned & changelog_r, std::vector<SolvableIdRange> & ranges_r ) const;
+
         /** Update housekeeping data if necessary (e.g. whatprovides). */
         void prepare() const;
 
@@ -132,6 +146,7 @@ namespace zypp
       public:
         /** Load \ref Solvables from a solv-file into a \ref Repository named \c name_r.
          * In case of an exception the \ref Repository is removed from the \ref Pool.
+         * A \ref SearchIndex built for the solv-file is attached to the \ref Repository.
          * \throws Exception if loading the solv-file fails.
          * \see \ref Repository::EraseFromPool
         */
@@ -0,0 +1,435 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/sat/SearchIndex.cc
+ */
+extern "C"
+{
+#include <solv/pool.h>
+#include <solv/repo.h>
+#include <solv/repo_solv.h>
+#include <solv/repodata.h>
+#include <solv/dataiterator.h>
+}
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <unordered_map>
+
+#include <zypp/base/LogTools.h>
+#include <zypp/base/Errno.h>
+#include <zypp/base/DefaultIntegral.h>
+#include <zypp/AutoDispose.h>
+#include <zypp/PathInfo.h>
+#include <zypp-core/CheckSumBatch.h>
+#include <zypp/sat/detail/PoolImpl.h>
+#include <zypp/sat/SearchIndex.h>
+
+#undef  ZYPP_BASE_LOGGER_LOGGROUP
+#define ZYPP_BASE_LOGGER_LOGGROUP "zypp::searchidx"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace sat
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      // File layout (host byte order):
+      //   header:  magic[8] solvSize:u64 solvDigest:char[64] nsolvables:u32 ntrigrams:u32
+      //   entries: { trigram:u32 count:u32 offset:u64 }[ntrigrams], sorted by trigram
+      //   postings: per trigram the delta encoded solvable positions as varint
+      const char     magic[8]    = { 'Z','Y','P','P','T','R','G','2' };
+      constexpr size_t digestSize = 64;	// sha256 hex string
+      constexpr size_t headerSize = 8 + 8 + digestSize + 4 + 4;
+      constexpr size_t entrySize  = 4 + 4 + 8;
+
+      template <class Tp>
+      inline Tp readAt( const char * ptr_r )
+      { Tp ret; ::memcpy( &ret, ptr_r, sizeof(Tp) ); return ret; }
+
+      template <class Tp>
+      inline void writeTo( std::ostream & str, Tp val_r )
+      { str.write( reinterpret_cast<const char *>( &val_r ), sizeof(Tp) ); }
+
+      inline void appendVarint( std::string & str_r, std::uint32_t val_r )
+      {
+        while ( val_r >= 0x80 )
+        {
+          str_r += char( ( val_r & 0x7f ) | 0x80 );
+          val_r >>= 7;
+        }
+        str_r += char( val_r );
+      }
+
+      /** The content digest of \a solvfile_r stored in the header. */
+      inline std::string solvDigest( const Pathname & solvfile_r )
+      {
+        std::string ret( CheckSumBatch::compute( solvfile_r, CheckSum::sha256Type() ).checksum() );
+        return( ret.size() == digestSize ? ret : std::string() );
+      }
+
+      inline char lower( char ch_r )
+      { return( ch_r >= 'A' && ch_r <= 'Z' ? ch_r + ( 'a' - 'A' ) : ch_r ); }
+
+      /** Invoke \a fnc_r for each trigram in \a str_r. Trigrams containing non ASCII chars are skipped. */
+      template <class TFunction>
+      void forEachTrigram( const char * str_r, TFunction && fnc_r )
+      {
+        if ( ! str_r )
+          return;
+        std::uint32_t trigram = 0;
+        unsigned ascii = 0;	// number of trailing ASCII chars in trigram
+        for ( const char * p = str_r; *p; ++p )
+        {
+          unsigned char ch = lower( *p );
+          trigram = ( ( trigram << 8 ) | ch ) & 0xffffff;
+          ascii = ( ch & 0x80 ) ? 0 : ascii + 1;
+          if ( ascii >= 3 )
+            fnc_r( trigram );
+        }
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class SearchIndex::Impl
+    /// \brief SearchIndex implementation.
+    ///////////////////////////////////////////////////////////////////
+    class SearchIndex::Impl : private base::NonCopyable
+    {
+      friend std::ostream & operator<<( std::ostream & str, const SearchIndex & obj );
+
+    public:
+      Impl( const Repository & repo_r, Pathname solvfile_r )
+      : _repo( repo_r )
+      , _solvfile( std::move(solvfile_r) )
+      {}
+
+    public:
+      /** Whether the index is read and fits the repos solvables. */
+      bool usable() const
+      {
+        if ( ! load() )
+          return false;
+        detail::CRepo * repo = _repo.get();
+        return( repo && unsigned(repo->nsolvables) == _nsolvables && unsigned(repo->end - repo->start) == _nsolvables );
+      }
+
+      /** The first solvable in the repo. */
+      detail::SolvableIdType start() const
+      { return _repo.get()->start; }
+
+      /** The sorted solvable positions containing \a trigram_r. */
+      std::vector<std::uint32_t> postings( std::uint32_t trigram_r ) const
+      {
+        std::vector<std::uint32_t> ret;
+        const char * entry = findEntry( trigram_r );
+        if ( ! entry )
+          return ret;
+
+        std::uint32_t count  = readAt<std::uint32_t>( entry + 4 );
+        std::uint64_t offset = readAt<std::uint64_t>( entry + 8 );
+        const char * p   = _postings + offset;
+        const char * end = _data.data() + _data.size();
+        ret.reserve( count );
+
+        std::uint32_t pos = 0;
+        while ( count-- && p < end )
+        {
+          std::uint32_t delta = 0;
+          for ( unsigned shift = 0; p < end; shift += 7 )
+          {
+            unsigned char ch = *p++;
+            delta |= std::uint32_t( ch & 0x7f ) << shift;
+            if ( ! ( ch & 0x80 ) )
+              break;
+          }
+          pos += delta;
+          ret.push_back( pos );
+        }
+        return ret;
+      }
+
+      /** Number of solvable positions containing \a trigram_r. */
+      std::uint32_t count( std::uint32_t trigram_r ) const
+      {
+        const char * entry = findEntry( trigram_r );
+        return entry ? readAt<std::uint32_t>( entry + 4 ) : 0;
+      }
+
+    private:
+      /** Read the index file on demand. */
+      bool load() const
+      {
+        if ( _loaded )
+          return _valid;
+        _loaded = true;
+
+        Pathname file( indexFile( _solvfile ) );
+        {
+          std::ifstream in( file.c_str(), std::ios::binary );
+          _data.assign( std::istreambuf_iterator<char>( in ), std::istreambuf_iterator<char>() );
+        }
+        if ( _data.size() < headerSize || ::memcmp( _data.data(), magic, sizeof(magic) ) != 0 )
+        {
+          WAR << "Ignore malformed search index " << file << endl;
+          return false;
+        }
+
+        // The cheap size check first, the digest must match as well:
+        if ( std::uint64_t(PathInfo( _solvfile ).size()) != readAt<std::uint64_t>( _data.data() + 8 )
+          || solvDigest( _solvfile ) != std::string( _data.data() + 16, digestSize ) )
+        {
+          WAR << "Ignore search index not matching " << _solvfile << endl;
+          return false;
+        }
+
+        _nsolvables = readAt<std::uint32_t>( _data.data() + 16 + digestSize );
+        _nentries   = readAt<std::uint32_t>( _data.data() + 20 + digestSize );
+        if ( _data.size() < headerSize + _nentries * entrySize )
+        {
+          WAR << "Ignore truncated search index " << file << endl;
+          return false;
+        }
+        _entries  = _data.data() + headerSize;
+        _postings = _entries + _nentries * entrySize;
+        _valid = true;
+        MIL << "Read search index " << file << " (" << _nentries << " trigrams, " << _nsolvables << " solvables)" << endl;
+        return true;
+      }
+
+      const char * findEntry( std::uint32_t trigram_r ) const
+      {
+        std::uint32_t lo = 0;
+        std::uint32_t hi = _nentries;
+        while ( lo < hi )
+        {
+          std::uint32_t mid = lo + ( hi - lo ) / 2;
+          const char * entry = _entries + mid * entrySize;
+          std::uint32_t trigram = readAt<std::uint32_t>( entry );
+          if ( trigram == trigram_r )
+            return entry;
+          if ( trigram < trigram_r )
+            lo = mid + 1;
+          else
+            hi = mid;
+        }
+        return nullptr;
+      }
+
+    private:
+      Repository _repo;
+      Pathname   _solvfile;
+
+      mutable DefaultIntegral<bool,false> _loaded;
+      mutable DefaultIntegral<bool,false> _valid;
+      mutable std::string _data;
+      mutable std::uint32_t _nsolvables = 0;
+      mutable std::uint32_t _nentries = 0;
+      mutable const char * _entries = nullptr;
+      mutable const char * _postings = nullptr;
+    };
+    ///////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	CLASS NAME : SearchIndex
+    //
+    ///////////////////////////////////////////////////////////////////
+
+    SearchIndex::SearchIndex( const Repository & repo_r, Pathname solvfile_r )
+    : _pimpl( new Impl( repo_r, std::move(solvfile_r) ) )
+    {}
+
+    SearchIndex::~SearchIndex()
+    {}
+
+    bool SearchIndex::indexes( const SolvAttr & attr_r )
+    { return attr_r == SolvAttr::summary || attr_r == SolvAttr::description || attr_r == SolvAttr::filelist; }
+
+    void SearchIndex::addTrigrams( Trigrams & trigrams_r, const std::string & literal_r )
+    { forEachTrigram( literal_r.c_str(), [&trigrams_r]( std::uint32_t trigram_r ) { trigrams_r.insert( trigram_r ); } ); }
+
+    SearchIndex::Ptr SearchIndex::get( const Repository & repo_r )
+    { return repo_r ? myPool().searchIndex( repo_r.id() ) : nullptr; }
+
+    void SearchIndex::attach( const Repository & repo_r, const Pathname & solvfile_r )
+    {
+      if ( repo_r && PathInfo( indexFile( solvfile_r ) ).isFile() )
+        myPool().setSearchIndex( repo_r.id(), Ptr( new SearchIndex( repo_r, solvfile_r ) ) );
+    }
+
+    bool SearchIndex::candidates( const std::vector<Trigrams> & alternatives_r, std::vector<Solvable> & result_r ) const
+    {
+      if ( alternatives_r.empty() || ! _pimpl->usable() )
+        return false;
+
+      std::vector<std::uint32_t> positions;
+      for ( const Trigrams & trigrams : alternatives_r )
+      {
+        if ( trigrams.empty() )
+          return false;
+
+        // Intersect starting with the rarest trigram:
+        std::vector<std::pair<std::uint32_t,std::uint32_t>> bycount;	// count, trigram
+        for ( std::uint32_t trigram : trigrams )
+          bycount.push_back( std::make_pair( _pimpl->count( trigram ), trigram ) );
+        std::sort( bycount.begin(), bycount.end() );
+
+        std::vector<std::uint32_t> matches;
+        for ( const auto & el : bycount )
+        {
+          if ( el.first == 0 )
+          {
+            matches.clear();
+            break;
+          }
+          if ( &el == &bycount.front() )
+          {
+            matches = _pimpl->postings( el.second );
+            continue;
+          }
+          const std::vector<std::uint32_t> & other( _pimpl->postings( el.second ) );
+          std::vector<std::uint32_t> tmp;
+          std::set_intersection( matches.begin(), matches.end(), other.begin(), other.end(), std::back_inserter( tmp ) );
+          matches.swap( tmp );
+          if ( matches.empty() )
+            break;
+        }
+
+        std::vector<std::uint32_t> tmp;
+        std::set_union( positions.begin(), positions.end(), matches.begin(), matches.end(), std::back_inserter( tmp ) );
+        positions.swap( tmp );
+      }
+
+      result_r.clear();
+      result_r.reserve( positions.size() );
+      detail::SolvableIdType start = _pimpl->start();
+      for ( std::uint32_t pos : positions )
+        result_r.push_back( Solvable( start + pos ) );
+      return true;
+    }
+
+    void SearchIndex::build( const Pathname & solvfile_r )
+    {
+      PathInfo solvinfo( solvfile_r );
+      std::string digest( solvDigest( solvfile_r ) );
+      if ( digest.empty() )
+      {
+        ERR << "Can't compute the digest of solv-file: " << solvfile_r << endl;
+        return;
+      }
+      AutoDispose<FILE*> solv( ::fopen( solvfile_r.c_str(), "re" ), ::fclose );
+      if ( solv == NULL )
+      {
+        solv.resetDispose();
+        ERR << "Can't open solv-file: " << solvfile_r << endl;
+        return;
+      }
+
+      // trigram -> solvable positions in repo (ascending)
+      std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> index;
+      std::uint32_t nsolvables = 0;
+      {
+        AutoDispose<detail::CPool *> pool( ::pool_create(), ::pool_free );
+        detail::CRepo * repo = ::repo_create( pool, "" );
+        if ( ::repo_add_solv( repo, solv, 0 ) != 0 )
+        {
+          ERR << "Can't read solv-file: " << ::pool_errstr( pool ) << endl;
+          return;
+        }
+        nsolvables = repo->end - repo->start;
+        if ( repo->nsolvables != int(nsolvables) )
+        {
+          ERR << "Solvables in solv-file are not contiguous: " << solvfile_r << endl;
+          return;
+        }
+
+        ::Dataiterator di;
+        ::dataiterator_init( &di, pool, repo, 0, 0, 0, 0 );
+        while ( ::dataiterator_step( &di ) )
+        {
+          ::Id keyname = di.key->name;
+          if ( ( keyname != SOLVABLE_SUMMARY && keyname != SOLVABLE_DESCRIPTION && keyname != SOLVABLE_FILELIST )
+            || di.solvid < repo->start || di.solvid >= repo->end )
+            continue;
+
+          std::uint32_t pos = di.solvid - repo->start;
+          const char * str = ( keyname == SOLVABLE_FILELIST ? ::repodata_dir2str( di.data, di.kv.id, di.kv.str )
+                                                            : ::repodata_stringify( pool, di.data, di.key, &di.kv, 0 ) );
+          forEachTrigram( str, [&index,pos]( std::uint32_t trigram_r ) {
+            std::vector<std::uint32_t> & postings( index[trigram_r] );
+            if ( postings.empty() || postings.back() != pos )	// solvables are visited in order
+              postings.push_back( pos );
+          } );
+        }
+        ::dataiterator_free( &di );
+      }
+
+      std::vector<std::uint32_t> trigrams;
+      trigrams.reserve( index.size() );
+      for ( const auto & el : index )
+        trigrams.push_back( el.first );
+      std::sort( trigrams.begin(), trigrams.end() );
+
+      Pathname file( indexFile( solvfile_r ) );
+      Pathname tmpfile( file.extend( ".new" ) );
+      {
+        std::ofstream out( tmpfile.c_str(), std::ios::binary | std::ios::trunc );
+        out.write( magic, sizeof(magic) );
+        writeTo<std::uint64_t>( out, solvinfo.size() );
+        out.write( digest.data(), digestSize );
+        writeTo<std::uint32_t>( out, nsolvables );
+        writeTo<std::uint32_t>( out, trigrams.size() );
+
+        std::string postings;
+        for ( std::uint32_t trigram : trigrams )
+        {
+          const std::vector<std::uint32_t> & positions( index[trigram] );
+          writeTo<std::uint32_t>( out, trigram );
+          writeTo<std::uint32_t>( out, positions.size() );
+          writeTo<std::uint64_t>( out, postings.size() );
+          std::uint32_t last = 0;
+          for ( std::uint32_t pos : positions )
+          {
+            appendVarint( postings, pos - last );
+            last = pos;
+          }
+        }
+        out.write( postings.data(), postings.size() );
+
+        if ( ! out.good() )
+        {
+          ERR << "Can't write search index " << tmpfile << endl;
+          filesystem::unlink( tmpfile );
+          return;
+        }
+      }
+      if ( filesystem::rename( tmpfile, file ) != 0 )
+      {
+        ERR << "Can't create search index " << file << endl;
+        filesystem::unlink( tmpfile );
+        return;
+      }
+      MIL << "Built search index " << file << " (" << trigrams.size() << " trigrams, " << nsolvables << " solvables)" << endl;
+    }
+
+    std::ostream & operator<<( std::ostream & str, const SearchIndex & obj )
+    { return str << "SearchIndex(" << obj._pimpl->_solvfile << ")"; }
+
+  } // namespace sat
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,110 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/sat/SearchIndex.h
+ */
+#ifndef ZYPP_SAT_SEARCHINDEX_H
+#define ZYPP_SAT_SEARCHINDEX_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <zypp/base/PtrTypes.h>
+#include <zypp/base/NonCopyable.h>
+#include <zypp/Pathname.h>
+#include <zypp/Repository.h>
+#include <zypp/sat/detail/PoolMember.h>
+#include <zypp/sat/SolvAttr.h>
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace sat
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class SearchIndex
+    /// \brief Trigram index of a solv files summaries, descriptions and filelists.
+    ///
+    /// The index is stored next to the solv file (\ref indexFile). It is
+    /// built by the \ref RepoManager when building the cache, if enabled in
+    /// zypp.conf (\ref ZConfig::repo_searchIndex), and attached to the
+    /// \ref Repository when the solv file is loaded. It is read on demand.
+    ///
+    /// For each (ASCII, lowercased) trigram it lists the solvables whose
+    /// summary, description or filelist (full path) contain it. A \ref PoolQuery
+    /// for these attributes uses it to shortlist the candidates before the
+    /// actual string matching is done.
+    ///
+    /// The index fits exactly one solv file, it remembers the files size
+    /// and content digest. It is ignored, if the solv file or the solvables
+    /// in the \ref Repository do not match it.
+    ///////////////////////////////////////////////////////////////////
+    class SearchIndex : protected detail::PoolMember, private base::NonCopyable
+    {
+      friend std::ostream & operator<<( std::ostream & str, const SearchIndex & obj );
+
+    public:
+      using Ptr = shared_ptr<const SearchIndex>;
+
+      /** A set of trigrams (3 ASCII chars packed into 24 bit). */
+      using Trigrams = std::set<std::uint32_t>;
+
+    public:
+      /** The index file built for \a solvfile_r. */
+      static Pathname indexFile( const Pathname & solvfile_r )
+      { return solvfile_r.extend( ".trigram" ); }
+
+      /** Build the \ref indexFile for \a solvfile_r. Errors are logged, but not reported. */
+      static void build( const Pathname & solvfile_r );
+
+      /** Whether values of \a attr_r are indexed. */
+      static bool indexes( const SolvAttr & attr_r );
+
+      /** Add the (lowercased) trigrams in \a literal_r to \a trigrams_r. */
+      static void addTrigrams( Trigrams & trigrams_r, const std::string & literal_r );
+
+      /** The index attached to \a repo_r (or \c nullptr). */
+      static Ptr get( const Repository & repo_r );
+
+      /** Attach the \ref indexFile of \a solvfile_r to \a repo_r, if it exists. */
+      static void attach( const Repository & repo_r, const Pathname & solvfile_r );
+
+    public:
+      /** Ctor remembering the \ref indexFile of \a solvfile_r to be read on demand. */
+      SearchIndex( const Repository & repo_r, Pathname solvfile_r );
+
+      /** Dtor */
+      ~SearchIndex();
+
+    public:
+      /** The solvables of the \ref Repository which may match any of \a alternatives_r.
+       * A solvable matches an alternative if all its trigrams are found in the
+       * indexed attribute values. The solvables are returned in pool order.
+       * \returns \c false if the index is not usable, or an alternative has no
+       * trigram at all, so the candidates can't be restricted.
+       */
+      bool candidates( const std::vector<Trigrams> & alternatives_r, std::vector<Solvable> & result_r ) const;
+
+    private:
+      class Impl;
+      RW_pointer<Impl> _pimpl;
+    };
+    ///////////////////////////////////////////////////////////////////
+
+    /** \relates SearchIndex Stream output */
+    std::ostream & operator<<( std::ostream & str, const SearchIndex & obj );
+
+  } // namespace sat
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_SAT_SEARCHINDEX_H
@@ -271,6 +271,37 @@ namespace zypp
         depSetDirty();	// invaldate dependency/namespace related indices
       }
 
+      void PoolImpl::solvablesChanged( SolvableIdType begin_r, SolvableIdType end_r )
+      {
+        if ( begin_r >= end_r )
+          return;
+        // Consumers not asking for a long time will have to rebuild anyway.
+        static const size_t maxChangelog = 256;
+        if ( _changelog.size() >= maxChangelog )
+        {
+          _changelog.erase( _changelog.begin(), _changelog.begin() + maxChangelog/2 );
+          _changelogBegin += maxChangelog/2;
+        }
+        _changelog.push_back( std::make_pair( begin_r, end_r ) );
+      }
+
+      void PoolImpl::solvablesChangedAll()
+      {
+        // Any changelog number handed out so far becomes unknown.
+        _changelogBegin += _changelog.size() + 1;
+        _changelog.clear();
+      }
+
+      bool PoolImpl::changedSolvables( unsigned & changelog_r, std::vector<std::pair<SolvableIdType,SolvableIdType>> & ranges_r ) const
+      {
+        unsigned latest = _changelogBegin + _changelog.size();
+        bool known = ( changelog_r >= _changelogBegin && changelog_r <= latest );
+        if ( known )
+          ranges_r.insert( ranges_r.end(), _changelog.begin() + ( changelog_r - _changelogBegin ), _changelog.end() );
+        changelog_r = latest;
+        return known;
+      }
+
       void PoolImpl::localeSetDirty( const char * a1, const char * a2, const char * a3 )
       {
         if ( a1 )
@@ -323,6 +354,12 @@ namespace zypp
         }
       }
 
+      void PoolImpl::modaliasRefresh()
+      {
+        if ( target::Modalias::instance().refresh() )
+          depSetDirty( "modalias change" );
+      }
+
       ///////////////////////////////////////////////////////////////////
 
       CRepo * PoolImpl::_createRepo( const std::string & name_r )
@@ -337,15 +374,18 @@ namespace zypp
       void PoolImpl::_deleteRepo( CRepo * repo_r )
       {
         setDirty(__FUNCTION__, repo_r->name );
+        solvablesChanged( repo_r->start, repo_r->end );
         if ( isSystemRepo( repo_r ) )
           _autoinstalled.clear();
         eraseRepoInfo( repo_r );
+        setSearchIndex( repo_r, nullptr );
         ::repo_free( repo_r, /*resusePoolIDs*/false );
         // If the last repo is removed clear the pool to actually reuse all IDs.
         // NOTE: the explicit ::repo_free above asserts all solvables are memset(0)!
         if ( !_pool->urepos )
         {
           _serialIDs.setDirty();	// Indicate resusePoolIDs - ResPool must also invalidate its PoolItems
+          solvablesChangedAll();
           ::pool_freeallrepos( _pool, /*resusePoolIDs*/true );
         }
       }
@@ -353,7 +393,9 @@ namespace zypp
       int PoolImpl::_addSolv( CRepo * repo_r, FILE * file_r )
       {
         setDirty(__FUNCTION__, repo_r->name );
+        SolvableIdType first = _pool->nsolvables;	// libsolv appends new solvables
         int ret = ::repo_add_solv( repo_r, file_r, 0 );
+        solvablesChanged( first, _pool->nsolvables );
         if ( ret == 0 )
           _postRepoAdd( repo_r );
         return ret;
@@ -362,7 +404,9 @@ namespace zypp
       int PoolImpl::_addHelix( CRepo * repo_r, FILE * file_r )
       {
         setDirty(__FUNCTION__, repo_r->name );
+        SolvableIdType first = _pool->nsolvables;	// libsolv appends new solvables
         int ret = ::repo_add_helix( repo_r, file_r, 0 );
+        solvablesChanged( first, _pool->nsolvables );
         if ( ret == 0 )
           _postRepoAdd( repo_r );
         return 0;
@@ -371,7 +415,9 @@ namespace zypp
       int PoolImpl::_addTesttags(CRepo *repo_r, FILE *file_r)
       {
         setDirty(__FUNCTION__, repo_r->name );
+        SolvableIdType first = _pool->nsolvables;	// libsolv appends new solvables
         int ret = ::testcase_add_testtags( repo_r, file_r, 0 );
+        solvablesChanged( first, _pool->nsolvables );
         if ( ret == 0 )
           _postRepoAdd( repo_r );
         return 0;
@@ -424,7 +470,9 @@ namespace zypp
       detail::SolvableIdType PoolImpl::_addSolvables( CRepo * repo_r, unsigned count_r )
       {
         setDirty(__FUNCTION__, repo_r->name );
-        return ::repo_add_solvable_block( repo_r, count_r );
+        SolvableIdType ret = ::repo_add_solvable_block( repo_r, count_r );
+        solvablesChanged( ret, ret + count_r );
+        return ret;
       }
 
       void PoolImpl::setRepoInfo( RepoIdType id_r, const RepoInfo & info_r )
@@ -452,7 +500,10 @@ namespace zypp
           }
 
           if ( dirty )
+          {
             setDirty(__FUNCTION__, info_r.alias().c_str() );
+            solvablesChanged( repo->start, repo->end );	// priorities order the Selectables
+          }
         }
         _repoinfos[id_r] = info_r;
       }
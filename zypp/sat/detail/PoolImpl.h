@@ -41,6 +41,7 @@ namespace zypp
   namespace sat
   { /////////////////////////////////////////////////////////////////
     class SolvableSet;
+    class SearchIndex;
     ///////////////////////////////////////////////////////////////////
     namespace detail
     { /////////////////////////////////////////////////////////////////
@@ -72,17 +73,33 @@ namespace zypp
           const SerialNumber & serialIDs() const
           { return _serialIDs; }
 
+          /** \ref Pool::changedSolvables */
+          bool changedSolvables( unsigned & changelog_r, std::vector<std::pair<SolvableIdType,SolvableIdType>> & ranges_r ) const;
+
           /** Update housekeeping data (e.g. whatprovides).
            * \todo actually requires a watcher.
            */
           void prepare() const;
 
+          /** Invalidate the namespace(modalias) results if devices were added or removed.
+           * Called once per solver run, as it is too expensive for each \ref prepare.
+           */
+          void modaliasRefresh();
+
         private:
           /** Invalidate housekeeping data (e.g. whatprovides) if the
            *  pools content changed.
+           *  Callers adding, removing or modifying solvables must also tell
+           *  \ref solvablesChanged.
            */
           void setDirty( const char * a1 = 0, const char * a2 = 0, const char * a3 = 0 );
 
+          /** Remember the solvable ids <tt>[begin_r,end_r)</tt> changed (\ref changedSolvables). */
+          void solvablesChanged( SolvableIdType begin_r, SolvableIdType end_r );
+
+          /** Forget the remembered changes; all solvables must be considered changed (\ref changedSolvables). */
+          void solvablesChangedAll();
+
           /** Invalidate locale related housekeeping data.
            */
           void localeSetDirty( const char * a1 = 0, const char * a2 = 0, const char * a3 = 0 );
@@ -223,6 +240,22 @@ namespace zypp
           void eraseRepoInfo( RepoIdType id_r )
           { _repoinfos.erase( id_r ); }
 
+        public:
+          /** The \ref SearchIndex attached to a repo (or \c nullptr). */
+          shared_ptr<const SearchIndex> searchIndex( RepoIdType id_r ) const
+          {
+            auto it = _searchIndexes.find( id_r );
+            return( it == _searchIndexes.end() ? nullptr : it->second );
+          }
+          /** Attach a \ref SearchIndex to a repo (\c nullptr to remove it). */
+          void setSearchIndex( RepoIdType id_r, shared_ptr<const SearchIndex> index_r )
+          {
+            if ( index_r )
+              _searchIndexes[id_r] = std::move(index_r);
+            else
+              _searchIndexes.erase( id_r );
+          }
+
         public:
           /** Returns the id stored at \c offset_r in the internal
            * whatprovidesdata array.
@@ -360,8 +393,13 @@ namespace zypp
           SerialNumber _serialIDs;
           /** Watch serial number. */
           SerialNumberWatcher _watcher;
+          /** Solvable id ranges changed (\ref changedSolvables); the 1st one is change number \c _changelogBegin+1. */
+          std::vector<std::pair<SolvableIdType,SolvableIdType>> _changelog;
+          unsigned _changelogBegin = 0;
           /** Additional \ref RepoInfo. */
           std::map<RepoIdType,RepoInfo> _repoinfos;
+          /** Additional \ref SearchIndex. */
+          std::map<RepoIdType,shared_ptr<const SearchIndex>> _searchIndexes;
 
           /**  */
           base::SetTracker<LocaleSet> _requestedLocalesTracker;
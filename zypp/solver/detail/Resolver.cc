@@ -35,6 +35,7 @@
 
 #include <zypp/ZConfig.h>
 #include <zypp/sat/Transaction.h>
+#include <zypp/pool/ItemStatusStore.h>
 
 #define MAXSOLVERRUNS 5
 
@@ -251,19 +252,15 @@ void Resolver::addWeak( const PoolItem & item )
 
 //---------------------------------------------------------------------------
 
-struct UndoTransact
+/** Reset all transacts in \a pool_r (a linear pass over the status words). */
+static void resetTransacts( const ResPool & pool_r, ResStatus::TransactByValue causer_r )
 {
-    ResStatus::TransactByValue resStatus;
-    UndoTransact ( const ResStatus::TransactByValue &status)
-        :resStatus(status)
-    { }
-
-    bool operator()( const PoolItem& item )		// only transacts() items go here
-    {
-        item.status().resetTransact( resStatus );// clear any solver/establish transactions
-        return true;
-    }
-};
+    pool_r.begin();	// assert the pools items are up to date
+    pool::ItemStatusStore::instance().forEachStatus( [causer_r]( sat::detail::SolvableIdType, ResStatus & status_r ) {
+        if ( status_r.transacts() )
+            status_r.resetTransact( causer_r );	// clear any solver/establish transactions
+    } );
+}
 
 
 struct DoTransact
@@ -284,11 +281,8 @@ struct DoTransact
 // undo
 void Resolver::undo()
 {
-    UndoTransact info(ResStatus::APPL_LOW);
     MIL << "*** undo ***" << endl;
-    invokeOnEach ( _pool.begin(), _pool.end(),
-                   resfilter::ByTransact( ),			// collect transacts from Pool to resolver queue
-                   std::ref(info) );
+    resetTransacts( _pool, ResStatus::APPL_LOW );
     //  Regard dependencies of the item weak onl
     _addWeak.clear();
 
@@ -339,10 +333,7 @@ bool Resolver::verifySystem()
 {
   DBG << "Resolver::verifySystem()" << endl;
   _verifying = true;
-  UndoTransact resetting (ResStatus::APPL_HIGH);
-  invokeOnEach ( _pool.begin(), _pool.end(),
-                 resfilter::ByTransact( ),			// Resetting all transcations
-                 std::ref(resetting) );
+  resetTransacts( _pool, ResStatus::APPL_HIGH );	// Resetting all transcations
   return resolvePool();
 }
 
@@ -41,6 +41,7 @@ extern "C"
 #include <zypp/sat/WhatProvides.h>
 #include <zypp/sat/WhatObsoletes.h>
 #include <zypp/sat/detail/PoolImpl.h>
+#include <zypp/pool/ItemStatusStore.h>
 
 #include <zypp/solver/detail/Resolver.h>
 #include <zypp/solver/detail/SATResolver.h>
@@ -448,6 +449,9 @@ SATResolver::solverInit(const PoolItemList & weakItems)
 {
     MIL << "SATResolver::solverInit()" << endl;
 
+    // Devices added or removed since the last run change namespace(modalias) results.
+    myPool().modaliasRefresh();
+
     // Remove old stuff and create a new jobqueue
     solverEnd();
     _satSolver = solver_create( _satPool );
@@ -476,7 +480,15 @@ SATResolver::solverInit(const PoolItemList & weakItems)
     // Todos are kept in _items_to_install, _items_to_remove, _items_to_lock, _items_to_keep
     {
       SATCollectTransact collector( _items_to_install, _items_to_remove, _items_to_lock, _items_to_keep, solveSrcPackages() );
-      invokeOnEach ( _pool.begin(), _pool.end(), std::ref( collector ) );
+      // A linear pass over the status words: solver/APPL_LOW results are reset in place,
+      // all other items (even KEEP_STATE ones) are queued by the collector and need the PoolItem.
+      _pool.begin();	// assert the pools items are up to date
+      pool::ItemStatusStore::instance().forEachStatus( [&]( sat::detail::SolvableIdType id_r, ResStatus & status_r ) {
+        if ( status_r.isBySolver() || status_r.isByApplLow() )
+          status_r.resetTransact( ResStatus::APPL_LOW );	// as the collector would do
+        else
+          collector( _pool.find( sat::Solvable( id_r ) ) );
+      } );
     }
 
     // Add rules for previous ProblemSolutions "break %s by ignoring some of its dependencies"
@@ -647,12 +659,12 @@ void SATResolver::solverInitSetModeJobsAndFlags()
         }
     }
     if (_removeUnneeded) {
-        invokeOnEach ( _pool.begin(), _pool.end(), [this]( const PoolItem & pi_r ) {
-          if ( pi_r.status().isUnneeded() ) {
+        _pool.begin();	// assert the pools items are up to date
+        pool::ItemStatusStore::instance().forEachStatus( [this]( sat::detail::SolvableIdType id_r, const ResStatus & status_r ) {
+          if ( status_r.isUnneeded() ) {
             queue_push( &(_jobQueue), SOLVER_ERASE | SOLVER_SOLVABLE_NAME | SOLVER_WEAK | MAYBE_CLEANDEPS );
-            queue_push( &(_jobQueue), pi_r.ident().id() );
+            queue_push( &(_jobQueue), sat::Solvable( id_r ).ident().id() );
           }
-          return true;
         } );
     }
 
@@ -22,6 +22,9 @@ using std::endl;
 
 #include <zypp/target/rpm/librpmDb.h>
 #include <zypp/repo/PackageProvider.h>
+#include <zypp/Package.h>
+#include <zypp/PathInfo.h>
+#include <zypp-core/CheckSumBatch.h>
 #include <zypp/repo/DeltaCandidates.h>
 #include <zypp/ResPool.h>
 
@@ -140,8 +143,14 @@ namespace zypp
     void CommitPackageCache::setCommitList( std::vector<sat::Solvable> commitList_r )
     { _pimpl->setCommitList( std::move(commitList_r) ); }
 
+    void CommitPackageCache::setPreloadHeaps( std::vector<std::vector<sat::Solvable>> heaps_r, shared_ptr<CommitPackagePreloader> preloader_r )
+    { _pimpl->setPreloadHeaps( std::move(heaps_r), std::move(preloader_r) ); }
+
     ManagedFile CommitPackageCache::get( const PoolItem & citem_r )
-    { return _pimpl->get( citem_r ); }
+    {
+      _pimpl->preloadHeapOf( citem_r );
+      return _pimpl->get( citem_r );
+    }
 
     bool CommitPackageCache::preloaded() const
     { return _pimpl->preloaded(); }
@@ -157,6 +166,43 @@ namespace zypp
     std::ostream & operator<<( std::ostream & str, const CommitPackageCache & obj )
     { return str << *obj._pimpl; }
 
+    std::vector<bool> packagesCached( const std::vector<sat::Solvable> & solvables_r )
+    {
+      std::vector<bool> ret( solvables_r.size(), false );
+      CheckSumBatch batch;
+      std::vector<size_t> batchIdx;	// solvable index per batch item
+
+      for ( size_t idx = 0; idx < solvables_r.size(); ++idx )
+      {
+        Package::constPtr pkg( make<Package>( solvables_r[idx] ) );
+        if ( ! pkg )
+          continue;
+
+        const OnMediaLocation & loc( pkg->location() );
+        if ( loc.checksum().empty() )
+        {
+          ret[idx] = pkg->isCached();	// may compare with the file in a local repo
+          continue;
+        }
+
+        const RepoInfo & info( pkg->repoInfo() );
+        Pathname file( info.packagesPath() / info.path() / loc.filename() );
+        if ( PathInfo( file ).isExist() )
+        {
+          batch.add( std::move(file), loc.checksum() );
+          batchIdx.push_back( idx );
+        }
+      }
+
+      if ( ! batch.empty() )
+      {
+        const std::vector<CheckSumBatch::Result> & results( batch.verify() );
+        for ( size_t i = 0; i < results.size(); ++i )
+          ret[batchIdx[i]] = results[i].ok();
+      }
+      return ret;
+    }
+
     /////////////////////////////////////////////////////////////////
   } // namespace target
   ///////////////////////////////////////////////////////////////////
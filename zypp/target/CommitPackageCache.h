@@ -13,6 +13,7 @@
 #define ZYPP_TARGET_COMMITPACKAGECACHE_H
 
 #include <iosfwd>
+#include <vector>
 
 #include <zypp/base/PtrTypes.h>
 #include <zypp/base/Function.h>
@@ -28,6 +29,8 @@ namespace zypp
   namespace target
   { /////////////////////////////////////////////////////////////////
 
+    class CommitPackagePreloader;
+
     ///////////////////////////////////////////////////////////////////
     /// \class RepoProvidePackage
     /// \short Default PackageProvider for \ref CommitPackageCache
@@ -82,6 +85,12 @@ namespace zypp
       void setCommitList( TIterator begin_r, TIterator end_r )
       { setCommitList( std::vector<sat::Solvable>( begin_r, end_r  ) ); }
 
+      /** Heaps of packages to preload concurrently.
+       * The whole heap is preloaded by \a preloader_r as soon as one of
+       * its packages is requested via \ref get.
+       */
+      void setPreloadHeaps( std::vector<std::vector<sat::Solvable>> heaps_r, shared_ptr<CommitPackagePreloader> preloader_r );
+
       /** Provide a package. */
       ManagedFile get( const PoolItem & citem_r );
       /** \overload */
@@ -110,6 +119,13 @@ namespace zypp
     /** \relates CommitPackageCache Stream output */
     std::ostream & operator<<( std::ostream & str, const CommitPackageCache & obj );
 
+    /** \relates CommitPackageCache Which of \a solvables_r are packages already in the package cache.
+     * The same as asking \ref Package::isCached for each of them, but the
+     * checksums of the cached files are verified concurrently (\see \ref CheckSumBatch).
+     * \returns One flag per solvable.
+     */
+    std::vector<bool> packagesCached( const std::vector<sat::Solvable> & solvables_r );
+
     /////////////////////////////////////////////////////////////////
   } // namespace target
   ///////////////////////////////////////////////////////////////////
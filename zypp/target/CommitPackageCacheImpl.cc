@@ -13,6 +13,7 @@
 #include <zypp/base/Logger.h>
 
 #include <zypp/target/CommitPackageCacheImpl.h>
+#include <zypp/target/CommitPackagePreloader.h>
 
 using std::endl;
 
@@ -23,7 +24,37 @@ namespace zypp
   namespace target
   { /////////////////////////////////////////////////////////////////
 
+    void CommitPackageCache::Impl::setPreloadHeaps( std::vector<std::vector<sat::Solvable>> heaps_r, shared_ptr<CommitPackagePreloader> preloader_r )
+    {
+      _preloadHeaps = std::move(heaps_r);
+      _preloader = std::move(preloader_r);
+      _preloadHeapOf.clear();
+      for ( unsigned idx = 0; idx < _preloadHeaps.size(); ++idx )
+      {
+        for ( const sat::Solvable & solv : _preloadHeaps[idx] )
+          _preloadHeapOf[solv.id()] = idx;
+      }
+      MIL << "Preload " << _preloadHeaps.size() << " heap(s) with " << _preloadHeapOf.size() << " packages" << endl;
+    }
 
+    void CommitPackageCache::Impl::preloadHeapOf( const PoolItem & citem_r )
+    {
+      if ( ! _preloader )
+        return;
+
+      auto it = _preloadHeapOf.find( citem_r.satSolvable().id() );
+      if ( it == _preloadHeapOf.end() )
+        return;
+
+      std::vector<sat::Solvable> & heap( _preloadHeaps[it->second] );
+      if ( heap.empty() )
+        return;	// already preloaded
+
+      MIL << "Preload heap " << it->second+1 << "/" << _preloadHeaps.size() << endl;
+      std::vector<sat::Solvable> todo;
+      todo.swap( heap );	// never twice, even if the preloader throws
+      _preloader->preload( todo );
+    }
 
     /////////////////////////////////////////////////////////////////
   } // namespace target
@@ -14,6 +14,7 @@
 
 #include <iosfwd>
 #include <utility>
+#include <unordered_map>
 
 #include <zypp/base/Logger.h>
 #include <zypp/base/Exception.h>
@@ -65,6 +66,11 @@ namespace zypp
       const std::vector<sat::Solvable> & commitList() const
       { return _commitList; }
 
+      void setPreloadHeaps( std::vector<std::vector<sat::Solvable>> heaps_r, shared_ptr<CommitPackagePreloader> preloader_r );
+
+      /** Preload the heap containing \a citem_r unless this was already done. */
+      void preloadHeapOf( const PoolItem & citem_r );
+
       bool preloaded() const
       { return _preloaded; }
 
@@ -104,6 +110,10 @@ namespace zypp
       std::vector<sat::Solvable> _commitList;
       PackageProvider _packageProvider;
       DefaultIntegral<bool,false> _preloaded;
+
+      std::vector<std::vector<sat::Solvable>> _preloadHeaps;
+      std::unordered_map<sat::detail::SolvableIdType,unsigned> _preloadHeapOf;	///< index into _preloadHeaps
+      shared_ptr<CommitPackagePreloader> _preloader;
     };
     ///////////////////////////////////////////////////////////////////
 
@@ -100,6 +100,7 @@ namespace zypp
 
       // Collect all remaining packages to install from
       // _lastInteractive media. (just the PoolItem data)
+      std::vector<sat::Solvable> todo;
       for_( it, commitList().begin(), commitList().end() )
       {
         PoolItem pi( *it );
@@ -113,17 +114,24 @@ namespace zypp
           && pi.status().isToBeInstalled()
           && isKind<Package>(pi.resolvable()) )
         {
-          if ( ! pi->asKind<Package>()->isCached() )
+          todo.push_back( pi.satSolvable() );
+        }
+      }
+
+      // The packages already cached are checked at once.
+      const std::vector<bool> & cached( packagesCached( todo ) );
+      for ( size_t idx = 0; idx < todo.size(); ++idx )
+      {
+        if ( ! cached[idx] )
+        {
+          ManagedFile fromSource( sourceProvidePackage( PoolItem( todo[idx] ) ) );
+          if ( fromSource->empty() )
           {
-            ManagedFile fromSource( sourceProvidePackage( pi ) );
-            if ( fromSource->empty() )
-            {
-              ERR << "Copy to cache failed on " << fromSource << endl;
-              ZYPP_THROW( Exception("Copy to cache failed.") );
-            }
-            fromSource.resetDispose(); // keep the package file in the cache
-            ++addToCache;
+            ERR << "Copy to cache failed on " << fromSource << endl;
+            ZYPP_THROW( Exception("Copy to cache failed.") );
           }
+          fromSource.resetDispose(); // keep the package file in the cache
+          ++addToCache;
         }
       }
 
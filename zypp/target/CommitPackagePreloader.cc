@@ -0,0 +1,664 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/target/CommitPackagePreloader.cc
+ *
+*/
+#include <iostream>
+#include <fstream>
+#include <list>
+#include <map>
+#include <deque>
+#include <optional>
+#include <thread>
+
+#include <zypp/base/LogTools.h>
+#include <zypp-core/base/UserRequestException>
+#include <zypp/ZConfig.h>
+#include <zypp/ZYppCallbacks.h>
+#include <zypp/Package.h>
+#include <zypp/RepoInfo.h>
+#include <zypp/RepoManagerOptions.h>
+#include <zypp/ResPool.h>
+#include <zypp/PathInfo.h>
+#include <zypp-core/CheckSumBatch.h>
+#include <zypp/TmpPath.h>
+#include <zypp/repo/Applydeltarpm.h>
+#include <zypp/repo/DeltaCandidates.h>
+#include <zypp/target/rpm/RpmDb.h>
+#include <zypp/target/CommitPackageCache.h>
+#include <zypp/target/CommitPackagePreloader.h>
+
+#include <zypp-core/zyppng/base/EventLoop>
+#include <zypp-core/zyppng/base/EventDispatcher>
+#include <zypp-core/zyppng/io/Process>
+#include <zypp-media/ng/Provide>
+#include <zypp-media/ng/ProvideSpec>
+#include <zypp-media/auth/CredentialManager>
+
+using std::endl;
+
+#undef  ZYPP_BASE_LOGGER_LOGGROUP
+#define ZYPP_BASE_LOGGER_LOGGROUP "zypp::commit::preload"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace target
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class CommitPackagePreloader::Impl
+    /// \brief CommitPackagePreloader implementation.
+    ///////////////////////////////////////////////////////////////////
+    class CommitPackagePreloader::Impl
+    {
+      using RpmDb    = rpm::RpmDb;
+      using UserData = callback::UserData;
+      using ProvideOpRef = zyppng::AsyncOpRef<zyppng::expected<zyppng::ProvideRes>>;
+
+      /** A single package download. */
+      struct Job
+      {
+        Package::constPtr _package;
+        std::vector<Url>  _urls;	///< the package on each of the repos baseurls
+        ProvideOpRef      _op;
+        std::optional<zyppng::ProvideRes> _res;	///< the downloaded file until it is cached
+        zyppng::Process::Ptr     _verify;	///< the signature check running in the background
+        std::vector<std::string> _verifyOutput;
+        int                      _verifyStatus = -1;
+        std::optional<packagedelta::DeltaRpm> _delta;	///< download this deltarpm and build the package from it
+        zyppng::Process::Ptr     _apply;	///< applydeltarpm running in the background
+        int                      _applyStatus = -1;
+        Pathname                 _built;	///< the package built from the deltarpm until it is cached
+
+        /** The package file to check and cache. */
+        const Pathname & file() const
+        { return _built.empty() ? _res->file() : _built; }
+      };
+
+    public:
+      Impl( RpmDb & rpmDb_r, unsigned parallel_r )
+      : _rpmDb( rpmDb_r )
+      , _parallel( parallel_r ? parallel_r : 1 )
+      {
+        const ResPool & pool( ResPool::instance() );
+        _repos.insert( _repos.begin(), pool.knownRepositoriesBegin(), pool.knownRepositoriesEnd() );
+      }
+
+      unsigned parallel() const
+      { return _parallel; }
+
+      void setWorkerPath( const Pathname & path_r )
+      { _workerPath = path_r; }
+
+      unsigned preload( const std::vector<sat::Solvable> & heap_r );
+
+    private:
+      /** Whether \a pkg_r should be preloaded or left to the \ref repo::PackageProvider.
+       * Whether it is already cached is checked separately for the whole heap.
+       * If the package can be built from a deltarpm, it is returned in \a delta_r.
+       */
+      bool wantPreload( const Package::constPtr & pkg_r, std::optional<packagedelta::DeltaRpm> & delta_r ) const;
+
+      /** Whether a package matching \a pkg_r name and arch with edition \a ed_r is installed (any if \c noedition). */
+      bool isInstalled( const Package::constPtr & pkg_r, const Edition & ed_r ) const;
+
+      /** Whether the downloaded \a file_r matches the checksum of \a loc_r in the repo metadata. */
+      bool checksumJob( const Job & job_r, const OnMediaLocation & loc_r, const Pathname & file_r ) const;
+
+      /** Build the package from the downloaded deltarpm of \a job_r in a separate process.
+       * The on-disk data are quick checked first. If the check fails, the jobs deltarpm
+       * is reset. Calls \a done_r when applydeltarpm has finished.
+       * \returns \c false if applydeltarpm could not be started.
+       */
+      bool startApply( Job & job_r, unsigned idx_r, std::function<void()> done_r ) const;
+
+      /** Run applydeltarpm \a cmd_r for \a job_r in a separate process.
+       * Calls \a finished_r with the exit code.
+       * \returns \c false if applydeltarpm could not be started.
+       */
+      bool startApplydeltarpm( Job & job_r, const std::vector<std::string> & cmd_r, std::function<void(int)> finished_r ) const;
+
+      /** Whether \a job_r needs to pass the rpm signature check. */
+      bool wantVerify( const Job & job_r ) const
+      { return job_r._package->repoInfo().pkgGpgCheck(); }
+
+      /** Run the signature check of the downloaded \a job_r in a separate process.
+       * Calls \a done_r when the check has finished.
+       * \returns \c false if the check could not be started.
+       */
+      bool startVerify( Job & job_r, std::function<void()> done_r ) const;
+
+      /** Evaluate the signature check of the downloaded \a job_r and move it into the package cache.
+       * If no check was run in the background, the signature is checked here.
+       * \returns Whether the package was cached.
+       */
+      bool cacheJob( const Job & job_r );
+
+      /** Report a cached package as a complete \ref repo::DownloadResolvableReport sequence.
+       * \returns \c false if the user wants to abort.
+       */
+      bool reportJob( const Job & job_r, const Pathname & cachedest_r, const UserData & userData_r ) const;
+
+    private:
+      RpmDb &               _rpmDb;
+      unsigned              _parallel;
+      std::list<Repository> _repos;	///< for delta lookup
+      Pathname              _buildDir;	///< where packages are built from deltarpms
+      Pathname              _workerPath;	///< if not empty, overrides the Provide workers path
+    };
+
+    bool CommitPackagePreloader::Impl::wantPreload( const Package::constPtr & pkg_r, std::optional<packagedelta::DeltaRpm> & delta_r ) const
+    {
+      const RepoInfo & info( pkg_r->repoInfo() );
+      if ( info.baseUrlsEmpty() || ! info.url().schemeIsDownloading() )
+        return false;	// local and interactive media are handled by CommitPackageCacheReadAhead
+
+      if ( pkg_r->mediaNr() > 1 )
+        return false;	// needs media rewriting in RepoMediaAccess
+
+      if ( info.packagesPath().dirname() != RepoManagerOptions().repoPackagesCachePath )
+        return false;	// PackageProvider looks into the toplevel cache first
+
+      // Like the PackageProvider we take the first deltarpm whose base version is installed.
+      // Applydeltarpm's quick check of the on-disk data is done in the background (see startApply).
+      delta_r.reset();
+      if ( ZConfig::instance().download_use_deltarpm() && applydeltarpm::haveApplydeltarpm() )
+      {
+        const std::list<packagedelta::DeltaRpm> & deltas( repo::DeltaCandidates( _repos, pkg_r->name() ).deltaRpms( pkg_r ) );
+        if ( ! deltas.empty() && isInstalled( pkg_r, Edition::noedition ) )
+        {
+          for ( const packagedelta::DeltaRpm & delta : deltas )
+          {
+            if ( delta.baseversion().edition() != Edition::noedition && ! isInstalled( pkg_r, delta.baseversion().edition() ) )
+              continue;
+
+            const RepoInfo & dinfo( delta.repository().info() );
+            if ( dinfo.baseUrlsEmpty() || ! dinfo.url().schemeIsDownloading() )
+              return false;	// leave it to the PackageProvider
+            delta_r = delta;
+            break;
+          }
+        }
+      }
+
+      return true;
+    }
+
+    bool CommitPackagePreloader::Impl::isInstalled( const Package::constPtr & pkg_r, const Edition & ed_r ) const
+    {
+      for ( const PoolItem & pi : ResPool::instance().byIdent( pkg_r->satSolvable() ) )
+      {
+        if ( pi.satSolvable().isSystem() && pi.arch() == pkg_r->arch()
+          && ( ed_r == Edition::noedition || pi.edition() == ed_r ) )
+          return true;
+      }
+      return false;
+    }
+
+    bool CommitPackagePreloader::Impl::checksumJob( const Job & job_r, const OnMediaLocation & loc_r, const Pathname & file_r ) const
+    {
+      if ( ! loc_r.checksum().empty()
+        && loc_r.checksum() != CheckSumBatch::compute( file_r, loc_r.checksum().type() ) )
+      {
+        WAR << job_r._package << ": checksum mismatch of " << loc_r.filename() << ". Leave it to the PackageProvider." << endl;
+        return false;
+      }
+      return true;
+    }
+
+    bool CommitPackagePreloader::Impl::startApply( Job & job_r, unsigned idx_r, std::function<void()> done_r ) const
+    {
+      Job * job = &job_r;	// jobs are not moved while the event loop is running
+      Pathname built( _buildDir / ( str::numstring( idx_r ) + "-" + job_r._package->location().filename().basename() ) );
+      return startApplydeltarpm( job_r, applydeltarpm::checkCommand( job_r._delta->baseversion().sequenceinfo(), true ), [this,job,built,done_r]( int code_r ) {
+        if ( code_r != 0 )
+        {
+          WAR << job->_package << ": applydeltarpm quick check failed (" << code_r << "). Don't use " << *job->_delta << endl;
+          job->_delta.reset();
+          job->_applyStatus = code_r;
+          done_r();
+          return;
+        }
+        // we are called from the check process, keep it alive until we return
+        zyppng::EventDispatcher::unrefLater( job->_apply );
+        job->_built = built;
+        bool started = startApplydeltarpm( *job, applydeltarpm::provideCommand( job->_res->file(), job->_built ), [job,done_r]( int code_r ) {
+          job->_applyStatus = code_r;
+          done_r();
+        });
+        if ( ! started )
+        {
+          job->_applyStatus = -1;
+          done_r();
+        }
+      });
+    }
+
+    bool CommitPackagePreloader::Impl::startApplydeltarpm( Job & job_r, const std::vector<std::string> & cmd_r, std::function<void(int)> finished_r ) const
+    {
+      std::vector<const char *> argv;
+      argv.reserve( cmd_r.size() + 1 );
+      for ( const std::string & arg : cmd_r )
+        argv.push_back( arg.c_str() );
+      argv.push_back( nullptr );
+
+      zyppng::Process::Ptr prog = zyppng::Process::create();
+      prog->setOutputChannelMode( zyppng::Process::Merged );
+
+      zyppng::Process * proc = prog.get();
+      const auto readOutput = [proc]() {
+        while ( proc->canReadLine( zyppng::Process::StdOut ) )
+          DBG << "Applydeltarpm : " << proc->channelReadLine( zyppng::Process::StdOut ).asString();
+      };
+      prog->connectFunc( &zyppng::IODevice::sigChannelReadyRead, [readOutput]( uint ) { readOutput(); } );
+      prog->connectFunc( &zyppng::Process::sigFinished, [readOutput,finished_r]( int code_r ) {
+        readOutput();
+        finished_r( code_r );
+      });
+
+      job_r._apply = prog;
+      if ( ! prog->start( argv.data() ) )
+      {
+        WAR << job_r._package << ": can't run applydeltarpm in the background: " << prog->execError() << endl;
+        job_r._apply.reset();
+        return false;
+      }
+      return true;
+    }
+
+    bool CommitPackagePreloader::Impl::startVerify( Job & job_r, std::function<void()> done_r ) const
+    {
+      const std::vector<std::string> cmd( _rpmDb.checkPackageSignatureCommand( job_r.file() ) );
+      std::vector<const char *> argv;
+      argv.reserve( cmd.size() + 1 );
+      for ( const std::string & arg : cmd )
+        argv.push_back( arg.c_str() );
+      argv.push_back( nullptr );
+
+      zyppng::Process::Ptr prog = zyppng::Process::create();
+      prog->setUseDefaultLocale( true );	// rpm output is parsed
+      prog->setOutputChannelMode( zyppng::Process::Merged );
+
+      Job * job = &job_r;	// jobs are not moved while the event loop is running
+      const auto readOutput = [job]() {
+        while ( job->_verify->canReadLine( zyppng::Process::StdOut ) )
+        {
+          std::string l { job->_verify->channelReadLine( zyppng::Process::StdOut ).asString() };
+          if ( ! l.empty() && l.back() == '\n' )
+            l.pop_back();
+          job->_verifyOutput.push_back( std::move(l) );
+        }
+      };
+      prog->connectFunc( &zyppng::IODevice::sigChannelReadyRead, [readOutput]( uint ) { readOutput(); } );
+      prog->connectFunc( &zyppng::Process::sigFinished, [job,readOutput,done_r]( int code_r ) {
+        readOutput();
+        job->_verifyStatus = code_r;
+        done_r();
+      });
+
+      job_r._verify = prog;
+      job_r._verifyOutput.clear();
+      if ( ! prog->start( argv.data() ) )
+      {
+        WAR << job_r._package << ": can't run the signature check in the background: " << prog->execError() << endl;
+        job_r._verify.reset();
+        return false;
+      }
+      return true;
+    }
+
+    bool CommitPackagePreloader::Impl::cacheJob( const Job & job_r )
+    {
+      const Package::constPtr & pkg( job_r._package );
+      const OnMediaLocation & loc( pkg->location() );
+      const RepoInfo & info( pkg->repoInfo() );
+      const Pathname & file( job_r.file() );
+
+      UserData userData( "pkgGpgCheck" );
+      if ( wantVerify( job_r ) )
+      {
+        RpmDb::CheckPackageDetail detail;
+        RpmDb::CheckPackageResult res = job_r._verify
+                                      ? _rpmDb.checkPackageSignatureResult( file, job_r._verifyStatus, job_r._verifyOutput, detail )
+                                      : _rpmDb.checkPackageSignature( file, detail );
+        if ( res == RpmDb::CHK_NOSIG && ! info.pkgGpgCheckIsMandatory() )
+        {
+          WAR << "Relax CHK_NOSIG: Config says unsigned packages are OK" << endl;
+          res = RpmDb::CHK_OK;
+        }
+        if ( res != RpmDb::CHK_OK )
+        {
+          // Missing keys and bad signatures need user interaction.
+          WAR << pkg << ": signature check " << res << ". Leave it to the PackageProvider." << endl;
+          return false;
+        }
+        ResObject::constPtr roptr( pkg );
+        userData.set( "ResObject", roptr );
+        /*legacy:*/userData.set( "Package", pkg );
+        userData.set( "CheckPackageResult", res );
+        userData.set( "CheckPackageDetail", std::move(detail) );
+      }
+
+      Pathname cachedest( info.packagesPath() / info.path() / loc.filename() );
+      if ( filesystem::assert_dir( cachedest.dirname() ) != 0 || filesystem::hardlinkCopy( file, cachedest ) != 0 )
+      {
+        WAR << pkg << ": can't hardlink/copy " << file << " to " << cachedest << endl;
+        return false;
+      }
+
+      if ( ! reportJob( job_r, cachedest, userData ) )
+        ZYPP_THROW( AbortRequestException( "User requested to abort" ) );
+      return true;
+    }
+
+    bool CommitPackagePreloader::Impl::reportJob( const Job & job_r, const Pathname & cachedest_r, const UserData & userData_r ) const
+    {
+      // Downloads finish in any order but the report is sent for one package
+      // at a time, as applications expect it.
+      callback::SendReport<repo::DownloadResolvableReport> report;
+      report->start( job_r._package, job_r._urls.front() );
+      if ( job_r._delta )
+      {
+        report->startDeltaApply( job_r._delta->location().filename() );
+        report->progressDeltaApply( 100 );
+        report->finishDeltaApply();
+      }
+      if ( userData_r.haskey( "CheckPackageResult" ) )
+      {
+        UserData userData( userData_r );
+        userData.set( "Localpath", cachedest_r );
+        report->pkgGpgCheck( userData );
+      }
+      bool ret = report->progress( 100, job_r._package );
+      report->finish( job_r._package, repo::DownloadResolvableReport::NO_ERROR, std::string() );
+      return ret;
+    }
+
+    unsigned CommitPackagePreloader::Impl::preload( const std::vector<sat::Solvable> & heap_r )
+    {
+      std::vector<sat::Solvable> candidates;
+      std::vector<std::optional<packagedelta::DeltaRpm>> deltas;
+      for ( const sat::Solvable & solv : heap_r )
+      {
+        if ( ! solv.isKind<Package>() )
+          continue;
+        Package::constPtr pkg( make<Package>( solv ) );
+        std::optional<packagedelta::DeltaRpm> delta;
+        if ( pkg && wantPreload( pkg, delta ) )
+        {
+          candidates.push_back( solv );
+          deltas.push_back( std::move(delta) );
+        }
+      }
+
+      // Packages already in the cache need no preload. They are checked at once.
+      const std::vector<bool> & inCache( packagesCached( candidates ) );
+      std::vector<Job> jobs;
+      for ( size_t idx = 0; idx < candidates.size(); ++idx )
+      {
+        if ( inCache[idx] )
+          continue;
+
+        Package::constPtr pkg( make<Package>( candidates[idx] ) );
+        Job job;
+        job._package = pkg;
+        job._delta = std::move( deltas[idx] );
+        const RepoInfo & info( pkg->repoInfo() );
+        for ( Url url : info.baseUrls() )
+        {
+          url.appendPathName( info.path() / pkg->location().filename() );
+          job._urls.push_back( std::move(url) );
+        }
+        jobs.push_back( std::move(job) );
+      }
+      if ( jobs.empty() )
+        return 0;
+
+      // Signature checks and building packages from deltarpms run in separate
+      // processes while the downloads go on. Both share the same limit.
+      const unsigned maxVerify = std::max( std::thread::hardware_concurrency(), 1U );
+      MIL << "Preload " << jobs.size() << " of " << heap_r.size() << " packages (" << _parallel << " parallel, " << maxVerify << " checks)" << endl;
+
+      const Pathname & cacheRoot( ZConfig::instance().repoPackagesPath() );
+      filesystem::assert_dir( cacheRoot );	// downloaded files should be on the same fs as the cache
+      filesystem::TmpDir workdir( cacheRoot, ".preload." );
+      _buildDir = workdir.path() / "built";
+      filesystem::assert_dir( _buildDir );
+
+      zyppng::EventLoopRef loop = zyppng::EventLoop::create();
+      zyppng::ProvideRef provider = zyppng::Provide::create( workdir.path() );
+      provider->setCredManagerOptions( media::CredManagerOptions( ZConfig::instance().repoManagerRoot() ) );
+      if ( ! _workerPath.empty() )
+        provider->setWorkerPath( _workerPath );
+      provider->start();
+
+      const unsigned perRepo = std::max( ZConfig::instance().download_max_concurrent_connections(), 1L );
+      std::map<Repository::IdType,unsigned> runningPerRepo;
+      std::vector<bool> started( jobs.size(), false );
+      unsigned firstPending = 0;
+      unsigned running = 0;
+      unsigned done = 0;
+      std::deque<unsigned> toVerify;
+      unsigned verifying = 0;
+      std::deque<unsigned> toApply;
+      unsigned applying = 0;
+      unsigned cached = 0;
+      bool abort = false;
+      std::exception_ptr abortExcpt;
+
+      const auto dropJob = [&]( unsigned idx ) {
+        Job & job( jobs[idx] );
+        job._verify.reset();
+        job._verifyOutput.clear();
+        job._apply.reset();
+        job._res.reset();	// releases the downloaded file
+        if ( ! job._built.empty() )
+        {
+          filesystem::unlink( job._built );
+          job._built = Pathname();
+        }
+      };
+
+      const auto finishJob = [&]( unsigned idx ) {
+        Job & job( jobs[idx] );
+        if ( ! abort )
+        {
+          try
+          {
+            if ( cacheJob( job ) )
+              ++cached;
+          }
+          catch ( const AbortRequestException & excpt )
+          {
+            WAR << "Preload aborted by the user" << endl;
+            abort = true;
+            abortExcpt = std::current_exception();
+          }
+        }
+        dropJob( idx );
+      };
+
+      // The package file is ready to be checked and cached.
+      const auto checkJob = [&]( unsigned idx ) {
+        if ( wantVerify( jobs[idx] ) )
+          toVerify.push_back( idx );
+        else
+          finishJob( idx );
+      };
+
+      std::function<void()> schedule;
+      schedule = [&]() {
+        if ( ! abort )
+        {
+          while ( ! toVerify.empty() && verifying + applying < maxVerify )
+          {
+            unsigned idx = toVerify.front();
+            toVerify.pop_front();
+            bool started = startVerify( jobs[idx], [&,idx]() {
+              // Don't destroy the process from within its own signal.
+              zyppng::EventDispatcher::invokeOnIdle( [&,idx]() {
+                --verifying;
+                finishJob( idx );
+                schedule();
+                return false;
+              });
+            });
+            if ( started )
+              ++verifying;
+            else
+              finishJob( idx );	// checks in-process
+          }
+
+          while ( ! toApply.empty() && verifying + applying < maxVerify )
+          {
+            unsigned idx = toApply.front();
+            toApply.pop_front();
+            bool launched = startApply( jobs[idx], idx, [&,idx]() {
+              // Don't destroy the process from within its own signal.
+              zyppng::EventDispatcher::invokeOnIdle( [&,idx]() {
+                --applying;
+                Job & job( jobs[idx] );
+                job._apply.reset();
+                job._res.reset();	// releases the deltarpm
+                if ( job._applyStatus != 0 && ! job._delta && ! abort )
+                {
+                  // the quick check failed: download the package instead
+                  dropJob( idx );
+                  started[idx] = false;
+                  firstPending = std::min( firstPending, idx );
+                  --done;
+                }
+                else if ( job._applyStatus != 0 )
+                {
+                  WAR << job._package << ": applydeltarpm failed (" << job._applyStatus << "). Leave it to the PackageProvider." << endl;
+                  dropJob( idx );
+                }
+                else if ( abort || ! checksumJob( job, job._package->location(), job._built ) )
+                  dropJob( idx );
+                else
+                  checkJob( idx );
+                schedule();
+                return false;
+              });
+            });
+            if ( launched )
+              ++applying;
+            else
+              dropJob( idx );
+          }
+
+          for ( unsigned idx = firstPending; idx < jobs.size() && running < _parallel; ++idx )
+          {
+            if ( started[idx] )
+            {
+              if ( idx == firstPending )
+                ++firstPending;
+              continue;
+            }
+
+            Job & job( jobs[idx] );
+            unsigned & repoRunning( runningPerRepo[job._package->repository().id()] );
+            if ( repoRunning >= perRepo )
+              continue;
+
+            started[idx] = true;
+            ++repoRunning;
+            ++running;
+            if ( job._delta )
+            {
+              DBG << "Start " << job._package << " from " << *job._delta << endl;
+              const RepoInfo & dinfo( job._delta->repository().info() );
+              std::vector<Url> durls;
+              for ( Url url : dinfo.baseUrls() )
+              {
+                url.appendPathName( dinfo.path() / job._delta->location().filename() );
+                durls.push_back( std::move(url) );
+              }
+              job._op = provider->provide( durls, zyppng::ProvideFileSpec( job._delta->location() ) );
+            }
+            else
+            {
+              DBG << "Start " << job._package << endl;
+              job._op = provider->provide( job._urls, zyppng::ProvideFileSpec( job._package->location() ) );
+            }
+            job._op->onReady( [&,idx]( zyppng::expected<zyppng::ProvideRes> && res_r ) {
+              const Job & doneJob( jobs[idx] );
+              --runningPerRepo[doneJob._package->repository().id()];
+              --running;
+              ++done;
+
+              const OnMediaLocation & loc( doneJob._delta ? doneJob._delta->location() : doneJob._package->location() );
+              if ( ! res_r )
+              {
+                try { std::rethrow_exception( res_r.error() ); }
+                catch ( const Exception & excpt )
+                { ZYPP_CAUGHT( excpt ); }
+                catch ( ... )
+                {}
+                WAR << "Failed to preload " << doneJob._package << ". Leave it to the PackageProvider." << endl;
+              }
+              else if ( ! abort && checksumJob( doneJob, loc, res_r->file() ) )
+              {
+                jobs[idx]._res = std::move( res_r.get() );
+                if ( doneJob._delta )
+                  toApply.push_back( idx );
+                else
+                  checkJob( idx );
+              }
+
+              // Don't recurse into schedule from within a (maybe synchronous) onReady.
+              zyppng::EventDispatcher::invokeOnIdle( [&]() {
+                schedule();
+                return false;
+              });
+            });
+          }
+        }
+
+        if ( ! running && ! verifying && ! applying && ( abort || done == jobs.size() ) )
+          loop->quit();
+      };
+
+      zyppng::EventDispatcher::invokeOnIdle( [&]() {
+        schedule();
+        return false;
+      });
+      loop->run();
+
+      MIL << "Preloaded " << cached << " of " << jobs.size() << " packages." << endl;
+      if ( abortExcpt )
+        std::rethrow_exception( abortExcpt );
+      return cached;
+    }
+
+    ///////////////////////////////////////////////////////////////////
+    //	class CommitPackagePreloader
+    ///////////////////////////////////////////////////////////////////
+
+    CommitPackagePreloader::CommitPackagePreloader( rpm::RpmDb & rpmDb_r, unsigned parallel_r )
+    : _pimpl( new Impl( rpmDb_r, parallel_r ) )
+    {}
+
+    CommitPackagePreloader::~CommitPackagePreloader()
+    {}
+
+    unsigned CommitPackagePreloader::parallel() const
+    { return _pimpl->parallel(); }
+
+    void CommitPackagePreloader::setWorkerPath( const Pathname & path_r )
+    { _pimpl->setWorkerPath( path_r ); }
+
+    unsigned CommitPackagePreloader::preload( const std::vector<sat::Solvable> & heap_r )
+    { return _pimpl->preload( heap_r ); }
+
+  } // namespace target
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
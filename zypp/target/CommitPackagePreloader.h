@@ -0,0 +1,92 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/target/CommitPackagePreloader.h
+ *
+*/
+#ifndef ZYPP_TARGET_COMMITPACKAGEPRELOADER_H
+#define ZYPP_TARGET_COMMITPACKAGEPRELOADER_H
+
+#include <vector>
+
+#include <zypp/base/PtrTypes.h>
+#include <zypp/Pathname.h>
+#include <zypp/sat/Solvable.h>
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace target
+  {
+    namespace rpm
+    {
+      class RpmDb;
+    }
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class CommitPackagePreloader
+    /// \brief Concurrently download packages into the repositories package cache.
+    ///
+    /// Used by \ref CommitPackageCache to preload a heap of packages before
+    /// they are needed by the commit. Packages are downloaded via a
+    /// \ref zyppng::Provide instance which multiplexes the requests across its
+    /// workers. At most \ref parallel downloads are running at the same time,
+    /// and at most \c download.max_concurrent_connections of them from the
+    /// same repository.
+    ///
+    /// Each finished download is checked against the checksum in the repo
+    /// metadata and, if the repo demands it, the rpm signature is checked.
+    /// Signature checks run as separate processes (see
+    /// \ref rpm::RpmDb::checkPackageSignatureCommand) while the remaining
+    /// downloads go on.
+    /// Packages passing all checks are moved into the cache and reported
+    /// as a complete \ref repo::DownloadResolvableReport sequence.
+    ///
+    /// If a package can be built from a deltarpm (its base version is
+    /// installed), the deltarpm is downloaded instead and \c applydeltarpm
+    /// builds the package in a separate process. These processes share the
+    /// limit of concurrent signature checks.
+    ///
+    /// The preloader never asks the user. Packages failing to download,
+    /// to build or failing a check are simply not cached, so the regular
+    /// (serial) \ref repo::PackageProvider will handle them including all
+    /// the problem reports and user interaction.
+    ///////////////////////////////////////////////////////////////////
+    class CommitPackagePreloader
+    {
+    public:
+      /** Ctor. \a rpmDb_r is used to check the package signatures. */
+      CommitPackagePreloader( rpm::RpmDb & rpmDb_r, unsigned parallel_r );
+
+      ~CommitPackagePreloader();
+
+    public:
+      /** Max. number of concurrent downloads. */
+      unsigned parallel() const;
+
+      /** Use the \ref zyppng::Provide workers in \a path_r instead of the default ones (testing). */
+      void setWorkerPath( const Pathname & path_r );
+
+      /** Download all not yet cached packages in \a heap_r.
+       * \returns The number of packages which were successfully preloaded.
+       */
+      unsigned preload( const std::vector<sat::Solvable> & heap_r );
+
+    public:
+      class Impl;              ///< Implementation class.
+    private:
+      RW_pointer<Impl> _pimpl; ///< Pointer to implementation.
+    };
+    ///////////////////////////////////////////////////////////////////
+
+  } // namespace target
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_TARGET_COMMITPACKAGEPRELOADER_H
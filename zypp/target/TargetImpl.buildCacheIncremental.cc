@@ -0,0 +1,162 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file zypp/target/TargetImpl.buildCacheIncremental.cc
+ */
+extern "C"
+{
+#include <solv/pool.h>
+#include <solv/repo.h>
+#include <solv/repo_solv.h>
+#include <solv/repo_write.h>
+#include <solv/repo_rpmdb.h>
+}
+#include <iostream>
+#include <unordered_map>
+#include <unordered_set>
+#include <string>
+
+#include <zypp/base/LogTools.h>
+#include <zypp/base/Exception.h>
+#include <zypp-core/AutoDispose.h>
+
+#include <zypp/sat/Queue.h>
+#include <zypp/target/TargetImpl.h>
+#include <zypp/target/rpm/librpm.h>
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace target
+  {
+    bool TargetImpl::buildCacheIncremental( const Pathname & rpmsolv_r, const Pathname & tmpsolv_r )
+    {
+      if ( ! _solvfileDelta )
+        return false;
+      SolvfileDelta delta( std::move(*_solvfileDelta) );
+      _solvfileDelta.reset();
+
+      if ( RepoStatus( _root/"etc/products.d" ) != delta._productsStatus )
+      {
+        MIL << "Solv file needs a full rebuild: /etc/products.d changed" << endl;
+        return false;
+      }
+
+      try
+      {
+        AutoDispose<sat::detail::CPool*> poolGuard( ::pool_create(), ::pool_free );
+        sat::detail::CPool * pool = poolGuard;
+        ::pool_set_rootdir( pool, _root.c_str() );
+        ::Repo * repo = ::repo_create( pool, "@System" );
+
+        // Read the old solv file
+        {
+          FILE * fp = ::fopen( rpmsolv_r.c_str(), "re" );
+          if ( ! fp )
+            ZYPP_THROW( Exception( "Can't open " + rpmsolv_r.asString() ) );
+          AutoDispose<FILE*> guard( fp, ::fclose );
+          if ( ::repo_add_solv( repo, fp, 0 ) != 0 )
+            ZYPP_THROW( Exception( rpmsolv_r.asString() + ": " + ::pool_errstr( pool ) ) );
+        }
+        if ( ! repo->rpmdbid )
+          ZYPP_THROW( Exception( rpmsolv_r.asString() + ": no rpmdbids" ) );
+
+        std::unordered_map<sat::detail::IdType,sat::detail::SolvableIdType> solvOf;	// rpmdbid -> solvable
+        for ( sat::detail::SolvableIdType p = repo->start; p < repo->end; ++p )
+        {
+          if ( pool->solvables[p].repo == repo && repo->rpmdbid[p - repo->start] )
+            solvOf[repo->rpmdbid[p - repo->start]] = p;
+        }
+
+        // Just the rpmdbids from the rpm database index, no headers are read.
+        // Like 'rpmdb2solv -D', make librpm use the targets database.
+        ::addMacro( NULL, "_dbpath", NULL, rpm().dbPath().c_str(), RMIL_CMDLINE );
+        AutoDispose<void*> state( ::rpm_state_create( pool, ::pool_get_rootdir( pool ) ), ::rpm_state_free );
+        sat::Queue dbids;
+        ::rpm_installedrpmdbids( state, "Name", nullptr, dbids );
+        std::unordered_set<sat::detail::IdType> inDb;
+        for ( unsigned i = 0; i < dbids.size(); ++i )
+          inDb.insert( dbids[i] );
+
+        const auto & touchedByCommit = [&]( sat::detail::SolvableIdType p ) {
+          return delta._names.count( ::pool_id2str( pool, pool->solvables[p].name ) ) != 0;
+        };
+
+        // Erased packages and, as rpmdbids may be reused, any package the commit touched.
+        // Their ids are not reused, so a new header never takes the slot of a freed
+        // solvable and is mistaken for an unchanged one below.
+        std::unordered_set<sat::detail::SolvableIdType> freed;
+        unsigned erased = 0;
+        for ( const auto & el : solvOf )
+        {
+          if ( inDb.count( el.first ) && ! touchedByCommit( el.second ) )
+            continue;
+          if ( ! touchedByCommit( el.second ) )
+          {
+            MIL << "Solv file needs a full rebuild: " << ::pool_solvid2str( pool, el.second ) << " was erased outside the commit" << endl;
+            return false;
+          }
+          repo->rpmdbid[el.second - repo->start] = 0;
+          ::repo_free_solvable( repo, el.second, 0 );
+          freed.insert( el.second );
+          ++erased;
+        }
+
+        // Installed packages (and the ones we just removed because they were touched).
+        ::Repodata * data = ::repo_add_repodata( repo, 0 );
+        unsigned installed = 0;
+        for ( unsigned i = 0; i < dbids.size(); ++i )
+        {
+          sat::detail::IdType dbid = dbids[i];
+          auto it = solvOf.find( dbid );
+          if ( it != solvOf.end() && ! freed.count( it->second ) && pool->solvables[it->second].repo == repo )
+            continue;	// unchanged
+
+          void * rpmhead = ::rpm_byrpmdbid( state, dbid );
+          if ( ! rpmhead )
+            ZYPP_THROW( Exception( str::Str() << "Can't read header " << dbid ) );
+          sat::detail::SolvableIdType p = ::repo_add_rpm_handle( repo, rpmhead, REPO_REUSE_REPODATA|REPO_NO_INTERNALIZE|RPM_ADD_TRIGGERS );
+          if ( ! p )
+            ZYPP_THROW( Exception( str::Str() << "Can't add header " << dbid << ": " << ::pool_errstr( pool ) ) );
+          if ( ! touchedByCommit( p ) )
+          {
+            MIL << "Solv file needs a full rebuild: " << ::pool_solvid2str( pool, p ) << " was installed outside the commit" << endl;
+            return false;
+          }
+          repo->rpmdbid = static_cast<sat::detail::IdType*>( ::repo_sidedata_extend( repo, repo->rpmdbid, sizeof(sat::detail::IdType), p, 1 ) );
+          repo->rpmdbid[p - repo->start] = dbid;
+          ++installed;
+        }
+        ::repodata_internalize( data );
+        ::repo_internalize( repo );
+
+        FILE * out = ::fopen( tmpsolv_r.c_str(), "we" );
+        if ( ! out )
+          ZYPP_THROW( Exception( "Can't create " + tmpsolv_r.asString() ) );
+        AutoDispose<FILE*> guard( out, ::fclose );
+        if ( ::repo_write( repo, out ) != 0 || ::fflush( out ) != 0 )
+          ZYPP_THROW( Exception( "Can't write " + tmpsolv_r.asString() ) );
+
+        MIL << "Incrementally updated solv file: -" << erased << " +" << installed << " packages" << endl;
+        return true;
+      }
+      catch ( const Exception & excpt )
+      {
+        ZYPP_CAUGHT( excpt );
+      }
+      MIL << "Solv file needs a full rebuild" << endl;
+      return false;
+    }
+
+  } // namespace target
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
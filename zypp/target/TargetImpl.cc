@@ -47,6 +47,7 @@
 #include <zypp/target/TargetCallbackReceiver.h>
 #include <zypp/target/rpm/librpmDb.h>
 #include <zypp/target/CommitPackageCache.h>
+#include <zypp/target/CommitPackagePreloader.h>
 #include <zypp/target/RpmPostTransCollector.h>
 
 #include <zypp/parser/ProductFileReader.h>
@@ -393,6 +394,44 @@ namespace zypp
           { "TransactionStepList", steps_r }
         }.asJSON() );
       }
+
+      /** Whether the transaction step may require a package download. */
+      inline bool isDownloadStep( const sat::Transaction::Step & step_r )
+      {
+        switch ( step_r.stepType() )
+        {
+          case sat::Transaction::TRANSACTION_INSTALL:
+          case sat::Transaction::TRANSACTION_MULTIINSTALL:
+            // only install actions may require download.
+            break;
+
+          default:
+            // no download for delete actions.
+            return false;
+            break;
+        }
+        sat::Solvable solv( step_r.satSolvable() );
+        return solv.isKind<Package>() || solv.isKind<SrcPackage>();
+      }
+
+      /** Split the download steps into heaps of \a heapSize_r packages (\c 0 means a single heap).
+       * The steps are in install order, so at the end of each heap all the previous
+       * packages are installed and the system is as consistent as the transaction
+       * order allows.
+       */
+      std::vector<std::vector<sat::Solvable>> commitDownloadHeaps( const ZYppCommitResult::TransactionStepList & steps_r, unsigned heapSize_r )
+      {
+        std::vector<std::vector<sat::Solvable>> ret;
+        for ( const sat::Transaction::Step & step : steps_r )
+        {
+          if ( ! isDownloadStep( step ) )
+            continue;
+          if ( ret.empty() || ( heapSize_r && ret.back().size() >= heapSize_r ) )
+            ret.emplace_back();
+          ret.back().push_back( step.satSolvable() );
+        }
+        return ret;
+      }
     } // namespace
     ///////////////////////////////////////////////////////////////////
 
@@ -1086,46 +1125,51 @@ namespace zypp
         // Take care we unlink the solvfile on exception
         ManagedFile guard( base, filesystem::recursive_rmdir );
 
-        ExternalProgram::Arguments cmd;
-        cmd.push_back( "rpmdb2solv" );
-        if ( ! _root.empty() ) {
-          cmd.push_back( "-r" );
-          cmd.push_back( _root.asString() );
-        }
-        cmd.push_back( "-D" );
-        cmd.push_back( rpm().dbPath().asString() );
-        cmd.push_back( "-X" );	// autogenerate pattern/product/... from -package
-        // bsc#1104415: no more application support // cmd.push_back( "-A" );	// autogenerate application pseudo packages
-        cmd.push_back( "-p" );
-        cmd.push_back( Pathname::assertprefix( _root, "/etc/products.d" ).asString() );
-
-        if ( ! oldSolvFile.empty() )
-          cmd.push_back( oldSolvFile.asString() );
-
-        cmd.push_back( "-o" );
-        cmd.push_back( tmpsolv.path().asString() );
-
-        ExternalProgram prog( cmd, ExternalProgram::Stderr_To_Stdout );
-        std::string errdetail;
-
-        for ( std::string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
-          WAR << "  " << output;
-          if ( errdetail.empty() ) {
-            errdetail = prog.command();
-            errdetail += '\n';
+        // After our own commit just the touched packages need to be updated.
+        bool incremental = ! oldSolvFile.empty() && buildCacheIncremental( oldSolvFile, tmpsolv.path() );
+        if ( ! incremental )
+        {
+          ExternalProgram::Arguments cmd;
+          cmd.push_back( "rpmdb2solv" );
+          if ( ! _root.empty() ) {
+            cmd.push_back( "-r" );
+            cmd.push_back( _root.asString() );
+          }
+          cmd.push_back( "-D" );
+          cmd.push_back( rpm().dbPath().asString() );
+          cmd.push_back( "-X" );	// autogenerate pattern/product/... from -package
+          // bsc#1104415: no more application support // cmd.push_back( "-A" );	// autogenerate application pseudo packages
+          cmd.push_back( "-p" );
+          cmd.push_back( Pathname::assertprefix( _root, "/etc/products.d" ).asString() );
+
+          if ( ! oldSolvFile.empty() )
+            cmd.push_back( oldSolvFile.asString() );
+
+          cmd.push_back( "-o" );
+          cmd.push_back( tmpsolv.path().asString() );
+
+          ExternalProgram prog( cmd, ExternalProgram::Stderr_To_Stdout );
+          std::string errdetail;
+
+          for ( std::string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
+            WAR << "  " << output;
+            if ( errdetail.empty() ) {
+              errdetail = prog.command();
+              errdetail += '\n';
+            }
+            errdetail += output;
           }
-          errdetail += output;
-        }
 
-        int ret = prog.close();
-        if ( ret != 0 )
-        {
-          Exception ex(str::form("Failed to cache rpm database (%d).", ret));
-          ex.remember( errdetail );
-          ZYPP_THROW(ex);
+          int ret = prog.close();
+          if ( ret != 0 )
+          {
+            Exception ex(str::form("Failed to cache rpm database (%d).", ret));
+            ex.remember( errdetail );
+            ZYPP_THROW(ex);
+          }
         }
 
-        ret = filesystem::rename( tmpsolv, rpmsolv );
+        int ret = filesystem::rename( tmpsolv, rpmsolv );
         if ( ret != 0 )
           ZYPP_THROW(Exception("Failed to move cache to final destination"));
         // if this fails, don't bother throwing exceptions
@@ -1152,9 +1196,45 @@ namespace zypp
         if ( ! PathInfo(base/"solv.idx").isExist() )
           sat::updateSolvFileIndex( rpmsolv );
       }
+      _solvfileDelta.reset();
       return build_rpm_solv;
     }
 
+    void TargetImpl::rememberSolvfileDelta( const ZYppCommitResult::TransactionStepList & steps_r )
+    {
+      _solvfileDelta.reset();
+
+      // The solv file must be up to date, otherwise the commit is not the only change.
+      Pathname rpmsolvcookie( solvfilesPath()/"cookie" );
+      if ( ! PathInfo( rpmsolvcookie ).isFile() )
+        return;
+      RepoStatus productsStatus( _root/"etc/products.d" );
+      if ( RepoStatus::fromCookieFile( rpmsolvcookie ) != ( rpmDbRepoStatus(_root) && productsStatus ) )
+        return;
+
+      SolvfileDelta delta;
+      delta._productsStatus = productsStatus;
+      for ( const sat::Transaction::Step & step : steps_r )
+      {
+        sat::Solvable solv( step.satSolvable() );
+        if ( ! solv.isKind<Package>() )
+          continue;
+
+        for ( const Capability & cap : solv.provides() )
+        {
+          // rpmdb2solv -X generates patterns and products from these
+          const std::string & name( cap.detail().name().asString() );
+          if ( name == "pattern()" || name == "product()" )
+          {
+            MIL << "Solv file needs a full rebuild: " << solv << " provides " << cap << endl;
+            return;
+          }
+        }
+        delta._names.insert( solv.name() );
+      }
+      _solvfileDelta = std::move(delta);
+    }
+
     void TargetImpl::reload()
     {
         load( false );
@@ -1463,62 +1543,59 @@ namespace zypp
         bool miss = false;
         if ( policy_r.downloadMode() != DownloadAsNeeded  )
         {
-          // Preload the cache. Until now this means pre-loading all packages.
-          // Once DownloadInHeaps is fully implemented, this will change and
-          // we may actually have more than one heap.
+          // Preload the cache. In DownloadInHeaps mode the packages to install
+          // are split into heaps, each of them preloaded concurrently by the
+          // packageCache as the loop below reaches it. Otherwise all packages
+          // form a single heap.
+          // All heaps are loaded before the commit starts: the file conflict
+          // check needs all new packages at hand, and rpm needs them at once
+          // in singleTransMode.
+          bool inHeaps = ( policy_r.downloadMode() == DownloadInHeaps && ! policy_r.dryRun() && ! singleTransMode );
+          std::vector<std::vector<sat::Solvable>> heaps( commitDownloadHeaps( steps, inHeaps ? policy_r.downloadHeapSize() : 0 ) );
+          if ( policy_r.downloadParallel() > 1 )
+            packageCache.setPreloadHeaps( std::move(heaps), shared_ptr<CommitPackagePreloader>( new CommitPackagePreloader( rpm(), policy_r.downloadParallel() ) ) );
+
           for_( it, steps.begin(), steps.end() )
           {
-            switch ( it->stepType() )
-            {
-              case sat::Transaction::TRANSACTION_INSTALL:
-              case sat::Transaction::TRANSACTION_MULTIINSTALL:
-                // proceed: only install actionas may require download.
-                break;
-
-              default:
-                // next: no download for or non-packages and delete actions.
-                continue;
-                break;
-            }
+            if ( ! isDownloadStep( *it ) )
+              continue;
 
             PoolItem pi( *it );
-            if ( pi->isKind<Package>() || pi->isKind<SrcPackage>() )
+            ManagedFile localfile;
+            try
             {
-              ManagedFile localfile;
-              try
-              {
-                localfile = packageCache.get( pi );
-                localfile.resetDispose(); // keep the package file in the cache
-              }
-              catch ( const AbortRequestException & exp )
-              {
-                it->stepStage( sat::Transaction::STEP_ERROR );
-                miss = true;
-                WAR << "commit cache preload aborted by the user" << endl;
-                ZYPP_THROW( TargetAbortedException( ) );
-                break;
-              }
-              catch ( const SkipRequestException & exp )
-              {
-                ZYPP_CAUGHT( exp );
-                it->stepStage( sat::Transaction::STEP_ERROR );
-                miss = true;
-                WAR << "Skipping cache preload package " << pi->asKind<Package>() << " in commit" << endl;
-                continue;
-              }
-              catch ( const Exception & exp )
-              {
-                // bnc #395704: missing catch causes abort.
-                // TODO see if packageCache fails to handle errors correctly.
-                ZYPP_CAUGHT( exp );
-                it->stepStage( sat::Transaction::STEP_ERROR );
-                miss = true;
-                INT << "Unexpected Error: Skipping cache preload package " << pi->asKind<Package>() << " in commit" << endl;
-                continue;
-              }
+              localfile = packageCache.get( pi );
+              localfile.resetDispose(); // keep the package file in the cache
+            }
+            catch ( const AbortRequestException & exp )
+            {
+              it->stepStage( sat::Transaction::STEP_ERROR );
+              miss = true;
+              WAR << "commit cache preload aborted by the user" << endl;
+              ZYPP_THROW( TargetAbortedException( ) );
+              break;
+            }
+            catch ( const SkipRequestException & exp )
+            {
+              ZYPP_CAUGHT( exp );
+              it->stepStage( sat::Transaction::STEP_ERROR );
+              miss = true;
+              WAR << "Skipping cache preload package " << pi->asKind<Package>() << " in commit" << endl;
+              continue;
+            }
+            catch ( const Exception & exp )
+            {
+              // bnc #395704: missing catch causes abort.
+              // TODO see if packageCache fails to handle errors correctly.
+              ZYPP_CAUGHT( exp );
+              it->stepStage( sat::Transaction::STEP_ERROR );
+              miss = true;
+              INT << "Unexpected Error: Skipping cache preload package " << pi->asKind<Package>() << " in commit" << endl;
+              continue;
             }
           }
-          packageCache.preloaded( true ); // try to avoid duplicate infoInCache CBs in commit
+          if ( ! miss )
+            packageCache.preloaded( true ); // try to avoid duplicate infoInCache CBs in commit
         }
 
         if ( miss )
@@ -1529,6 +1606,7 @@ namespace zypp
         {
           if ( ! policy_r.dryRun() )
           {
+            rememberSolvfileDelta( steps );
             if ( policy_r.singleTransModeEnabled() ) {
               commitInSingleTransaction( policy_r, packageCache, result );
             } else {
@@ -2687,6 +2765,20 @@ namespace zypp
               // this value is checked later
               transactionError = std::move(error);
 
+            } else if ( mName == "zypp.proto.target.TransactionTiming" ) {
+
+              zpt::TransactionTiming timing;
+              if ( !timing.ParseFromString( m.value() ) ) {
+                ERR << "Failed to parse " << m.messagetypename() << " message from zypp-rpm." << std::endl;
+                continue;
+              }
+
+              MIL << "zypp-rpm timing: read headers " << timing.readheaders() << "ms ("
+                  << timing.headerthreads() << " threads, " << timing.keptfds() << " kept open)"
+                  << ", check " << timing.check() << "ms"
+                  << ", order " << timing.order() << "ms"
+                  << ", run " << timing.run() << "ms" << std::endl;
+
             } else {
               ERR << "Received unexpected message from zypp-rpm: "<< m.messagetypename() << ", ignoring" << std::endl;
               return;
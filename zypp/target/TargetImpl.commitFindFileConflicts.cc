@@ -19,8 +19,13 @@ extern "C"
 #include <solv/pool_fileconflicts.h>
 }
 #include <iostream>
+#include <fstream>
+#include <unordered_map>
 #include <unordered_set>
 #include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
 
 #include <zypp/base/LogTools.h>
 #include <zypp/base/Gettext.h>
@@ -47,6 +52,53 @@ namespace zypp
     ///////////////////////////////////////////////////////////////////
     namespace
     {
+      /** Max. amount of memory used to keep the preloaded rpm headers. */
+      constexpr std::size_t preloadHeadersMaxBytes = 256 * 1024 * 1024;
+
+      inline std::size_t getu32( const std::string & buf_r, std::size_t off_r )
+      {
+        const unsigned char * p = reinterpret_cast<const unsigned char *>( buf_r.data() ) + off_r;
+        return ( std::size_t(p[0]) << 24 ) | ( std::size_t(p[1]) << 16 ) | ( std::size_t(p[2]) << 8 ) | std::size_t(p[3]);
+      }
+
+      /** Read the leading part of an rpm file \c rpm_byfp needs (lead, signature and main header).
+       * The payload is not read. Returns an empty string on error.
+       */
+      std::string readRpmHeader( const Pathname & file_r )
+      {
+        std::string ret;
+        std::ifstream in( file_r.c_str(), std::ios::binary );
+        const auto & readMore = [&]( std::size_t size_r ) -> bool {
+          std::size_t off = ret.size();
+          ret.resize( off + size_r );
+          return bool( in.read( &ret[off], size_r ) );
+        };
+        // the size of the header starting at off_r (its first 16 bytes are already read)
+        const auto & headerSize = [&]( std::size_t off_r ) -> std::size_t {
+          if ( getu32( ret, off_r ) != 0x8eade801 )
+            return 0;
+          std::size_t il = getu32( ret, off_r + 8 );
+          std::size_t dl = getu32( ret, off_r + 12 );
+          if ( il > 0x10000 || dl > 0x10000000 )	// same limits as rpm
+            return 0;
+          return 16 + 16 * il + dl;
+        };
+
+        if ( ! ( readMore( 96 + 16 ) && getu32( ret, 0 ) == 0xedabeedb ) )
+          return std::string();
+        std::size_t size = headerSize( 96 );
+        if ( ! ( size && readMore( size - 16 + ( 8 - size % 8 ) % 8 ) ) )	// signature is padded to 8 bytes
+          return std::string();
+
+        std::size_t off = ret.size();
+        if ( ! readMore( 16 ) )
+          return std::string();
+        size = headerSize( off );
+        if ( ! ( size && readMore( size - 16 ) ) )
+          return std::string();
+        return ret;
+      }
+
       /** libsolv::pool_findfileconflicts callback providing package header. */
       struct FileConflictsCB
       {
@@ -79,6 +131,57 @@ namespace zypp
         const sat::Queue & noFilelist() const
         { return _noFilelist; }
 
+        /** Read the headers of the new packages in \a todo_r in parallel and keep them in memory.
+         * The callback may visit a package up to 3 times and would otherwise reopen the rpm on
+         * each visit.
+         */
+        void preloadHeaders( const sat::Queue & todo_r )
+        {
+          std::vector<std::pair<sat::detail::IdType,Pathname>> files;
+          for ( unsigned i = 0; i < todo_r.size(); ++i )
+          {
+            sat::Solvable solv( todo_r[i] );
+            if ( solv.isSystem() )
+              continue;
+            Package::Ptr pkg( make<Package>( solv ) );
+            if ( ! pkg )
+              continue;
+            Pathname localfile( pkg->cachedLocation() );
+            if ( ! localfile.empty() )
+              files.push_back( std::make_pair( todo_r[i], std::move(localfile) ) );
+          }
+          if ( files.empty() )
+            return;
+
+          std::vector<std::string> headers( files.size() );
+          std::atomic<std::size_t> next { 0 };
+          std::atomic<std::size_t> bytes { 0 };
+          const auto & worker = [&]() {
+            for ( std::size_t idx = next++; idx < files.size(); idx = next++ )
+            {
+              if ( bytes >= preloadHeadersMaxBytes )
+                break;	// the rest is read from disk when needed
+              headers[idx] = readRpmHeader( files[idx].second );
+              bytes += headers[idx].size();
+            }
+          };
+
+          unsigned nthreads = std::min<std::size_t>( std::max( std::thread::hardware_concurrency(), 1U ), files.size() );
+          std::vector<std::thread> threads;
+          for ( unsigned i = 1; i < nthreads; ++i )
+            threads.push_back( std::thread( worker ) );
+          worker();
+          for ( auto & thread : threads )
+            thread.join();
+
+          for ( std::size_t idx = 0; idx < files.size(); ++idx )
+          {
+            if ( ! headers[idx].empty() )
+              _headers[files[idx].first] = std::move(headers[idx]);
+          }
+          MIL << "Preloaded " << _headers.size() << " of " << files.size() << " rpm headers (" << bytes << " bytes, " << nthreads << " threads)" << endl;
+        }
+
         static void * invoke( sat::detail::CPool * pool_r, sat::detail::IdType id_r, void * cbdata_r )
         { return (*reinterpret_cast<FileConflictsCB*>(cbdata_r))( pool_r, id_r ); }
 
@@ -98,6 +201,18 @@ namespace zypp
           }
           else
           {
+            auto hit = _headers.find( id_r );
+            if ( hit != _headers.end() )
+            {
+              std::string & header( hit->second );
+              FILE * mem = ::fmemopen( &header[0], header.size(), "r" );
+              if ( mem )
+              {
+                AutoDispose<FILE*> fp( mem, ::fclose );
+                return ::rpm_byfp( _state, fp, solv.asString().c_str() );
+              }
+            }
+
             Package::Ptr pkg( make<Package>( solv ) );
             if ( ! pkg )
               return nullptr;
@@ -114,6 +229,7 @@ namespace zypp
         AutoDispose<void*> _state;
         std::unordered_set<sat::detail::IdType> _visited;
         sat::Queue _noFilelist;
+        std::unordered_map<sat::detail::IdType,std::string> _headers;	///< preloaded rpm headers
       };
 
     } // namespace
@@ -135,6 +251,7 @@ namespace zypp
           ZYPP_THROW( AbortRequestException() );
 
         FileConflictsCB cb( sat::Pool::instance().get(), progress );
+        cb.preloadHeaders( todo );
         // lambda receives progress trigger and translates into report
         auto sendProgress = [&]( const ProgressData & progress_r )->bool {
           if ( ! report->progress( progress_r, cb.noFilelist() ) )
@@ -14,6 +14,7 @@
 
 #include <iosfwd>
 #include <set>
+#include <optional>
 
 #include <zypp/base/ReferenceCounted.h>
 #include <zypp/base/NonCopyable.h>
@@ -22,6 +23,7 @@
 #include <zypp/ZYppCommit.h>
 
 #include <zypp/Pathname.h>
+#include <zypp/RepoStatus.h>
 #include <zypp/Target.h>
 #include <zypp/target/rpm/RpmDb.h>
 #include <zypp/target/TargetException.h>
@@ -98,6 +100,25 @@ namespace zypp
 
       Pathname _tmpSolvfilesPath;
 
+      /** Remembered by \ref commit to allow \ref buildCacheIncremental. */
+      struct SolvfileDelta
+      {
+        std::set<std::string> _names;	///< names of the packages touched by the commit
+        RepoStatus _productsStatus;	///< /etc/products.d before the commit
+      };
+      std::optional<SolvfileDelta> _solvfileDelta;
+
+      /** Remember the packages touched by the commit if the solv file is up to date. */
+      void rememberSolvfileDelta( const ZYppCommitResult::TransactionStepList & steps_r );
+
+      /** Patch the up to date solv file of the last commit: Remove the erased packages and
+       * read the headers of the installed ones from the rpm database. The result is written
+       * to \a tmpsolv_r.
+       * \returns \c false if a full rebuild via \c rpmdb2solv is needed (e.g. because
+       * the rpm database was changed outside the commit).
+       */
+      bool buildCacheIncremental( const Pathname & rpmsolv_r, const Pathname & tmpsolv_r );
+
     public:
       void load( bool force = true );
 
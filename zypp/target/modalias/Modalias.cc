@@ -14,8 +14,10 @@ extern "C"
 #include <fnmatch.h>
 }
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <unordered_map>
 #include <vector>
 
 #undef ZYPP_BASE_LOGGER_LOGGROUP
@@ -107,6 +109,84 @@ namespace zypp
         foreach_file_recursive( dir_r, arg );
         arg_r.insert( arg_r.end(), arg.begin(), arg.end() );
       }
+
+      ///////////////////////////////////////////////////////////////////
+      /// \class ModaliasPattern
+      /// \brief A modalias pattern compiled for matching many aliases.
+      ///
+      /// The literal prefix of the pattern (usually the bus and vendor,
+      /// e.g. \c "pci:v00008086d") selects the candidate aliases from the
+      /// sorted alias list. The rest is matched by a simple glob matcher,
+      /// unless the pattern uses bracket expressions or escapes, which are
+      /// left to \c fnmatch.
+      ///////////////////////////////////////////////////////////////////
+      class ModaliasPattern
+      {
+      public:
+        ModaliasPattern( const char * pattern_r )
+        : _pattern( pattern_r )
+        , _fnmatch( _pattern.find_first_of( "[\\" ) != std::string::npos )
+        { _prefix = _pattern.substr( 0, _pattern.find_first_of( "*?[\\" ) ); }
+
+        /** Whether an alias in the sorted list \a aliases_r matches. */
+        bool matchAny( const Modalias::ModaliasList & aliases_r ) const
+        {
+          for ( auto it = std::lower_bound( aliases_r.begin(), aliases_r.end(), _prefix );
+                it != aliases_r.end() && it->compare( 0, _prefix.size(), _prefix ) == 0; ++it )
+          {
+            if ( match( *it ) )
+              return true;
+          }
+          return false;
+        }
+
+        bool match( const std::string & alias_r ) const
+        {
+          if ( _fnmatch )
+            return ::fnmatch( _pattern.c_str(), alias_r.c_str(), 0 ) == 0;
+
+          // glob with '*' and '?' only (fnmatch without flags: '*' matches '/' too)
+          const char * p = _pattern.c_str() + _prefix.size();
+          const char * s = alias_r.c_str() + _prefix.size();
+          const char * star = nullptr;	// last '*' seen in pattern
+          const char * retry = nullptr;	// where that '*' continues in alias
+          while ( *s )
+          {
+            if ( *p == '*' )
+            {
+              star = ++p;
+              retry = s;
+            }
+            else if ( *p == '?' || *p == *s )
+            {
+              ++p;
+              ++s;
+            }
+            else if ( star )
+            {
+              p = star;
+              s = ++retry;
+            }
+            else
+              return false;
+          }
+          while ( *p == '*' )
+            ++p;
+          return ! *p;
+        }
+
+      private:
+        std::string _pattern;
+        std::string _prefix;	///< literal prefix
+        bool _fnmatch;		///< pattern needs fnmatch
+      };
+
+      /** Kernels uevent counter, changes if devices are added or removed. */
+      inline std::string ueventSeqnum( const Pathname & sysfs_r )
+      {
+        std::ifstream str( ( sysfs_r / "kernel/uevent_seqnum" ).c_str() );
+        return iostr::getline( str );
+      }
     } // namespace
     ///////////////////////////////////////////////////////////////////
 
@@ -114,12 +194,97 @@ namespace zypp
     //
     //	CLASS NAME : Modalias::Impl
     //
-    /** Modalias implementation. */
+    /** Modalias implementation.
+     *
+     * The aliases are collected on demand and kept sorted, so a query
+     * only needs to look at the aliases sharing the patterns literal
+     * prefix. Query results are remembered until the aliases change.
+     */
     struct Modalias::Impl
     {
       /** Ctor. */
       Impl()
+      {}
+
+      Impl(const Impl &) = delete;
+      Impl(Impl &&) = delete;
+      Impl &operator=(const Impl &) = delete;
+      Impl &operator=(Impl &&) = delete;
+
+      /** Dtor. */
+      ~Impl() = default;
+
+      /*
+       * Check if a device on the system matches a modalias PATTERN.
+       *
+       * Returns NULL if no matching device is found, and the modalias
+       * of the first matching device otherwise. (More than one device
+       * may match a given pattern.)
+       *
+       * On a system that has the following device,
+       *
+       *   pci:v00008086d0000265Asv00008086sd00004556bc0Csc03i00
+       *
+       * modalias_matches("pci:v00008086d0000265Asv*sd*bc*sc*i*") will
+       * return a non-NULL value.
+       */
+      bool query( const char * cap_r ) const
       {
+        if ( ! ( cap_r && *cap_r ) )
+          return false;
+
+        auto it = _queries.find( cap_r );
+        if ( it != _queries.end() )
+          return it->second;
+
+        bool ret = ModaliasPattern( cap_r ).matchAny( sorted() );
+        _queries.emplace( cap_r, ret );
+        return ret;
+      }
+
+      /** The aliases found on the system (collected on demand). */
+      const ModaliasList & modaliases() const
+      {
+        if ( ! _loaded )
+          const_cast<Impl*>(this)->load();
+        return _modaliases;
+      }
+
+      /** Manually set list of modaliases to use. */
+      void modaliases( ModaliasList && newlist_r )
+      {
+        _modaliases.swap( newlist_r );
+        _loaded = true;
+        _sysfs = Pathname();	// no refresh
+        setDirty();
+      }
+
+      /** Rescan \c /sys if the kernel reported device changes since the last scan. */
+      bool refresh()
+      {
+        if ( ! _loaded || _sysfs.empty() )
+          return false;
+
+        std::string seqnum { ueventSeqnum( _sysfs ) };
+        if ( seqnum == _seqnum )
+          return false;
+
+        DBG << "Devices changed (uevent " << _seqnum << " -> " << seqnum << "). Rescan " << _sysfs << endl;
+        ModaliasList modaliases;
+        foreach_file_recursive( _sysfs, modaliases );
+        _seqnum = seqnum;
+        if ( modaliases == _modaliases )
+          return false;
+
+        _modaliases.swap( modaliases );
+        setDirty();
+        return true;
+      }
+
+    private:
+      void load()
+      {
+        _loaded = true;
         const char * dir = getenv("ZYPP_MODALIAS_SYSFS");
         if ( dir )
         {
@@ -146,46 +311,39 @@ namespace zypp
           DBG << "Using /sys directory." << endl;
         }
 
-        foreach_file_recursive( dir, _modaliases );
+        _sysfs = dir;
+        _seqnum = ueventSeqnum( _sysfs );
+        foreach_file_recursive( _sysfs, _modaliases );
       }
 
-      Impl(const Impl &) = delete;
-      Impl(Impl &&) = delete;
-      Impl &operator=(const Impl &) = delete;
-      Impl &operator=(Impl &&) = delete;
-
-      /** Dtor. */
-      ~Impl() = default;
+      void setDirty()
+      {
+        _sorted.clear();
+        _sortedValid = false;
+        _queries.clear();
+      }
 
-      /*
-       * Check if a device on the system matches a modalias PATTERN.
-       *
-       * Returns NULL if no matching device is found, and the modalias
-       * of the first matching device otherwise. (More than one device
-       * may match a given pattern.)
-       *
-       * On a system that has the following device,
-       *
-       *   pci:v00008086d0000265Asv00008086sd00004556bc0Csc03i00
-       *
-       * modalias_matches("pci:v00008086d0000265Asv*sd*bc*sc*i*") will
-       * return a non-NULL value.
-       */
-      bool query( const char * cap_r ) const
+      /** The aliases sorted (the index for \ref ModaliasPattern::matchAny). */
+      const ModaliasList & sorted() const
       {
-        if ( cap_r && *cap_r )
+        if ( ! _sortedValid )
         {
-          for_( it, _modaliases.begin(), _modaliases.end() )
-          {
-            if ( fnmatch( cap_r, (*it).c_str(), 0 ) == 0 )
-              return true;
-          }
+          _sorted = modaliases();
+          std::sort( _sorted.begin(), _sorted.end() );
+          _sortedValid = true;
         }
-        return false;
+        return _sorted;
       }
 
-    public:
+    private:
       ModaliasList _modaliases;
+      bool _loaded = false;
+      Pathname _sysfs;		///< scanned sysfs dir (empty if not to refresh)
+      std::string _seqnum;	///< uevent_seqnum at the time of the scan
+
+      mutable ModaliasList _sorted;
+      mutable bool _sortedValid = false;
+      mutable std::unordered_map<std::string,bool> _queries;
 
     public:
       /** Offer default Impl. */
@@ -204,7 +362,8 @@ namespace zypp
      */
     inline std::ostream & operator<<( std::ostream & str, const Modalias::Impl & obj )
     {
-      return dumpRange( str << "Modaliases: (" << obj._modaliases.size() << ") ", obj._modaliases.begin(), obj._modaliases.end() );
+      const Modalias::ModaliasList & modaliases { obj.modaliases() };
+      return dumpRange( str << "Modaliases: (" << modaliases.size() << ") ", modaliases.begin(), modaliases.end() );
     }
 
     ///////////////////////////////////////////////////////////////////
@@ -230,10 +389,13 @@ namespace zypp
     { return _pimpl->query( cap_r ); }
 
     const Modalias::ModaliasList & Modalias::modaliasList() const
-    { return _pimpl->_modaliases; }
+    { return _pimpl->modaliases(); }
 
     void Modalias::modaliasList( ModaliasList newlist_r )
-    { _pimpl->_modaliases.swap( newlist_r ); }
+    { _pimpl->modaliases( std::move(newlist_r) ); }
+
+    bool Modalias::refresh()
+    { return _pimpl->refresh(); }
 
     std::ostream & operator<<( std::ostream & str, const Modalias & obj )
     { return str << *obj._pimpl; }
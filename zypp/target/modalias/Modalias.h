@@ -80,6 +80,14 @@ namespace zypp
         /** Manually set list of modaliases to use */
         void modaliasList( ModaliasList newlist_r );
 
+        /** Rescan the system if devices were added or removed since the last scan.
+         *
+         * Cheap if nothing changed (the kernels \c uevent_seqnum is checked).
+         * Returns \c true if the list of modaliases changed, so cached query
+         * results must be discarded. A manually set list is never refreshed.
+         */
+        bool refresh();
+
       private:
         /** Singleton ctor. */
         Modalias();
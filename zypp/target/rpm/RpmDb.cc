@@ -1149,16 +1149,11 @@ namespace
     int _oldMask = 0;
   };
 
-  std::ostream & operator<<( std::ostream & str, const RpmlogCapture & obj )
-  {
-    char sep = '\0';
-    for ( const auto & l : obj ) {
-      if ( sep ) str << sep; else sep = '\n';
-      str << l;
-    }
-    return str;
-  }
-
+  RpmDb::CheckPackageResult evalCheckPackageSig( const Pathname & path_r,			// rpm file checked
+                                                 bool  requireGPGSig_r,			// whether no gpg signature is to be reported
+                                                 int res,				// rpmVerifySignatures/rpm -K return value
+                                                 const std::vector<std::string> & vresult,	// rpm log output
+                                                 RpmDb::CheckPackageDetail & detail_r );	// detailed result
 
   RpmDb::CheckPackageResult doCheckPackageSig( const Pathname & path_r,			// rpm file to check
                                                const Pathname & root_r,			// target root
@@ -1196,6 +1191,15 @@ namespace
     ts = rpmtsFree(ts);
     ::Fclose( fd );
 
+    return evalCheckPackageSig( path_r, requireGPGSig_r, res, vresult, detail_r );
+  }
+
+  RpmDb::CheckPackageResult evalCheckPackageSig( const Pathname & path_r,
+                                                 bool  requireGPGSig_r,
+                                                 int res,
+                                                 const std::vector<std::string> & vresult,
+                                                 RpmDb::CheckPackageDetail & detail_r )
+  {
     // Check the individual signature/disgest results:
 
     // To.map back known result strings to enum, everything else is CHK_ERROR.
@@ -1346,7 +1350,7 @@ namespace
       }
 
       WAR << path_r << " (" << requireGPGSig_r << " -> " << ret << ")" << endl;
-      WAR << vresult << endl;
+      WAR << str::join( vresult, "\n" ) << endl;
     }
     else
       DBG << path_r << " [0-Signature is OK]" << endl;
@@ -1368,6 +1372,29 @@ RpmDb::CheckPackageResult RpmDb::checkPackage( const Pathname & path_r )
 RpmDb::CheckPackageResult RpmDb::checkPackageSignature( const Pathname & path_r, RpmDb::CheckPackageDetail & detail_r )
 { return doCheckPackageSig( path_r, root(), true/*requireGPGSig_r*/, detail_r ); }
 
+std::vector<std::string> RpmDb::checkPackageSignatureCommand( const Pathname & path_r ) const
+{
+  // Same as doCheckPackageSig: default verify flags, verbose to get the
+  // individual result lines, C locale set by the caller.
+  return {
+    "rpm",
+    "--root", _root.asString(),
+    "--dbpath", _dbPath.asString(),
+    "--checksig", "--verbose",
+    path_r.asString()
+  };
+}
+
+RpmDb::CheckPackageResult RpmDb::checkPackageSignatureResult( const Pathname & path_r, int exitStatus_r, const std::vector<std::string> & output_r, CheckPackageDetail & detail_r ) const
+{
+  if ( exitStatus_r < 0 || exitStatus_r > 125 )	// not started, killed or not executable
+  {
+    ERR << "Signature check of " << path_r << " did not run (" << exitStatus_r << ")" << endl;
+    return CHK_ERROR;
+  }
+  return evalCheckPackageSig( path_r, true/*requireGPGSig_r*/, exitStatus_r, output_r, detail_r );
+}
+
 
 // determine changed files of installed package
 bool
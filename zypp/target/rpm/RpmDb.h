@@ -394,6 +394,29 @@ public:
    */
   CheckPackageResult checkPackageSignature( const Pathname & path_r, CheckPackageDetail & detail_r );
 
+  /**
+   * Command line to perform \ref checkPackageSignature in a separate process.
+   *
+   * librpm's log capturing and the locale needed to parse the log are process
+   * global, so in-process checks must run one at a time. Running the command
+   * allows checking many packages concurrently (e.g. while downloading them).
+   * The command must be executed in the C locale with stdout and stderr merged.
+   * Pass its output lines and exit status to \ref checkPackageSignatureResult.
+   */
+  std::vector<std::string> checkPackageSignatureCommand( const Pathname & path_r ) const;
+
+  /**
+   * Evaluate the outcome of \ref checkPackageSignatureCommand.
+   *
+   * @param path_r which file was checked
+   * @param exitStatus_r the commands exit status
+   * @param output_r the commands output lines (trailing NL stripped)
+   * @param detail_r Return detailed rpm log messages
+   *
+   * @return CheckPackageResult as \ref checkPackageSignature would have returned it
+   */
+  CheckPackageResult checkPackageSignatureResult( const Pathname & path_r, int exitStatus_r, const std::vector<std::string> & output_r, CheckPackageDetail & detail_r ) const;
+
   /** install rpm package
    *
    * @param filename file to install
@@ -18,6 +18,8 @@
 #include <zypp/KeyRing.h>
 
 #include <optional>
+#include <unordered_map>
+#include <vector>
 
 namespace zypp {
 
@@ -33,6 +35,12 @@ namespace zypp {
   {
     const std::list<PublicKeyData> & operator()( const Pathname & keyring_r ) const;
 
+    /** The key in \a keyring_r providing \a id_r (\c false if not found).
+     * Same as the 1st \ref PublicKeyData::providesKey in the list, but
+     * looked up via an index built along with the cached data.
+     */
+    PublicKeyData find( const Pathname & keyring_r, const std::string & id_r ) const;
+
     void setDirty( const Pathname & keyring_r );
 
     ///////////////////////////////////////////////////////////////////
@@ -67,7 +75,13 @@ namespace zypp {
 
       bool hasChanged() const;
 
+      /** Rebuild \ref _index from \ref _data. */
+      void buildIndex();
+
       std::list<PublicKeyData> _data;
+      /** Lowercased 16 byte suffix of fingerprints and subkey ids, and 8 byte short ids
+       * of the keys in \ref _data (in list order) which may provide them. */
+      std::unordered_map<std::string, std::vector<const PublicKeyData *>> _index;
 
     private:
 
@@ -0,0 +1,172 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/zypp_detail/repo2solv_p.cc
+ *
+*/
+extern "C"
+{
+#include <solv/pool.h>
+#include <solv/repo.h>
+#include <solv/repo_write.h>
+#include <solv/repo_repomdxml.h>
+#include <solv/repo_rpmmd.h>
+#include <solv/repo_updateinfoxml.h>
+#include <solv/repo_deltainfoxml.h>
+#include <solv/repo_autopattern.h>
+#include <solv/solv_xfopen.h>
+#include <solv/solvversion.h>
+}
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <zypp/base/LogTools.h>
+#include <zypp/base/Exception.h>
+#include <zypp-core/AutoDispose.h>
+#include <zypp/PathInfo.h>
+#include <zypp/zypp_detail/repo2solv_p.h>
+
+#undef  ZYPP_BASE_LOGGER_LOGGROUP
+#define ZYPP_BASE_LOGGER_LOGGROUP "zypp::repo2solv"
+
+using std::endl;
+
+namespace zypp
+{
+  namespace
+  {
+    /** Location of the metadata file of \a type_r listed in repomd.xml (or empty). */
+    std::string repomdFind( ::Repo * repo_r, const std::string & type_r )
+    {
+      std::string ret;
+      ::Dataiterator di;
+      ::dataiterator_init( &di, repo_r->pool, repo_r, SOLVID_META, REPOSITORY_REPOMD_TYPE, type_r.c_str(), SEARCH_STRING );
+      ::dataiterator_prepend_keyname( &di, REPOSITORY_REPOMD );
+      if ( ::dataiterator_step( &di ) )
+      {
+        ::dataiterator_setpos_parent( &di );
+        const char * location = ::pool_lookup_str( repo_r->pool, SOLVID_POS, REPOSITORY_REPOMD_LOCATION );
+        if ( location )
+          ret = location;
+      }
+      ::dataiterator_free( &di );
+      return ret;
+    }
+
+    /** The types of all translated susedata files (\c susedata.LANG) listed in repomd.xml. */
+    std::vector<std::string> repomdFindSusedataLangs( ::Repo * repo_r )
+    {
+      std::vector<std::string> ret;
+      ::Dataiterator di;
+      ::dataiterator_init( &di, repo_r->pool, repo_r, SOLVID_META, REPOSITORY_REPOMD_TYPE, "susedata.", SEARCH_STRINGSTART );
+      ::dataiterator_prepend_keyname( &di, REPOSITORY_REPOMD );
+      while ( ::dataiterator_step( &di ) )
+        ret.push_back( di.kv.str );
+      ::dataiterator_free( &di );
+      return ret;
+    }
+
+    /** Open a (maybe compressed) metadata file for reading. */
+    AutoDispose<FILE*> xfopen( const Pathname & file_r )
+    {
+      FILE * fp = ::solv_xfopen( file_r.c_str(), "r" );
+      if ( ! fp )
+        ZYPP_THROW( Exception( str::Str() << "Can't open " << file_r ) );
+      return AutoDispose<FILE*>( fp, ::fclose );
+    }
+
+    /** Parse a metadata file via \a addfnc_r, throw on error. */
+    template <class AddFnc>
+    void addMetadata( ::Repo * repo_r, const Pathname & file_r, AddFnc && addfnc_r )
+    {
+      DBG << "Add " << file_r << endl;
+      AutoDispose<FILE*> fp( xfopen( file_r ) );
+      if ( addfnc_r( fp.value() ) != 0 )
+        ZYPP_THROW( Exception( str::Str() << file_r << ": " << ::pool_errstr( repo_r->pool ) ) );
+    }
+  } // namespace
+
+  void repo2solvRpmmd( const Pathname & productdatapath_r, const Pathname & solvfile_r )
+  {
+    MIL << "Building " << solvfile_r << " from " << productdatapath_r << endl;
+
+    AutoDispose<::Pool*> pool( ::pool_create(), ::pool_free );
+    ::Repo * repo = ::repo_create( pool, "repo2solv" );
+
+    addMetadata( repo, productdatapath_r/"repodata/repomd.xml", [&]( FILE * fp ) {
+      return ::repo_add_repomdxml( repo, fp, 0 );
+    });
+
+    std::string location( repomdFind( repo, "suseinfo" ) );	// repo keywords and expire
+    if ( ! location.empty() )
+      addMetadata( repo, productdatapath_r/location, [&]( FILE * fp ) {
+        return ::repo_add_repomdxml( repo, fp, 0 );
+      });
+
+    location = repomdFind( repo, "primary" );
+    if ( location.empty() )
+      ZYPP_THROW( Exception( str::Str() << productdatapath_r << ": no primary metadata in repomd.xml" ) );
+    addMetadata( repo, productdatapath_r/location, [&]( FILE * fp ) {
+      return ::repo_add_rpmmd( repo, fp, 0, 0 );
+    });
+
+    location = repomdFind( repo, "susedata" );
+    if ( ! location.empty() )
+      addMetadata( repo, productdatapath_r/location, [&]( FILE * fp ) {
+        return ::repo_add_rpmmd( repo, fp, 0, REPO_EXTEND_SOLVABLES );
+      });
+
+    for ( const std::string & type : repomdFindSusedataLangs( repo ) )
+    {
+      location = repomdFind( repo, type );
+      if ( ! location.empty() )
+        addMetadata( repo, productdatapath_r/location, [&]( FILE * fp ) {
+          return ::repo_add_rpmmd( repo, fp, type.c_str() + 9 /*susedata.*/, REPO_EXTEND_SOLVABLES );
+        });
+    }
+
+    location = repomdFind( repo, "updateinfo" );
+    if ( ! location.empty() )
+      addMetadata( repo, productdatapath_r/location, [&]( FILE * fp ) {
+        return ::repo_add_updateinfoxml( repo, fp, 0 );
+      });
+
+    location = repomdFind( repo, "deltainfo" );
+    if ( location.empty() )
+      location = repomdFind( repo, "prestodelta" );
+    if ( ! location.empty() )
+      addMetadata( repo, productdatapath_r/location, [&]( FILE * fp ) {
+        return ::repo_add_deltainfoxml( repo, fp, 0 );
+      });
+
+    ::repo_add_autopattern( repo, 0 );	// -X: autogenerate pattern from pattern-package
+
+    // The meta data repo2solv adds when writing. Without the toolversion
+    // the solv file would be rejected and rebuilt when loading the cache.
+    ::Repodata * info = ::repo_add_repodata( repo, 0 );
+    ::repodata_set_str( info, SOLVID_META, REPOSITORY_TOOLVERSION, LIBSOLV_TOOLVERSION );
+    ::Queue addedfileprovides;
+    ::queue_init( &addedfileprovides );
+    ::pool_addfileprovides_queue( pool, &addedfileprovides, 0 );
+    if ( addedfileprovides.count )
+      ::repodata_set_idarray( info, SOLVID_META, REPOSITORY_ADDEDFILEPROVIDES, &addedfileprovides );
+    ::queue_free( &addedfileprovides );
+    ::repodata_internalize( info );
+
+    FILE * out = ::fopen( solvfile_r.c_str(), "w" );
+    if ( ! out )
+      ZYPP_THROW( Exception( str::Str() << "Can't create " << solvfile_r ) );
+    AutoDispose<FILE*> fp( out, ::fclose );
+    if ( ::repo_write( repo, fp ) != 0 || ::fflush( fp ) != 0 )
+      ZYPP_THROW( Exception( str::Str() << "Can't write " << solvfile_r << ": " << ::pool_errstr( pool ) ) );
+
+    MIL << "Built " << solvfile_r << " (" << repo->nsolvables << " solvables)" << endl;
+  }
+
+} // namespace zypp
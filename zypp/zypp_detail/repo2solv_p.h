@@ -0,0 +1,48 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/zypp_detail/repo2solv_p.h
+ *
+*/
+#ifndef ZYPP_ZYPP_DETAIL_REPO2SOLV_P_H
+#define ZYPP_ZYPP_DETAIL_REPO2SOLV_P_H
+
+#include <cstdlib>
+
+#include <zypp/Pathname.h>
+#include <zypp/base/String.h>
+
+namespace zypp
+{
+  namespace env
+  {
+    /** Use the external repo2solv tool to build all solv files. */
+    inline bool ZYPP_REPO2SOLV_EXTERNAL()
+    {
+      const char * env = getenv("ZYPP_REPO2SOLV_EXTERNAL");
+      return( env && str::strToBool( env, true ) );
+    }
+  } // namespace env
+
+  /** In-process replacement for <tt>repo2solv -X</tt> on rpm-md metadata.
+   *
+   * Parses the metadata below \a productdatapath_r (\c repodata/repomd.xml and the
+   * suseinfo, primary, susedata, updateinfo and deltainfo files it refers to) into a
+   * scratch pool using libsolvs \c repo_add_* functions and writes the result to \a solvfile_r.
+   * As with \c -X patterns are autogenerated from pattern-packages.
+   *
+   * Each call uses its own pool, so it's safe to run builds for different repos
+   * in parallel threads.
+   *
+   * \throws Exception if the metadata can't be parsed or the solv file can't be written.
+   * The caller may then fall back to the external \c repo2solv tool.
+   */
+  void repo2solvRpmmd( const Pathname & productdatapath_r, const Pathname & solvfile_r );
+
+} // namespace zypp
+#endif // ZYPP_ZYPP_DETAIL_REPO2SOLV_P_H